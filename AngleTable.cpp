@@ -0,0 +1,13 @@
+#include <math.h>
+#include "AngleTable.h"
+
+float g_AngleSinTable[ANGLE_TABLE_QUARTER + 1];
+
+void InitAngleTable()
+{
+	const double UNIT2RAD = 3.14159265358979323846 / (2.0 * ANGLE_TABLE_QUARTER);
+	for (int i = 0; i <= ANGLE_TABLE_QUARTER; i++)
+		g_AngleSinTable[i] = (float)sin(i * UNIT2RAD);
+	// Make the peak exact, sin() may not land on it
+	g_AngleSinTable[ANGLE_TABLE_QUARTER] = 1.0f;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+/*
+ * Sine and cosine of XWA's 16-bit angles.
+ *
+ * XWA stores the craft's orientation as __int16 values where 65536 units are a full turn, so
+ * every angle the game can hand us is one of 65536 values. A quarter wave is enough to cover
+ * them all, the other three quadrants are mirrors of the first one.
+ */
+constexpr int ANGLE_TABLE_QUARTER = 16384;
+
+extern float g_AngleSinTable[ANGLE_TABLE_QUARTER + 1];
+
+// Must be called once before AngleSin() or AngleCos() are used
+void InitAngleTable();
+
+inline float AngleSin(unsigned short angle)
+{
+	const int q = angle & (ANGLE_TABLE_QUARTER - 1);
+	switch (angle >> 14) {
+	case 0:  return  g_AngleSinTable[q];
+	case 1:  return  g_AngleSinTable[ANGLE_TABLE_QUARTER - q];
+	case 2:  return -g_AngleSinTable[q];
+	default: return -g_AngleSinTable[ANGLE_TABLE_QUARTER - q];
+	}
+}
+
+inline float AngleCos(unsigned short angle)
+{
+	return AngleSin((unsigned short)(angle + ANGLE_TABLE_QUARTER));
+}
@@ -0,0 +1,211 @@
+#include <atomic>
+#include "DeviceManager.h"
+#include "Threading.h"
+#include "TrackerSampler.h"
+
+void log_debug(const char *format, ...);
+
+// Delay before the first retry; it doubles with every failure up to the maximum
+constexpr unsigned int DEVICE_RETRY_DELAY_MS = 500;
+constexpr unsigned int DEVICE_MAX_RETRY_DELAY_MS = 8000;
+
+int g_iDeviceInitRetries = 5;
+
+static TrackerDeviceInitFun g_DeviceInitFun = NULL;
+static TrackerDeviceShutdownFun g_DeviceShutdownFun = NULL;
+// Written by the game (or startup) thread, read by the manager
+static Mutex g_RequestLock;
+static TrackerDeviceConfig g_RequestedConfig;
+static std::atomic<unsigned int> g_iReloadRequests(0);
+static std::atomic<int> g_DeviceState(DEVICE_STATE_DOWN);
+static std::atomic<bool> g_bRunDeviceManager(false);
+// Held shared by the readers and exclusively while the device is brought up or down
+static RWLock g_DeviceLock;
+static Event g_DeviceEvent;
+static Thread g_DeviceThread;
+// The config the current device was brought up with. Only touched by the manager thread,
+// or after it has stopped.
+static TrackerDeviceConfig g_ActiveConfig;
+
+TrackerDeviceConfig::TrackerDeviceConfig()
+{
+	device = rotationSource = positionSource = NO_TRACKER_DEVICE;
+	freePIESlot = -1;
+	bSteamVRPosFromFreePIE = bFreePIEOutput = bSampler = false;
+}
+
+bool TrackerDeviceConfig::operator==(const TrackerDeviceConfig &other) const
+{
+	return device == other.device &&
+		rotationSource == other.rotationSource && positionSource == other.positionSource &&
+		freePIESlot == other.freePIESlot && bSteamVRPosFromFreePIE == other.bSteamVRPosFromFreePIE &&
+		bFreePIEOutput == other.bFreePIEOutput && bSampler == other.bSampler;
+}
+
+static TrackerDeviceConfig GetRequestedConfig()
+{
+	g_RequestLock.Lock();
+	const TrackerDeviceConfig config = g_RequestedConfig;
+	g_RequestLock.Unlock();
+	return config;
+}
+
+static void ShutdownActiveDevice(bool bUnloading)
+{
+	if (g_DeviceState == DEVICE_STATE_READY) {
+		g_DeviceLock.LockExclusive();
+		g_DeviceState = DEVICE_STATE_DOWN;
+		g_DeviceShutdownFun(g_ActiveConfig, bUnloading);
+		g_DeviceLock.UnlockExclusive();
+		log_debug("[Devices] Device %d shut down", g_ActiveConfig.device);
+	}
+	g_DeviceState = DEVICE_STATE_DOWN;
+}
+
+static void DeviceManagerThreadFun(void *param)
+{
+	unsigned int reloads = g_iReloadRequests;
+	int failures = 0;
+	LONGLONG nextAttempt = 0;
+
+	while (g_bRunDeviceManager)
+	{
+		const TrackerDeviceConfig requested = GetRequestedConfig();
+		const unsigned int reloadsNow = g_iReloadRequests;
+		if (requested != g_ActiveConfig || reloadsNow != reloads) {
+			ShutdownActiveDevice(false);
+			g_ActiveConfig = requested;
+			reloads = reloadsNow;
+			failures = 0;
+			nextAttempt = 0;
+		}
+
+		unsigned int waitMs = WAIT_FOREVER;
+		if (g_ActiveConfig.device != NO_TRACKER_DEVICE && g_DeviceState != DEVICE_STATE_READY &&
+			failures <= g_iDeviceInitRetries)
+		{
+			LONGLONG now = GetQPCTime();
+			if (now >= nextAttempt) {
+				g_DeviceLock.LockExclusive();
+				g_DeviceState = DEVICE_STATE_STARTING;
+				const bool bReady = g_DeviceInitFun(g_ActiveConfig);
+				g_DeviceState = bReady ? DEVICE_STATE_READY : DEVICE_STATE_FAILED;
+				g_DeviceLock.UnlockExclusive();
+
+				const LONGLONG end = GetQPCTime();
+				if (bReady) {
+					log_debug("[Devices] Device %d ready in %0.1fms", g_ActiveConfig.device, 1000.0 * QPCToSeconds(end - now));
+				}
+				else {
+					unsigned int delayMs = DEVICE_MAX_RETRY_DELAY_MS;
+					if (failures < 5 && (DEVICE_RETRY_DELAY_MS << failures) < DEVICE_MAX_RETRY_DELAY_MS)
+						delayMs = DEVICE_RETRY_DELAY_MS << failures;
+					failures++;
+					if (failures <= g_iDeviceInitRetries)
+						log_debug("[Devices] Device %d failed to initialize, retrying in %ums", g_ActiveConfig.device, delayMs);
+					else
+						log_debug("[Devices] Device %d failed to initialize, giving up", g_ActiveConfig.device);
+					nextAttempt = end + (LONGLONG)((double)delayMs / (1000.0 * QPCToSeconds(1)));
+				}
+				now = end;
+			}
+			if (g_DeviceState != DEVICE_STATE_READY && failures <= g_iDeviceInitRetries)
+				waitMs = nextAttempt > now ? (unsigned int)(1000.0 * QPCToSeconds(nextAttempt - now)) + 1 : 1;
+		}
+
+		g_DeviceEvent.Wait(waitMs);
+	}
+}
+
+bool StartDeviceManager(TrackerDeviceInitFun initFun, TrackerDeviceShutdownFun shutdownFun)
+{
+	if (g_DeviceThread.IsStarted())
+		return true;
+
+	g_DeviceInitFun = initFun;
+	g_DeviceShutdownFun = shutdownFun;
+	if (!g_DeviceEvent.Create()) {
+		log_debug("[Devices] Could not create the device manager event");
+		return false;
+	}
+	g_bRunDeviceManager = true;
+	if (!g_DeviceThread.Start(DeviceManagerThreadFun, NULL)) {
+		log_debug("[Devices] Could not create the device manager thread");
+		g_bRunDeviceManager = false;
+		g_DeviceEvent.Close();
+		return false;
+	}
+	return true;
+}
+
+void SignalDeviceManagerStop()
+{
+	if (!g_DeviceThread.IsStarted())
+		return;
+
+	g_bRunDeviceManager = false;
+	g_DeviceEvent.Set();
+}
+
+void StopDeviceManager(unsigned int timeoutMs)
+{
+	if (!g_DeviceThread.IsStarted())
+		return;
+
+	SignalDeviceManagerStop();
+	// Like the sampler, this may run from DllMain, where the thread can't exit until the
+	// loader lock is released. At process exit the thread is already gone.
+	if (!g_DeviceThread.Join(timeoutMs) && g_DeviceState == DEVICE_STATE_STARTING)
+	{
+		// Shutting down a device that is still being brought up would race with its init
+		log_debug("[Devices] The device manager is still busy, skipping the device shutdown");
+	}
+	else
+		ShutdownActiveDevice(true);
+	// A thread that didn't exit is left alone; the process (or the DLL) is going away
+	g_DeviceThread.Detach();
+	g_DeviceEvent.Close();
+}
+
+void RequestTrackerDevice(const TrackerDeviceConfig &config)
+{
+	g_RequestLock.Lock();
+	g_RequestedConfig = config;
+	g_RequestLock.Unlock();
+	g_DeviceEvent.Set();
+}
+
+void RequestTrackerDeviceReload()
+{
+	g_iReloadRequests++;
+	g_DeviceEvent.Set();
+}
+
+TrackerDeviceConfig GetRequestedTrackerDevice()
+{
+	return GetRequestedConfig();
+}
+
+TrackerDeviceState GetTrackerDeviceState()
+{
+	return (TrackerDeviceState)g_DeviceState.load();
+}
+
+bool BeginTrackerDeviceRead()
+{
+	if (g_DeviceState != DEVICE_STATE_READY)
+		return false;
+	if (!g_DeviceLock.TryLockShared())
+		return false;
+	// The device may have gone down between the two checks
+	if (g_DeviceState != DEVICE_STATE_READY) {
+		g_DeviceLock.UnlockShared();
+		return false;
+	}
+	return true;
+}
+
+void EndTrackerDeviceRead()
+{
+	g_DeviceLock.UnlockShared();
+}
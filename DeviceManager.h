@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+ * Background owner of the tracking device.
+ *
+ * Bringing a device up means registry reads, LoadLibrary, sockets or VR_Init, none of which
+ * belong in a camera hook. The manager thread does all of it: it initializes the requested
+ * device, retries with an increasing delay when that fails, shuts it down and switches to
+ * another one on request. The game thread only asks for a device and checks whether it's
+ * ready before reading it.
+ *
+ * Devices are described by a TrackerDeviceConfig; the manager only compares those, it doesn't
+ * know what they mean.
+ */
+constexpr int NO_TRACKER_DEVICE = -1;
+
+enum TrackerDeviceState {
+	DEVICE_STATE_DOWN,     // No device, or it was shut down
+	DEVICE_STATE_STARTING, // The init function is running
+	DEVICE_STATE_READY,
+	DEVICE_STATE_FAILED,   // The last init failed; it may be retried
+};
+
+/*
+ * What to bring up: the device plus the settings its bring-up and shutdown depend on. The
+ * manager keeps the config the current device was brought up with, and shuts the device down
+ * with it, so a reloaded CockpitLook.cfg can't make it shut down something it didn't start.
+ * Any change in the config brings the device down and up again.
+ */
+struct TrackerDeviceConfig {
+	int device;                  // A TrackerType, or NO_TRACKER_DEVICE
+	int rotationSource;          // Fusion sources (TrackerTypes)
+	int positionSource;
+	int freePIESlot;
+	bool bSteamVRPosFromFreePIE;
+	bool bFreePIEOutput;         // Something is written to a FreePIE slot
+	bool bSampler;               // Read the device on the sampler thread
+
+	TrackerDeviceConfig();
+	bool operator==(const TrackerDeviceConfig &other) const;
+	bool operator!=(const TrackerDeviceConfig &other) const { return !(*this == other); }
+};
+
+// Run on the manager thread. Init returns false if the device could not be initialized.
+typedef bool (*TrackerDeviceInitFun)(const TrackerDeviceConfig &config);
+// bUnloading is only set by StopDeviceManager(), when the DLL is going away
+typedef void (*TrackerDeviceShutdownFun)(const TrackerDeviceConfig &config, bool bUnloading);
+
+// Failed inits are retried this many times, then the manager waits for a new request
+extern int g_iDeviceInitRetries;
+
+bool StartDeviceManager(TrackerDeviceInitFun initFun, TrackerDeviceShutdownFun shutdownFun);
+// Tells the manager thread to stop without waiting for it; StopDeviceManager() still has to
+// be called
+void SignalDeviceManagerStop();
+// Stops the thread, waiting up to timeoutMs for it, and shuts down the device, if it's up.
+// Only meant for DLL_PROCESS_DETACH.
+void StopDeviceManager(unsigned int timeoutMs = 1000);
+
+// Asynchronous: the current device (if any) is shut down and the new one brought up
+void RequestTrackerDevice(const TrackerDeviceConfig &config);
+// Shuts down the current device and initializes it again
+void RequestTrackerDeviceReload();
+TrackerDeviceConfig GetRequestedTrackerDevice();
+TrackerDeviceState GetTrackerDeviceState();
+
+/*
+ * Reads of the device from the game thread must be wrapped in these. BeginTrackerDeviceRead()
+ * never blocks: it returns false if the device isn't ready or the manager is working on it,
+ * and EndTrackerDeviceRead() must only be called if it returned true.
+ */
+bool BeginTrackerDeviceRead();
+void EndTrackerDeviceRead();
@@ -0,0 +1,22 @@
+#include "FrameClock.h"
+
+FrameClock::FrameClock()
+{
+	minFrameInterval = 0.001f;
+	frameStart = 0;
+	frameId = callsThisFrame = repeatedFrames = 0;
+}
+
+bool FrameClock::BeginCall(LONGLONG now)
+{
+	if (callsThisFrame > 0 && QPCToSeconds(now - frameStart) < minFrameInterval) {
+		if (++callsThisFrame == 2)
+			repeatedFrames++;
+		return false;
+	}
+
+	frameStart = now;
+	frameId++;
+	callsThisFrame = 1;
+	return true;
+}
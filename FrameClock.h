@@ -0,0 +1,36 @@
+#pragma once
+
+#include "TrackerSampler.h"
+
+/*
+ * Tells the hook sites apart from the frames they belong to.
+ *
+ * XWA can reach UpdateTrackingData() through several camera hooks, and nothing in the engine
+ * hands us a frame number, so a frame boundary is detected by time: calls that arrive less
+ * than minFrameInterval after the first call of the current frame belong to that same frame.
+ * This is a heuristic: two calls of the same frame that are further apart than
+ * minFrameInterval count as two frames, which is why the once-per-frame gate built on top of
+ * it is off by default.
+ */
+class FrameClock
+{
+public:
+	// Seconds
+	float minFrameInterval;
+
+	FrameClock();
+
+	// Registers a call and returns true if it's the first one of a new frame
+	bool BeginCall(LONGLONG now);
+
+	// Increases by one every frame
+	unsigned int GetFrameId() const { return frameId; }
+	// Calls registered so far in the current frame (at least 1 after the first BeginCall())
+	unsigned int GetCallsThisFrame() const { return callsThisFrame; }
+	// Frames that got more than one call since the start
+	unsigned int GetRepeatedFrames() const { return repeatedFrames; }
+
+private:
+	LONGLONG frameStart;
+	unsigned int frameId, callsThisFrame, repeatedFrames;
+};
@@ -1,4 +1,6 @@
 #include <windows.h>
+#include <string.h>
+#include <vector>
 #include "FreePIE.h"
 
 void log_debug(const char *format, ...);
@@ -15,6 +17,22 @@ bool g_bFreePIELoaded = false, g_bFreePIEInitialized = false, g_bFreePIEAlreadyI
 freepie_io_6dof_data g_FreePIEData;
 HMODULE hFreePIE = NULL;
 
+// Read cache: slots [g_iFreePIEFirstReadSlot, g_iFreePIELastReadSlot] as of the last refresh
+struct FreePIESlotCache {
+	freepie_io_6dof_data data;
+	unsigned int generation;
+};
+static std::vector<FreePIESlotCache> g_FreePIEReadCache;
+static std::vector<freepie_io_6dof_data> g_FreePIEReadBuffer;
+static int g_iFreePIEFirstReadSlot = 0, g_iFreePIELastReadSlot = -1;
+static bool g_bFreePIECacheValid = false;
+// Last values written to each output slot
+struct FreePIEWrittenSlot {
+	freepie_io_6dof_data data;
+	bool valid;
+};
+static std::vector<FreePIEWrittenSlot> g_FreePIEWritten;
+
 bool InitFreePIE() {
 	LONG lRes = ERROR_SUCCESS;
 	char regvalue[1024];
@@ -77,18 +95,97 @@ void ShutdownFreePIE() {
 		FreeLibrary(hFreePIE);
 }
 
-bool ReadFreePIE(int slot) {
-	// Check how many slots (values) the current FreePIE implementation provides.
-	int error = freepie_io_6dof_read(slot, 1, &g_FreePIEData);
+void ClearFreePIEReadSlots() {
+	g_iFreePIEFirstReadSlot = 0;
+	g_iFreePIELastReadSlot = -1;
+	g_FreePIEReadCache.clear();
+	g_bFreePIECacheValid = false;
+}
+
+void AddFreePIEReadSlot(int slot) {
+	if (slot < 0)
+		return;
+	FreePIESlotCache empty;
+	memset(&empty, 0, sizeof(empty));
+	if (g_iFreePIELastReadSlot < g_iFreePIEFirstReadSlot) {
+		g_iFreePIEFirstReadSlot = g_iFreePIELastReadSlot = slot;
+	}
+	else if (slot < g_iFreePIEFirstReadSlot) {
+		// Keep the slots we already have, they're shifted to the end of the cache
+		g_FreePIEReadCache.insert(g_FreePIEReadCache.begin(), g_iFreePIEFirstReadSlot - slot, empty);
+		g_iFreePIEFirstReadSlot = slot;
+	}
+	else if (slot > g_iFreePIELastReadSlot)
+		g_iFreePIELastReadSlot = slot;
+	else
+		return;
+
+	const size_t numSlots = g_iFreePIELastReadSlot - g_iFreePIEFirstReadSlot + 1;
+	g_FreePIEReadCache.resize(numSlots, empty);
+	g_FreePIEReadBuffer.resize(numSlots);
+	g_bFreePIECacheValid = false;
+}
+
+void InvalidateFreePIECache() {
+	g_bFreePIECacheValid = false;
+}
+
+bool RefreshFreePIE() {
+	g_bFreePIECacheValid = false;
+	if (freepie_io_6dof_read == NULL || g_FreePIEReadCache.empty())
+		return false;
+
+	const UINT32 numSlots = (UINT32)g_FreePIEReadCache.size();
+	int error = freepie_io_6dof_read(g_iFreePIEFirstReadSlot, numSlots, g_FreePIEReadBuffer.data());
 	if (error < 0) {
 		log_debug("FreePIE error: %d", error);
 		return false;
 	}
+	for (UINT32 i = 0; i < numSlots; i++) {
+		FreePIESlotCache &slot = g_FreePIEReadCache[i];
+		if (memcmp(&slot.data, &g_FreePIEReadBuffer[i], sizeof(slot.data)) != 0) {
+			slot.data = g_FreePIEReadBuffer[i];
+			slot.generation++;
+		}
+	}
+	g_bFreePIECacheValid = true;
+	return true;
+}
+
+unsigned int GetFreePIESlotGeneration(int slot) {
+	if (slot < g_iFreePIEFirstReadSlot || slot > g_iFreePIELastReadSlot)
+		return 0;
+	return g_FreePIEReadCache[slot - g_iFreePIEFirstReadSlot].generation;
+}
+
+bool ReadFreePIE(int slot) {
+	if (slot < g_iFreePIEFirstReadSlot || slot > g_iFreePIELastReadSlot)
+		AddFreePIEReadSlot(slot);
+	if (!g_bFreePIECacheValid && !RefreshFreePIE())
+		return false;
+	g_FreePIEData = g_FreePIEReadCache[slot - g_iFreePIEFirstReadSlot].data;
 	return true;
 }
 
 void WriteFreePIE(int slot) {
+	if (slot < 0)
+		return;
+	if ((size_t)slot >= g_FreePIEWritten.size()) {
+		FreePIEWrittenSlot empty;
+		memset(&empty, 0, sizeof(empty));
+		g_FreePIEWritten.resize(slot + 1, empty);
+	}
+	// Nobody else writes to our output slot, so there's no need to send the same values again
+	FreePIEWrittenSlot &written = g_FreePIEWritten[slot];
+	if (written.valid && memcmp(&written.data, &g_FreePIEData, sizeof(written.data)) == 0)
+		return;
+
 	int error = freepie_io_6dof_write(slot, 1, &g_FreePIEData);
-	if (error != 0)
+	if (error != 0) {
 		log_debug("Could not write to FreePIE, error: 0x%x", error);
+		written.valid = false;
+		return;
+	}
+	written.data = g_FreePIEData;
+	written.valid = true;
 }
\ No newline at end of file
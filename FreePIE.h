@@ -25,5 +25,24 @@ extern freepie_io_6dof_data g_FreePIEData;
 
 bool InitFreePIE();
 void ShutdownFreePIE();
+// Copies a slot into g_FreePIEData. The slot comes from the read cache, which is refreshed
+// the first time it's needed after InvalidateFreePIECache().
 bool ReadFreePIE(int slot);
+// Writes g_FreePIEData to a slot, unless that's exactly what was written there last time.
 void WriteFreePIE(int slot);
+
+/*
+ * Read cache. All the slots in use are read together, with a single freepie_io_6dof_read()
+ * call, so several consumers in the same frame don't hit FreePIE more than once.
+ * The cache is not thread-safe: it belongs to the sampler thread while that's reading
+ * FreePIE, and to the game thread otherwise.
+ */
+// Forgets the slots added so far; slots are also added on demand by ReadFreePIE()
+void ClearFreePIEReadSlots();
+void AddFreePIEReadSlot(int slot);
+// Marks the cache as stale. Call it once per frame.
+void InvalidateFreePIECache();
+// Reads all the slots in use now, regardless of the state of the cache
+bool RefreshFreePIE();
+// Incremented every time a refresh finds new values in the slot
+unsigned int GetFreePIESlotGeneration(int slot);
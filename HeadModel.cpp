@@ -0,0 +1,61 @@
+#include <math.h>
+#include "HeadModel.h"
+
+// Longer updates are cut short (after a stall, for instance) rather than spinning here
+constexpr int MAX_HEAD_MODEL_STEPS = 256;
+
+HeadModel::HeadModel()
+{
+	// 1.5Hz
+	stiffness = 89.0f;
+	dampingRatio = 1.0f;
+	rate = 240.0f;
+	gain = 1.0f;
+	const float zero[HEAD_AXIS_COUNT] = { 0 };
+	Reset(zero);
+}
+
+void HeadModel::Reset(const float velocity[HEAD_AXIS_COUNT])
+{
+	for (int i = 0; i < HEAD_AXIS_COUNT; i++) {
+		pos[i] = vel[i] = pending[i] = 0.0f;
+		lastVelocity[i] = velocity[i];
+	}
+	carry = 0.0f;
+}
+
+void HeadModel::Update(const float velocity[HEAD_AXIS_COUNT], float dt)
+{
+	for (int i = 0; i < HEAD_AXIS_COUNT; i++) {
+		pending[i] += velocity[i] - lastVelocity[i];
+		lastVelocity[i] = velocity[i];
+	}
+	if (dt <= 0.0f || stiffness <= 0.0f || rate <= 0.0f)
+		return;
+
+	const float omega = sqrtf(stiffness);
+	const float damping = 2.0f * dampingRatio * omega;
+	// Semi-implicit Euler needs omega * h < 2 (less with damping); keep well inside that
+	float h = 1.0f / rate;
+	const float hMax = 1.0f / (omega * (1.0f + dampingRatio));
+	if (h > hMax)
+		h = hMax;
+
+	carry += dt;
+	if (carry > MAX_HEAD_MODEL_STEPS * h)
+		carry = MAX_HEAD_MODEL_STEPS * h;
+
+	// The push is scaled by omega so that the size of the swing doesn't depend on the stiffness
+	const float push = gain * omega;
+	while (carry >= h) {
+		// Spread the change in velocity evenly over the time it took
+		const float fraction = h / carry;
+		for (int i = 0; i < HEAD_AXIS_COUNT; i++) {
+			const float kick = pending[i] * fraction;
+			pending[i] -= kick;
+			vel[i] += push * kick + (-stiffness * pos[i] - damping * vel[i]) * h;
+			pos[i] += vel[i] * h;
+		}
+		carry -= h;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+/*
+ * Spring-damper model of the pilot's head, used for the cockpit inertia.
+ *
+ * Each axis is a unit mass on a spring with the given stiffness and damping ratio, resting
+ * at 0. The ship's motion drives it: whenever the ship's angular velocity (or its forward
+ * speed) changes, the head gets the opposite push, so it swings with the ship's angular and
+ * linear acceleration and settles back once the ship moves steadily again.
+ *
+ * The model is integrated with semi-implicit Euler at a fixed internal rate, independent of
+ * the frame rate. The internal step is shortened if the stiffness would make it unstable.
+ */
+enum HeadModelAxis {
+	HEAD_AXIS_YAW, HEAD_AXIS_PITCH, HEAD_AXIS_ROLL,
+	HEAD_AXIS_SURGE, // Forward speed
+	HEAD_AXIS_COUNT
+};
+
+class HeadModel
+{
+public:
+	float stiffness;    // 1/s^2. The natural frequency is sqrt(stiffness) rad/s.
+	float dampingRatio; // 1 is critically damped, < 1 overshoots, > 1 is sluggish
+	float rate;         // Internal steps per second
+	float gain;         // Scales the push the head gets from the ship's motion
+
+	HeadModel();
+
+	// Puts the head at rest, with the ship moving at the given velocities
+	void Reset(const float velocity[HEAD_AXIS_COUNT]);
+	// Advances the model by dt seconds, with the ship's velocities at the end of that time:
+	// angular velocities for yaw, pitch and roll, the forward speed for surge
+	void Update(const float velocity[HEAD_AXIS_COUNT], float dt);
+	float GetDisplacement(HeadModelAxis axis) const { return pos[axis]; }
+
+private:
+	float pos[HEAD_AXIS_COUNT], vel[HEAD_AXIS_COUNT];
+	float lastVelocity[HEAD_AXIS_COUNT];
+	// Change in the ship's velocities that hasn't been fed to the head yet
+	float pending[HEAD_AXIS_COUNT];
+	// Time that didn't fill a whole step yet
+	float carry;
+};
@@ -0,0 +1,61 @@
+#include "HeadingBasis.h"
+#include "AngleTable.h"
+
+void ComputeHeadingBasis(short craftYaw, short craftPitch, short craftRoll, HeadingBasis *basis)
+{
+	// yaw-pitch-roll gets reset to: ypr: 0.000, 90.000, 0.000 when entering hyperspace
+	const float cy = AngleCos(craftYaw),   sy = AngleSin(craftYaw);
+	const float cp = AngleCos(craftPitch), sp = AngleSin(craftPitch);
+	const float cr = AngleCos(craftRoll),  sr = AngleSin(craftRoll);
+
+	// This used to be done by building a TBN system to avoid gimbal lock:
+	//   N = (sin(yaw) * sin(pitch), cos(pitch), cos(yaw) * sin(pitch))
+	//   T = Ry(yaw) * Rx(pitch) * Ry(roll) * [1, 0, 0]
+	//   B = Ry(yaw) * Rx(pitch) * Ry(roll) * [0, 0, -1]
+	// followed by g_ReflRotX, which swaps Y and Z. When pitch == 90, the craft is seeing the
+	// horizon; when pitch == 0, it's looking towards the sun. Expanding the products gives:
+	Vector4 &Rs = basis->Rs, &Us = basis->Us, &Fs = basis->Fs;
+	Fs.x = sy * sp;
+	Fs.y = cy * sp;
+	Fs.z = cp;
+	Fs.w = 0;
+
+	Us.x = -cy * sr - sy * cp * cr;
+	Us.y =  sy * sr - cy * cp * cr;
+	Us.z =  sp * cr;
+	Us.w = 0;
+
+	Rs.x =  cy * cr - sy * cp * sr;
+	Rs.y = -sy * cr - cy * cp * sr;
+	Rs.z =  sp * sr;
+	Rs.w = 0;
+	// This transform chain gets us the orientation of the craft in XWA's coord system:
+	// [1,0,0] is right, [0,1,0] is forward, [0,0,1] is up
+
+	// Transform current ship's heading to Global Coordinates (Major Axes)
+	basis->toGlobal = Matrix4(
+		Rs.x, Us.x, Fs.x, 0,
+		Rs.y, Us.y, Fs.y, 0,
+		Rs.z, Us.z, Fs.z, 0,
+		0, 0, 0, 1
+	);
+	// Transform Global Coordinates to the Ship's Coordinate System.
+	// Rs, Us, Fs is an orthonormal basis, so this is just the transpose.
+	basis->toShip = Matrix4(
+		Rs.x, Rs.y, Rs.z, 0,
+		Us.x, Us.y, Us.z, 0,
+		Fs.x, Fs.y, Fs.z, 0,
+		0, 0, 0, 1
+	);
+}
+
+const HeadingBasis &HeadingBasisCache::Get(int playerIndex, short craftYaw, short craftPitch, short craftRoll)
+{
+	if (!bValid || playerIndex != lastPlayerIndex || craftYaw != lastYaw || craftPitch != lastPitch || craftRoll != lastRoll) {
+		ComputeHeadingBasis(craftYaw, craftPitch, craftRoll, &basis);
+		lastPlayerIndex = playerIndex;
+		lastYaw = craftYaw; lastPitch = craftPitch; lastRoll = craftRoll;
+		bValid = true;
+	}
+	return basis;
+}
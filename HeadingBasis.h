@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Matrices.h"
+
+/*
+ * The craft's orientation, in global coordinates:
+ * Rs: The "Right" vector
+ * Us: The "Up" vector
+ * Fs: The "Forward" vector
+ * toGlobal maps the ship's axes to the global (major) axes; toShip goes the other way.
+ */
+struct HeadingBasis {
+	Vector4 Rs, Us, Fs;
+	Matrix4 toGlobal, toShip;
+};
+
+// Builds the basis from XWA's 16-bit craft angles. InitAngleTable() must have been called.
+void ComputeHeadingBasis(short craftYaw, short craftPitch, short craftRoll, HeadingBasis *basis);
+
+/*
+ * The inertia and the gunner turret both ask for the heading every frame, but the craft's
+ * angles only change once per game tick: the last basis is kept until the angles (or the
+ * player) change.
+ */
+class HeadingBasisCache
+{
+public:
+	HeadingBasisCache() : bValid(false) {}
+
+	const HeadingBasis &Get(int playerIndex, short craftYaw, short craftPitch, short craftRoll);
+	void Invalidate() { bValid = false; }
+
+private:
+	HeadingBasis basis;
+	bool bValid;
+	int lastPlayerIndex;
+	short lastYaw, lastPitch, lastRoll;
+};
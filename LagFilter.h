@@ -0,0 +1,86 @@
+#pragma once
+
+#include <math.h>
+
+/*
+ * First-order lag: the output follows the input with a time constant of timeConstant seconds.
+ *
+ * By default every Update() integrates the lag exactly, assuming the input moved in a straight
+ * line since the previous update. A steady turn then leaves the output timeConstant seconds'
+ * worth of motion behind no matter how many frames it took to get there.
+ *
+ * With a fixedStep, the lag advances in steps of that many seconds instead, blending the input
+ * (interpolated at each step) in by a constant fraction, and the time that doesn't fill a whole
+ * step is carried over to the next update. The output is the last step plus the partial step
+ * up to the current time.
+ *
+ * T needs T + T, T - T and T * float, so this works for float and for Vector4.
+ */
+template <typename T>
+class LagFilter
+{
+public:
+	// Seconds. 0 makes the output follow the input with no lag.
+	float timeConstant;
+	// Seconds. 0 integrates each update exactly.
+	float fixedStep;
+
+	LagFilter() : timeConstant(0.1f), fixedStep(0.0f), carry(0.0f) {}
+
+	// Snaps the output to x
+	void Reset(const T& x) {
+		value = input = stepValue = stepInput = x;
+		carry = 0.0f;
+	}
+
+	// Advances the lag by dt seconds, with x being the input at the end of that time
+	const T& Update(const T& x, float dt) {
+		if (timeConstant <= 0.0f) {
+			Reset(x);
+			return value;
+		}
+
+		if (fixedStep <= 0.0f) {
+			value = Advance(value, input, x, dt, timeConstant);
+			input = x;
+			return value;
+		}
+
+		if (dt > 0.0f)
+			carry += dt;
+		// Don't spin forever after a long stall: whatever doesn't fit is dropped
+		if (carry > MAX_FIXED_STEPS * fixedStep) {
+			stepInput = stepInput + (x - stepInput) * (1.0f - MAX_FIXED_STEPS * fixedStep / carry);
+			carry = MAX_FIXED_STEPS * fixedStep;
+		}
+		const float alpha = 1.0f - expf(-fixedStep / timeConstant);
+		while (carry >= fixedStep) {
+			const T xi = stepInput + (x - stepInput) * (fixedStep / carry);
+			stepValue = stepValue + (xi - stepValue) * alpha;
+			stepInput = xi;
+			carry -= fixedStep;
+		}
+		value = carry > 0.0f ? Advance(stepValue, stepInput, x, carry, timeConstant) : stepValue;
+		input = x;
+		return value;
+	}
+
+	const T& Get() const { return value; }
+
+private:
+	static constexpr float MAX_FIXED_STEPS = 256.0f;
+
+	T value, input;
+	// Fixed step mode: output and input at the last step boundary, and the time since then
+	T stepValue, stepInput;
+	float carry;
+
+	// Exact solution of dy/dt = (x(t) - y) / tau with x going linearly from x0 to x1 in dt seconds
+	static T Advance(const T& y, const T& x0, const T& x1, float dt, float tau) {
+		if (dt <= 0.0f)
+			return y;
+		const float decay = expf(-dt / tau);
+		const T error = (x0 - y) * decay + (x1 - x0) * (tau / dt * (1.0f - decay));
+		return x1 - error;
+	}
+};
@@ -0,0 +1,46 @@
+#include <math.h>
+#include "LeanAnim.h"
+
+void LeanAnimTick(float *pos, float *vel, float *target, int dir, float maxLean, float dt, const LeanAnimSettings &settings)
+{
+	constexpr float LEAN_SNAP_DISTANCE = 1e-4f;
+	if (dir != 0)
+		*target += dir * settings.speed * dt;
+	else if (!settings.bSticky) {
+		const float step = settings.resetSpeed * dt;
+		if (*target > step)       *target -= step;
+		else if (*target < -step) *target += step;
+		else                      *target = 0.0f;
+	}
+
+	// Range clamping
+	if (settings.bLimit) {
+		if (*target >  maxLean) *target =  maxLean;
+		if (*target < -maxLean) *target = -maxLean;
+	}
+
+	if (settings.easeTime <= 0.0f || dt <= 0.0f) {
+		if (settings.easeTime <= 0.0f) {
+			*pos = *target;
+			*vel = 0.0f;
+		}
+		return;
+	}
+
+	// Critically damped spring towards the target, integrated in closed form (with a Pade
+	// approximation of the exponential) so it behaves the same at any frame rate.
+	// See: Lowe, "Critically Damped Ease-In/Ease-Out Smoothing", Game Programming Gems 4.
+	const float omega = 2.0f / settings.easeTime;
+	const float x = omega * dt;
+	const float decay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+	const float change = *pos - *target;
+	const float temp = (*vel + omega * change) * dt;
+	float newPos = *target + (change + temp) * decay;
+	*vel = (*vel - omega * temp) * decay;
+	// Don't go past the target, and land on it once the rest is too small to see
+	if (fabsf(newPos - *target) < LEAN_SNAP_DISTANCE || ((change < 0.0f) == (newPos > *target) && change != 0.0f)) {
+		newPos = *target;
+		*vel = 0.0f;
+	}
+	*pos = newPos;
+}
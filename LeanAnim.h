@@ -0,0 +1,21 @@
+#pragma once
+
+// The keyboard lean settings, from the cockpit lean keys of the config
+struct LeanAnimSettings {
+	// Units per second, while a key is held and back to 0 after it's released
+	float speed, resetSpeed;
+	// Seconds it takes the head to catch up with the lean target, roughly
+	float easeTime;
+	// The lean stays where it is when the key is released
+	bool bSticky;
+	// The lean is clamped to [-maxLean, maxLean]
+	bool bLimit;
+};
+
+/*
+ * Animates one axis of the keyboard lean over dt seconds. dir is +1 or -1 while a lean key is
+ * held and 0 otherwise. The target moves at speed while a key is held and, without sticky
+ * lean, goes back to 0 at resetSpeed once it's released. The position follows the target
+ * with critically damped easing and never overshoots it, so it lands on 0 exactly.
+ */
+void LeanAnimTick(float *pos, float *vel, float *target, int dir, float maxLean, float dt, const LeanAnimSettings &settings);
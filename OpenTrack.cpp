@@ -0,0 +1,186 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib,"ws2_32.lib") // Winsock Library
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+typedef int SOCKET;
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SOCKET_ERROR = -1;
+static int closesocket(SOCKET s) { return close(s); }
+static int WSAGetLastError() { return errno; }
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "OpenTrack.h"
+#include "SeqLock.h"
+#include "Threading.h"
+
+void log_debug(const char *format, ...);
+
+// If no packets arrive for this long, the tracker is considered lost
+constexpr double OPENTRACK_TIMEOUT = 0.5;
+// How often the receive thread wakes up to check if it must exit, in milliseconds
+constexpr unsigned int OPENTRACK_RECV_TIMEOUT = 100;
+
+int g_iOpenTrackPort = DEFAULT_OPENTRACK_PORT;
+
+static SOCKET g_OpenTrackSocket = INVALID_SOCKET;
+static Thread g_OpenTrackThread;
+static std::atomic<bool> g_bRunOpenTrackThread(false);
+static SeqLock<TrackerSample> g_OpenTrackPose;
+
+// Winsock must be started once per user; the other platforms have nothing to do
+static bool StartupSockets()
+{
+#ifdef _WIN32
+	WSADATA wsaData;
+	return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+	return true;
+#endif
+}
+
+static void CleanupSockets()
+{
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+static void SetRecvTimeout(SOCKET s, unsigned int timeoutMs)
+{
+#ifdef _WIN32
+	DWORD timeout = timeoutMs;
+#else
+	struct timeval timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+	setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+}
+
+static void OpenTrackThreadFun(void *param)
+{
+	double pose[6];
+	while (g_bRunOpenTrackThread)
+	{
+		int len = recv(g_OpenTrackSocket, (char *)pose, sizeof(pose), 0);
+		// Timeouts come back as errors; anything shorter than a full pose is ignored
+		if (len != sizeof(pose))
+			continue;
+
+		TrackerSample sample;
+		sample.timestamp = GetQPCTime();
+		sample.x     = (float)pose[0];
+		sample.y     = (float)pose[1];
+		sample.z     = (float)pose[2];
+		sample.yaw   = (float)pose[3];
+		sample.pitch = (float)pose[4];
+		sample.roll  = (float)pose[5];
+		sample.valid = true;
+		g_OpenTrackPose.Write(sample);
+	}
+}
+
+bool InitOpenTrack()
+{
+	if (!StartupSockets()) {
+		log_debug("[OpenTrack] WSAStartup failed. Error: %d", WSAGetLastError());
+		return false;
+	}
+
+	g_OpenTrackSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (g_OpenTrackSocket == INVALID_SOCKET) {
+		log_debug("[OpenTrack] socket() failed. Error: %d", WSAGetLastError());
+		CleanupSockets();
+		return false;
+	}
+
+	struct sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_port = htons(g_iOpenTrackPort);
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(g_OpenTrackSocket, (struct sockaddr *)&local, sizeof(local)) == SOCKET_ERROR) {
+		log_debug("[OpenTrack] Could not bind to port %d. Error: %d", g_iOpenTrackPort, WSAGetLastError());
+		closesocket(g_OpenTrackSocket);
+		g_OpenTrackSocket = INVALID_SOCKET;
+		CleanupSockets();
+		return false;
+	}
+
+	// Don't block forever in recv(), so the thread can be stopped
+	SetRecvTimeout(g_OpenTrackSocket, OPENTRACK_RECV_TIMEOUT);
+
+	g_bRunOpenTrackThread = true;
+	if (!g_OpenTrackThread.Start(OpenTrackThreadFun, NULL)) {
+		log_debug("[OpenTrack] Could not create the receive thread");
+		g_bRunOpenTrackThread = false;
+		closesocket(g_OpenTrackSocket);
+		g_OpenTrackSocket = INVALID_SOCKET;
+		CleanupSockets();
+		return false;
+	}
+	log_debug("[OpenTrack] Listening on UDP port %d", g_iOpenTrackPort);
+	return true;
+}
+
+void ShutdownOpenTrack()
+{
+	if (!g_OpenTrackThread.IsStarted())
+		return;
+
+	g_bRunOpenTrackThread = false;
+	// On Windows, closing the socket also wakes up a pending recv(); elsewhere the thread
+	// must see the flag before the socket goes away
+#ifdef _WIN32
+	closesocket(g_OpenTrackSocket);
+	g_OpenTrackThread.Join(1000);
+#else
+	g_OpenTrackThread.Join(1000);
+	closesocket(g_OpenTrackSocket);
+#endif
+	g_OpenTrackThread.Detach();
+	g_OpenTrackSocket = INVALID_SOCKET;
+	CleanupSockets();
+	log_debug("[OpenTrack] Shut down");
+}
+
+bool ReadOpenTrackSample(TrackerSample *sample)
+{
+	TrackerSample pose;
+	if (!g_OpenTrackPose.Read(&pose))
+		return false;
+	if (QPCToSeconds(GetQPCTime() - pose.timestamp) > OPENTRACK_TIMEOUT)
+		return false;
+	*sample = pose;
+	return true;
+}
+
+bool SendOpenTrackPose(const char *host, int port, const double pose[6])
+{
+	if (!StartupSockets())
+		return false;
+
+	bool result = false;
+	SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (s != INVALID_SOCKET) {
+		struct sockaddr_in remote;
+		memset(&remote, 0, sizeof(remote));
+		remote.sin_family = AF_INET;
+		remote.sin_port = htons(port);
+		inet_pton(AF_INET, host, &remote.sin_addr);
+		result = sendto(s, (const char *)pose, 6 * sizeof(double), 0,
+			(struct sockaddr *)&remote, sizeof(remote)) == 6 * sizeof(double);
+		closesocket(s);
+	}
+	CleanupSockets();
+	return result;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "TrackerSampler.h"
+
+/*
+ * Native OpenTrack tracker. OpenTrack's "UDP over network" output sends one packet per pose
+ * with six little-endian doubles: x, y, z (centimeters) and yaw, pitch, roll (degrees).
+ * The packets are received on a background thread and the newest pose is published through
+ * a SeqLock, so reading it never blocks the game.
+ */
+constexpr int DEFAULT_OPENTRACK_PORT = 4242;
+
+extern int g_iOpenTrackPort;
+
+bool InitOpenTrack();
+void ShutdownOpenTrack();
+// Copies the newest pose. Returns false if nothing has been received recently.
+bool ReadOpenTrackSample(TrackerSample *sample);
+
+// Sends a pose in OpenTrack's format. Useful to feed the tracker from a script or a test
+// without OpenTrack or any hardware (e.g. to 127.0.0.1).
+bool SendOpenTrackPose(const char *host, int port, const double pose[6]);
@@ -0,0 +1,129 @@
+#include <math.h>
+#include "PoseDropout.h"
+
+// Samples further apart than this are not used to estimate the velocity
+constexpr double MAX_VELOCITY_GAP = 0.25;
+// Time constant used to smooth the velocity, in seconds
+constexpr float VELOCITY_TIME_CONSTANT = 0.05f;
+// The decay is considered done after this many time constants (< 1% left)
+constexpr float DECAY_TIME_CONSTANTS = 5.0f;
+// The blend is dropped once the remaining difference is below this fraction
+constexpr float MIN_BLEND_WEIGHT = 0.001f;
+
+PoseDropout::PoseDropout()
+{
+	extrapolationTime = 0.1f;
+	decayTime = 0.3f;
+	blendTime = 0.15f;
+	home = TrackerSample();
+	Reset();
+}
+
+void PoseDropout::Reset()
+{
+	lastInput = lastOutput = TrackerSample();
+	vYaw = vPitch = vRoll = 0.0f;
+	vX = vY = vZ = 0.0f;
+	dYaw = dPitch = dRoll = 0.0f;
+	dX = dY = dZ = 0.0f;
+	reacquireTime = 0;
+	hasInput = lost = blending = false;
+}
+
+void PoseDropout::SetHome(const TrackerSample& home)
+{
+	this->home = home;
+}
+
+bool PoseDropout::Apply(LONGLONG now, TrackerSample* sample)
+{
+	if (!sample->valid) {
+		// Nothing to extrapolate from
+		if (!hasInput)
+			return false;
+
+		lost = true;
+		blending = false;
+		const float elapsed = (float)QPCToSeconds(now - lastInput.timestamp);
+		const float tExtrapolation = elapsed < extrapolationTime ? elapsed : extrapolationTime;
+		if (elapsed > extrapolationTime + DECAY_TIME_CONSTANTS * decayTime) {
+			// Give up, the pose is already at home
+			lastOutput = home;
+			return false;
+		}
+
+		TrackerSample out;
+		out.yaw   = lastInput.yaw   + vYaw   * tExtrapolation;
+		out.pitch = lastInput.pitch + vPitch * tExtrapolation;
+		out.roll  = lastInput.roll  + vRoll  * tExtrapolation;
+		out.x = lastInput.x + vX * tExtrapolation;
+		out.y = lastInput.y + vY * tExtrapolation;
+		out.z = lastInput.z + vZ * tExtrapolation;
+		if (elapsed > extrapolationTime) {
+			const float k = expf(-(elapsed - extrapolationTime) / decayTime);
+			out.yaw   = home.yaw   + k * AngleDiff(out.yaw,   home.yaw);
+			out.pitch = home.pitch + k * AngleDiff(out.pitch, home.pitch);
+			out.roll  = home.roll  + k * AngleDiff(out.roll,  home.roll);
+			out.x = home.x + k * (out.x - home.x);
+			out.y = home.y + k * (out.y - home.y);
+			out.z = home.z + k * (out.z - home.z);
+		}
+		out.timestamp = now;
+		out.valid = true;
+		lastOutput = out;
+		*sample = out;
+		return true;
+	}
+
+	// Valid sample. Update the velocity with new data only, repeats don't carry any motion.
+	if (hasInput && !lost && sample->timestamp > lastInput.timestamp) {
+		const double dt = QPCToSeconds(sample->timestamp - lastInput.timestamp);
+		if (dt < MAX_VELOCITY_GAP) {
+			const float invDt = (float)(1.0 / dt);
+			const float alpha = 1.0f - expf(-(float)dt / VELOCITY_TIME_CONSTANT);
+			vYaw   += alpha * (AngleDiff(sample->yaw,   lastInput.yaw)   * invDt - vYaw);
+			vPitch += alpha * (AngleDiff(sample->pitch, lastInput.pitch) * invDt - vPitch);
+			vRoll  += alpha * (AngleDiff(sample->roll,  lastInput.roll)  * invDt - vRoll);
+			vX += alpha * ((sample->x - lastInput.x) * invDt - vX);
+			vY += alpha * ((sample->y - lastInput.y) * invDt - vY);
+			vZ += alpha * ((sample->z - lastInput.z) * invDt - vZ);
+		}
+		else {
+			vYaw = vPitch = vRoll = 0.0f;
+			vX = vY = vZ = 0.0f;
+		}
+	}
+
+	if (lost) {
+		// Back from a loss: start from wherever the made-up pose left the camera
+		dYaw   = AngleDiff(lastOutput.yaw,   sample->yaw);
+		dPitch = AngleDiff(lastOutput.pitch, sample->pitch);
+		dRoll  = AngleDiff(lastOutput.roll,  sample->roll);
+		dX = lastOutput.x - sample->x;
+		dY = lastOutput.y - sample->y;
+		dZ = lastOutput.z - sample->z;
+		reacquireTime = now;
+		blending = blendTime > 0.0f;
+		lost = false;
+		vYaw = vPitch = vRoll = 0.0f;
+		vX = vY = vZ = 0.0f;
+	}
+	lastInput = *sample;
+	hasInput = true;
+
+	if (blending) {
+		const float k = expf(-(float)QPCToSeconds(now - reacquireTime) / blendTime);
+		if (k < MIN_BLEND_WEIGHT)
+			blending = false;
+		else {
+			sample->yaw   += k * dYaw;
+			sample->pitch += k * dPitch;
+			sample->roll  += k * dRoll;
+			sample->x += k * dX;
+			sample->y += k * dY;
+			sample->z += k * dZ;
+		}
+	}
+	lastOutput = *sample;
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "TrackerSampler.h"
+
+/*
+ * Covers short tracking losses (occlusions, a missed packet, a busy device) so they don't
+ * snap the camera.
+ *
+ * While the tracker is lost, the pose keeps moving with its last velocity for a moment, then
+ * settles exponentially toward the home pose (the one recorded when the view was last
+ * recentered). When the tracker comes back, the difference between the made-up pose and the
+ * real one fades out with a time constant. If the loss lasts long enough for the pose to reach
+ * home, the samples are reported as invalid again and each tracker does what it did before.
+ */
+class PoseDropout
+{
+public:
+	// Seconds to keep extrapolating after the last valid sample
+	float extrapolationTime;
+	// Time constant, in seconds, of the decay toward the home pose
+	float decayTime;
+	// Time constant, in seconds, of the blend back into the real pose
+	float blendTime;
+
+	PoseDropout();
+
+	void Reset();
+	// Pose to settle at during long losses, in the same units as the samples
+	void SetHome(const TrackerSample& home);
+	// Replaces invalid samples with a made-up pose, and blends valid samples after a loss.
+	// Returns sample->valid.
+	bool Apply(LONGLONG now, TrackerSample* sample);
+
+private:
+	TrackerSample home, lastInput, lastOutput;
+	// Smoothed velocity of the input, per second
+	float vYaw, vPitch, vRoll;
+	float vX, vY, vZ;
+	// Difference between the made-up pose and the real one when the tracker came back
+	float dYaw, dPitch, dRoll;
+	float dX, dY, dZ;
+	LONGLONG reacquireTime;
+	bool hasInput, lost, blending;
+};
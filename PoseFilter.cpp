@@ -0,0 +1,205 @@
+#include <math.h>
+#include "PoseFilter.h"
+
+constexpr float TWO_PI = 6.283185f;
+// Samples further apart than this restart the filter
+constexpr double MAX_FILTER_GAP = 0.5;
+// The noise estimate is a plain average of this many samples before it starts clipping
+constexpr int JITTER_WARMUP_SAMPLES = 30;
+// Second differences further than this many standard deviations away are clipped
+constexpr float JITTER_CLIP_SIGMAS = 3.0f;
+
+// Smoothing factor of a first-order low-pass filter with the given cutoff
+static inline float LowPassAlpha(float cutoff, float dt) {
+	const float tau = 1.0f / (TWO_PI * cutoff);
+	return 1.0f / (1.0f + tau / dt);
+}
+
+OneEuroFilter::OneEuroFilter()
+{
+	Reset();
+}
+
+void OneEuroFilter::Reset()
+{
+	xPrev = dxPrev = 0.0f;
+	initialized = false;
+}
+
+float OneEuroFilter::Filter(float x, float dt, float minCutoff, float beta, float dCutoff, bool isAngle)
+{
+	if (!initialized || dt <= 0.0f) {
+		xPrev = x;
+		dxPrev = 0.0f;
+		initialized = true;
+		return x;
+	}
+
+	// Unwrap angles so that crossing +/-180 doesn't sweep the filter around the circle
+	const float delta = isAngle ? AngleDiff(x, xPrev) : x - xPrev;
+	x = xPrev + delta;
+
+	// Estimate the (smoothed) speed of the signal...
+	const float dx = delta / dt;
+	const float dxHat = dxPrev + LowPassAlpha(dCutoff, dt) * (dx - dxPrev);
+	// ... and use it to open up the cutoff
+	const float cutoff = minCutoff + beta * fabsf(dxHat);
+	const float xHat = xPrev + LowPassAlpha(cutoff, dt) * (x - xPrev);
+
+	xPrev = xHat;
+	dxPrev = dxHat;
+	return xHat;
+}
+
+JitterEstimator::JitterEstimator()
+{
+	timeConstant = 2.0f;
+	Reset();
+}
+
+void JitterEstimator::Reset()
+{
+	x1 = x2 = 0.0f;
+	variance = meanDt = 0.0f;
+	history = count = 0;
+}
+
+bool JitterEstimator::IsReady() const
+{
+	return count >= JITTER_WARMUP_SAMPLES;
+}
+
+void JitterEstimator::AddSample(float x, float dt, bool isAngle)
+{
+	// After a gap the differences start over, but the noise of the device is still the same
+	if (dt <= 0.0f || history == 0) {
+		x1 = x;
+		history = 1;
+		return;
+	}
+
+	if (isAngle)
+		x = x1 + AngleDiff(x, x1);
+	if (history == 1) {
+		x2 = x1;
+		x1 = x;
+		history = 2;
+		return;
+	}
+
+	const float d2 = (x - x1) - (x1 - x2);
+	x2 = x1;
+	x1 = x;
+
+	float e = d2 * d2 * (1.0f / 6.0f);
+	if (IsReady() && variance > 0.0f) {
+		const float limit = JITTER_CLIP_SIGMAS * JITTER_CLIP_SIGMAS * variance;
+		if (e > limit)
+			e = limit;
+	}
+
+	// Plain average while warming up, then an exponential one over timeConstant
+	count++;
+	float alpha = dt / (timeConstant + dt);
+	if (alpha < 1.0f / count)
+		alpha = 1.0f / count;
+	variance += alpha * (e - variance);
+	meanDt += alpha * (dt - meanDt);
+}
+
+PoseFilter::PoseFilter()
+{
+	rotMinCutoff = 1.0f;
+	rotBeta = 0.05f;
+	posMinCutoff = 1.0f;
+	posBeta = 5.0f;
+	dCutoff = 1.0f;
+	autoCutoff = false;
+	rotNoiseTarget = 0.02f;
+	posNoiseTarget = 0.0f;
+	minAutoCutoff = 0.1f;
+	maxAutoCutoff = 5.0f;
+	Reset();
+}
+
+void PoseFilter::Reset()
+{
+	Restart();
+	for (int i = 0; i < POSE_AXIS_COUNT; i++) {
+		noise[i].Reset();
+		cutoff[i] = 0.0f;
+	}
+}
+
+void PoseFilter::Restart()
+{
+	yaw.Reset(); pitch.Reset(); roll.Reset();
+	x.Reset(); y.Reset(); z.Reset();
+	lastOutput = TrackerSample();
+	hasLast = false;
+}
+
+/*
+ * A first-order low-pass filter with smoothing factor a scales the standard deviation of
+ * white noise by sqrt(a / (2 - a)). Solve that for the noise target and turn the smoothing
+ * factor back into a cutoff at the measured sample rate.
+ */
+float PoseFilter::AutoCutoff(PoseAxis axis, float manualCutoff, float target) const
+{
+	const JitterEstimator& estimator = noise[axis];
+	if (!autoCutoff || target <= 0.0f || !estimator.IsReady())
+		return manualCutoff;
+
+	const float sigma = estimator.GetNoise();
+	if (sigma <= target)
+		return maxAutoCutoff;
+
+	const float r2 = (target * target) / (sigma * sigma);
+	const float alpha = 2.0f * r2 / (1.0f + r2);
+	float result = alpha * estimator.GetSampleRate() / (TWO_PI * (1.0f - alpha));
+	if (result < minAutoCutoff) result = minAutoCutoff;
+	if (result > maxAutoCutoff) result = maxAutoCutoff;
+	return result;
+}
+
+void PoseFilter::Apply(TrackerSample* sample)
+{
+	if (!sample->valid) {
+		Restart();
+		return;
+	}
+
+	if (hasLast && sample->timestamp == lastOutput.timestamp) {
+		*sample = lastOutput;
+		return;
+	}
+
+	float dt = 0.0f;
+	if (hasLast) {
+		const double gap = QPCToSeconds(sample->timestamp - lastOutput.timestamp);
+		if (gap > 0.0 && gap < MAX_FILTER_GAP)
+			dt = (float)gap;
+	}
+
+	// The noise is measured on the raw samples, before they're smoothed
+	noise[POSE_AXIS_YAW].AddSample(sample->yaw,     dt, true);
+	noise[POSE_AXIS_PITCH].AddSample(sample->pitch, dt, true);
+	noise[POSE_AXIS_ROLL].AddSample(sample->roll,   dt, true);
+	noise[POSE_AXIS_X].AddSample(sample->x, dt, false);
+	noise[POSE_AXIS_Y].AddSample(sample->y, dt, false);
+	noise[POSE_AXIS_Z].AddSample(sample->z, dt, false);
+	for (int i = POSE_AXIS_YAW; i <= POSE_AXIS_ROLL; i++)
+		cutoff[i] = AutoCutoff((PoseAxis)i, rotMinCutoff, rotNoiseTarget);
+	for (int i = POSE_AXIS_X; i <= POSE_AXIS_Z; i++)
+		cutoff[i] = AutoCutoff((PoseAxis)i, posMinCutoff, posNoiseTarget);
+
+	sample->yaw   = yaw.Filter(sample->yaw,     dt, cutoff[POSE_AXIS_YAW],   rotBeta, dCutoff, true);
+	sample->pitch = pitch.Filter(sample->pitch, dt, cutoff[POSE_AXIS_PITCH], rotBeta, dCutoff, true);
+	sample->roll  = roll.Filter(sample->roll,   dt, cutoff[POSE_AXIS_ROLL],  rotBeta, dCutoff, true);
+	sample->x = x.Filter(sample->x, dt, cutoff[POSE_AXIS_X], posBeta, dCutoff, false);
+	sample->y = y.Filter(sample->y, dt, cutoff[POSE_AXIS_Y], posBeta, dCutoff, false);
+	sample->z = z.Filter(sample->z, dt, cutoff[POSE_AXIS_Z], posBeta, dCutoff, false);
+
+	lastOutput = *sample;
+	hasLast = true;
+}
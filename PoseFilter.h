@@ -0,0 +1,103 @@
+#pragma once
+
+#include <math.h>
+#include "TrackerSampler.h"
+
+/*
+ * One-Euro filter: an adaptive low-pass filter whose cutoff frequency rises with the speed
+ * of the signal. Slow movements get heavily smoothed (which hides jitter) while fast
+ * movements go through almost untouched (which keeps the lag low).
+ * See: Casiez, Roussel and Vogel, "1 Euro Filter", CHI 2012.
+ *
+ * The filter runs on real sample timestamps, so it behaves the same no matter how often
+ * the game asks for a new pose.
+ */
+class OneEuroFilter
+{
+public:
+	OneEuroFilter();
+
+	void Reset();
+	// isAngle: the input is an angle in degrees and may wrap around +/-180
+	float Filter(float x, float dt, float minCutoff, float beta, float dCutoff, bool isAngle);
+
+private:
+	float xPrev, dxPrev;
+	bool  initialized;
+};
+
+/*
+ * Running estimate of the measurement noise of one axis.
+ *
+ * Uses the second difference of consecutive samples: it cancels out any motion at constant
+ * speed, and for white noise of variance s^2 its variance is 6 * s^2. Each sample costs a
+ * handful of flops and no history beyond the last two values. Samples far outside the
+ * current estimate (quick head movements, mostly) are clipped so they only nudge it up.
+ */
+class JitterEstimator
+{
+public:
+	float timeConstant; // Seconds over which the estimate is averaged
+
+	JitterEstimator();
+
+	void Reset();
+	void AddSample(float x, float dt, bool isAngle);
+	// Standard deviation of the noise, in the units of the axis
+	float GetNoise() const { return sqrtf(variance); }
+	// Average rate of the samples that were fed so far, in Hz
+	float GetSampleRate() const { return meanDt > 0.0f ? 1.0f / meanDt : 0.0f; }
+	bool  IsReady() const;
+
+private:
+	float x1, x2;
+	float variance, meanDt;
+	int   history, count;
+};
+
+enum PoseAxis {
+	POSE_AXIS_YAW, POSE_AXIS_PITCH, POSE_AXIS_ROLL,
+	POSE_AXIS_X, POSE_AXIS_Y, POSE_AXIS_Z,
+	POSE_AXIS_COUNT
+};
+
+/*
+ * Per-axis One-Euro filtering for a whole TrackerSample.
+ */
+class PoseFilter
+{
+public:
+	// Cutoffs are in Hz. Beta is in 1/(units per second), so it's separate for the angles
+	// and the positions.
+	float rotMinCutoff, rotBeta;
+	float posMinCutoff, posBeta;
+	float dCutoff;
+	// Automatic min cutoff: each axis gets the lowest lag that keeps its measured noise
+	// below the target (degrees for the angles, device units for the positions).
+	bool  autoCutoff;
+	float rotNoiseTarget, posNoiseTarget;
+	float minAutoCutoff, maxAutoCutoff;
+
+	PoseFilter();
+
+	void Reset();
+	// Filters the sample in place. Samples that were already seen (same timestamp) get the
+	// previous output without advancing the filter.
+	void Apply(TrackerSample* sample);
+
+	// Measured noise (standard deviation) and min cutoff currently in use for each axis
+	float GetNoise(PoseAxis axis) const { return noise[axis].GetNoise(); }
+	float GetCutoff(PoseAxis axis) const { return cutoff[axis]; }
+
+private:
+	// Restarts the smoothing but keeps the noise estimates
+	void  Restart();
+	float AutoCutoff(PoseAxis axis, float manualCutoff, float target) const;
+
+	OneEuroFilter yaw, pitch, roll;
+	OneEuroFilter x, y, z;
+	JitterEstimator noise[POSE_AXIS_COUNT];
+	float cutoff[POSE_AXIS_COUNT];
+	TrackerSample lastOutput;
+	bool hasLast;
+};
@@ -0,0 +1,101 @@
+#include "PoseFusion.h"
+
+PoseHistory::PoseHistory()
+{
+	Reset();
+}
+
+void PoseHistory::Reset()
+{
+	head = POSE_HISTORY_SIZE - 1;
+	count = 0;
+}
+
+void PoseHistory::Add(const TrackerSample& sample)
+{
+	if (!sample.valid)
+		return;
+	if (count > 0 && sample.timestamp <= samples[head].timestamp)
+		return;
+	head = (head + 1) % POSE_HISTORY_SIZE;
+	samples[head] = sample;
+	if (count < POSE_HISTORY_SIZE)
+		count++;
+}
+
+bool PoseHistory::SampleAt(LONGLONG t, TrackerSample* out) const
+{
+	if (count == 0)
+		return false;
+
+	// Walk back from the newest sample until we find the one right before t
+	int next = head;
+	if (t >= samples[next].timestamp) {
+		*out = samples[next];
+		return true;
+	}
+	for (int i = 1; i < count; i++) {
+		const int prev = (head - i + POSE_HISTORY_SIZE) % POSE_HISTORY_SIZE;
+		const TrackerSample& a = samples[prev];
+		if (t >= a.timestamp) {
+			const TrackerSample& b = samples[next];
+			const float u = (float)(t - a.timestamp) / (float)(b.timestamp - a.timestamp);
+			out->yaw   = a.yaw   + u * AngleDiff(b.yaw,   a.yaw);
+			out->pitch = a.pitch + u * AngleDiff(b.pitch, a.pitch);
+			out->roll  = a.roll  + u * AngleDiff(b.roll,  a.roll);
+			out->x = a.x + u * (b.x - a.x);
+			out->y = a.y + u * (b.y - a.y);
+			out->z = a.z + u * (b.z - a.z);
+			out->timestamp = t;
+			out->valid = true;
+			return true;
+		}
+		next = prev;
+	}
+	// Older than anything we have
+	*out = samples[next];
+	return true;
+}
+
+PoseFusion::PoseFusion()
+{
+	maxStale = 0.25f;
+}
+
+void PoseFusion::Reset()
+{
+	rotation.Reset();
+	position.Reset();
+}
+
+bool PoseFusion::Fuse(LONGLONG now, TrackerSample* out) const
+{
+	const bool bRotation = !rotation.IsEmpty() && QPCToSeconds(now - rotation.Newest().timestamp) <= maxStale;
+	const bool bPosition = !position.IsEmpty() && QPCToSeconds(now - position.Newest().timestamp) <= maxStale;
+	if (!bRotation && !bPosition) {
+		out->valid = false;
+		return false;
+	}
+
+	// The newest time both sources know about
+	LONGLONG t;
+	if (bRotation && bPosition) {
+		const LONGLONG tRot = rotation.Newest().timestamp, tPos = position.Newest().timestamp;
+		t = tRot < tPos ? tRot : tPos;
+	}
+	else
+		t = bRotation ? rotation.Newest().timestamp : position.Newest().timestamp;
+
+	TrackerSample rot, pos;
+	rotation.SampleAt(t, &rot);
+	position.SampleAt(t, &pos);
+	out->yaw   = rot.yaw;
+	out->pitch = rot.pitch;
+	out->roll  = rot.roll;
+	out->x = pos.x;
+	out->y = pos.y;
+	out->z = pos.z;
+	out->timestamp = t;
+	out->valid = true;
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "TrackerSampler.h"
+
+constexpr int POSE_HISTORY_SIZE = 32;
+
+/*
+ * Short history of timestamped samples from one source, used to evaluate the source at an
+ * arbitrary time in the recent past.
+ */
+class PoseHistory
+{
+public:
+	PoseHistory();
+
+	void Reset();
+	// Samples that don't move the timestamp forward are repeats and are ignored
+	void Add(const TrackerSample& sample);
+	bool IsEmpty() const { return count == 0; }
+	const TrackerSample& Newest() const { return samples[head]; }
+	// Interpolates the two samples around t. Times outside the history are clamped to the
+	// oldest or newest sample. Returns false if the history is empty.
+	bool SampleAt(LONGLONG t, TrackerSample* out) const;
+
+private:
+	TrackerSample samples[POSE_HISTORY_SIZE];
+	int head, count;
+};
+
+/*
+ * Combines the rotation of one source with the position of another one.
+ *
+ * The two sources are read at different times and rates, so pairing their latest samples
+ * would mix poses that can be tens of milliseconds apart. Instead, both are resampled at the
+ * newest time covered by both histories, and the fused sample gets that timestamp; the
+ * predictor downstream takes it the rest of the way to the display time.
+ */
+class PoseFusion
+{
+public:
+	// A source that hasn't produced a sample for this long (in seconds) is lost; the other
+	// one is used on its own and the lost one is held at its last value.
+	float maxStale;
+
+	PoseHistory rotation, position;
+
+	PoseFusion();
+
+	void Reset();
+	// Fills out with the time-aligned pose. Returns false if both sources are lost.
+	bool Fuse(LONGLONG now, TrackerSample* out) const;
+};
@@ -0,0 +1,195 @@
+#include <math.h>
+#include "PosePredictor.h"
+
+// Samples further apart than this are not used to estimate the velocity
+constexpr double MAX_SAMPLE_GAP = 0.25;
+// Never extrapolate further than this, no matter how old the last sample is
+constexpr float MAX_PREDICTION_TIME = 0.1f;
+
+static inline float clampf(float x, float lowerlimit, float upperlimit) {
+	if (x < lowerlimit) x = lowerlimit; else if (x > upperlimit) x = upperlimit;
+	return x;
+}
+
+PosePredictor::PosePredictor()
+{
+	horizon = 0.0f;
+	maxAngle = 10.0f;
+	maxPos = 0.05f;
+	velocityTimeConstant = 0.02f;
+	Reset();
+}
+
+void PosePredictor::Reset()
+{
+	last = TrackerSample();
+	vYaw = vPitch = vRoll = 0.0f;
+	vX = vY = vZ = 0.0f;
+	period = 0.0f;
+	hasLast = hasVelocity = false;
+}
+
+void PosePredictor::StopVelocity()
+{
+	vYaw = vPitch = vRoll = 0.0f;
+	vX = vY = vZ = 0.0f;
+}
+
+void PosePredictor::AddSample(const TrackerSample& sample)
+{
+	if (!sample.valid) {
+		Reset();
+		return;
+	}
+
+	if (!hasLast) {
+		last = sample;
+		hasLast = true;
+		return;
+	}
+
+	if (sample.timestamp <= last.timestamp)
+		return;
+	const double dt = QPCToSeconds(sample.timestamp - last.timestamp);
+
+	// The same values may be seen several times if the device updates slower than the game
+	// renders; within a couple of periods, those repeats don't carry any motion information.
+	// Past that, the head has stopped: the velocity is zero from here on.
+	if (sample.yaw == last.yaw && sample.pitch == last.pitch && sample.roll == last.roll &&
+		sample.x == last.x && sample.y == last.y && sample.z == last.z)
+	{
+		if (period > 0.0f && dt > 2.0 * period) {
+			StopVelocity();
+			last = sample;
+		}
+		return;
+	}
+
+	if (dt > MAX_SAMPLE_GAP) {
+		// Too old to tell us anything about the current motion
+		last = sample;
+		StopVelocity();
+		hasVelocity = false;
+		return;
+	}
+	period = period > 0.0f ? period + 0.1f * ((float)dt - period) : (float)dt;
+
+	const float invDt = (float)(1.0 / dt);
+	const float rawYaw   = AngleDiff(sample.yaw,   last.yaw)   * invDt;
+	const float rawPitch = AngleDiff(sample.pitch, last.pitch) * invDt;
+	const float rawRoll  = AngleDiff(sample.roll,  last.roll)  * invDt;
+	const float rawX = (sample.x - last.x) * invDt;
+	const float rawY = (sample.y - last.y) * invDt;
+	const float rawZ = (sample.z - last.z) * invDt;
+
+	if (!hasVelocity) {
+		vYaw = rawYaw; vPitch = rawPitch; vRoll = rawRoll;
+		vX = rawX; vY = rawY; vZ = rawZ;
+		hasVelocity = true;
+	}
+	else {
+		// Time-based smoothing, so the estimate doesn't depend on the device's rate
+		const float alpha = velocityTimeConstant > 0.0f ?
+			1.0f - expf(-(float)dt / velocityTimeConstant) : 1.0f;
+		vYaw   += alpha * (rawYaw   - vYaw);
+		vPitch += alpha * (rawPitch - vPitch);
+		vRoll  += alpha * (rawRoll  - vRoll);
+		vX += alpha * (rawX - vX);
+		vY += alpha * (rawY - vY);
+		vZ += alpha * (rawZ - vZ);
+	}
+	last = sample;
+}
+
+bool PosePredictor::Predict(LONGLONG now, TrackerSample* out) const
+{
+	if (!hasLast)
+		return false;
+
+	*out = last;
+	if (!hasVelocity)
+		return true;
+
+	const float age = (float)QPCToSeconds(now - last.timestamp);
+	const float t = clampf(age + horizon, 0.0f, MAX_PREDICTION_TIME);
+	// Nothing new for a while: the device may have stopped sending (TrackIR and FreePIE drop
+	// repeated frames before they get here), so let the correction go
+	float fade = 1.0f;
+	if (period > 0.0f && age > 2.0f * period)
+		fade = clampf(1.0f - (age - 2.0f * period) / period, 0.0f, 1.0f);
+
+	out->yaw   += fade * clampf(vYaw   * t, -maxAngle, maxAngle);
+	out->pitch += fade * clampf(vPitch * t, -maxAngle, maxAngle);
+	out->roll  += fade * clampf(vRoll  * t, -maxAngle, maxAngle);
+	out->x += fade * clampf(vX * t, -maxPos, maxPos);
+	out->y += fade * clampf(vY * t, -maxPos, maxPos);
+	out->z += fade * clampf(vZ * t, -maxPos, maxPos);
+	return true;
+}
+
+PoseInterpolator::PoseInterpolator()
+{
+	delay = -1.0f;
+	Reset();
+}
+
+void PoseInterpolator::Reset()
+{
+	prev = last = TrackerSample();
+	period = 0.0f;
+	numSamples = 0;
+}
+
+void PoseInterpolator::AddSample(const TrackerSample& sample)
+{
+	if (!sample.valid) {
+		Reset();
+		return;
+	}
+	if (numSamples > 0 && sample.timestamp <= last.timestamp)
+		return;
+
+	if (numSamples > 0) {
+		const double dt = QPCToSeconds(sample.timestamp - last.timestamp);
+		if (dt > MAX_SAMPLE_GAP) {
+			// The tracker stalled, don't blend across the gap
+			numSamples = 0;
+			period = 0.0f;
+		}
+		else
+			period = period > 0.0f ? period + 0.1f * ((float)dt - period) : (float)dt;
+	}
+
+	prev = last;
+	last = sample;
+	if (numSamples < 2)
+		numSamples++;
+}
+
+bool PoseInterpolator::Sample(LONGLONG now, TrackerSample* out) const
+{
+	if (numSamples == 0)
+		return false;
+
+	*out = last;
+	if (numSamples < 2)
+		return true;
+
+	const double span = QPCToSeconds(last.timestamp - prev.timestamp);
+	if (span <= 0.0)
+		return true;
+
+	const float d = delay >= 0.0f ? delay : period;
+	const double target = QPCToSeconds(now - prev.timestamp) - d;
+	// u = 0 is prev, u = 1 is last. Don't go back past prev or more than one period ahead.
+	const float u = clampf((float)(target / span), 0.0f, 2.0f);
+
+	out->yaw   = prev.yaw   + u * AngleDiff(last.yaw,   prev.yaw);
+	out->pitch = prev.pitch + u * AngleDiff(last.pitch, prev.pitch);
+	out->roll  = prev.roll  + u * AngleDiff(last.roll,  prev.roll);
+	out->x = prev.x + u * (last.x - prev.x);
+	out->y = prev.y + u * (last.y - prev.y);
+	out->z = prev.z + u * (last.z - prev.z);
+	out->timestamp = prev.timestamp + (LONGLONG)(u * (double)(last.timestamp - prev.timestamp));
+	return true;
+}
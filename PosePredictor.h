@@ -0,0 +1,73 @@
+#pragma once
+
+#include "TrackerSampler.h"
+
+/*
+ * Extrapolates the head pose to the time when the frame will be displayed.
+ *
+ * Angular and linear velocities are estimated from consecutive timestamped samples and
+ * smoothed with a time-based exponential filter. The prediction is clamped so that a noisy
+ * velocity estimate can't throw the camera around. Angles are expected in degrees; positions
+ * are in whatever units the device reports, that's why the clamps are set per tracker.
+ *
+ * A device that stops delivering new values (because the head stopped, or because it only
+ * repeats its last frame) stops the prediction too: once the last change is more than two
+ * sample periods old, the correction fades out over one more period.
+ */
+class PosePredictor
+{
+public:
+	// Seconds to predict beyond the age of the last sample
+	float horizon;
+	// Largest correction that can be applied, in degrees and device units respectively
+	float maxAngle, maxPos;
+	// Time constant, in seconds, used to smooth the velocity estimate
+	float velocityTimeConstant;
+
+	PosePredictor();
+
+	void Reset();
+	// Feeds a new sample. Repeated samples and invalid samples are handled internally.
+	void AddSample(const TrackerSample& sample);
+	// Writes the last sample, extrapolated to now + horizon, into out.
+	// Returns false if there isn't enough data to predict anything.
+	bool Predict(LONGLONG now, TrackerSample* out) const;
+
+private:
+	TrackerSample last;
+	float vYaw, vPitch, vRoll;
+	float vX, vY, vZ;
+	// Smoothed time between samples that changed, in seconds
+	float period;
+	bool  hasLast, hasVelocity;
+
+	void StopVelocity();
+};
+
+/*
+ * Resamples a slow tracker at the game's frame rate. The pose is evaluated at now - delay on
+ * the line between the last two distinct samples: a delay of about one sample period gives a
+ * pure interpolation (smooth, but one period late); a delay of zero extrapolates up to one
+ * period instead.
+ */
+class PoseInterpolator
+{
+public:
+	// Seconds behind the current time where the pose is evaluated. Negative: use the
+	// measured sample period.
+	float delay;
+
+	PoseInterpolator();
+
+	void Reset();
+	// Samples with the same timestamp as the last one are repeats and are ignored
+	void AddSample(const TrackerSample& sample);
+	// Writes the pose at now - delay into out. The timestamp of out is set to that time.
+	bool Sample(LONGLONG now, TrackerSample* out) const;
+
+private:
+	TrackerSample prev, last;
+	// Smoothed time between samples, in seconds
+	float period;
+	int numSamples;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <math.h>
+#include "Matrices.h"
+
+/*
+ * Unit quaternion used to carry the head's rotation from the tracker to the camera transform
+ * without going through Euler angles.
+ *
+ * Angles are in degrees and use the same conventions as Matrix4::rotateX/Y/Z, so
+ * FromAxisAngle(0,1,0, a) rotates like Matrix4().rotateY(a).
+ */
+struct Quaternion
+{
+	float x, y, z, w;
+
+	Quaternion() : x(0), y(0), z(0), w(1) {}
+	Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	// Rotation of angle degrees around the unit axis (ax, ay, az)
+	static Quaternion FromAxisAngle(float ax, float ay, float az, float angle) {
+		const float halfRad = angle * (3.14159265f / 360.0f);
+		const float s = sinf(halfRad);
+		return Quaternion(ax * s, ay * s, az * s, cosf(halfRad));
+	}
+
+	// Same rotation as Matrix4().rotateY(yaw) * Matrix4().rotateX(pitch) * Matrix4().rotateZ(roll)
+	static Quaternion FromYawPitchRoll(float yaw, float pitch, float roll) {
+		return FromAxisAngle(0, 1, 0, yaw) * FromAxisAngle(1, 0, 0, pitch) * FromAxisAngle(0, 0, 1, roll);
+	}
+
+	// Inverse of FromYawPitchRoll(). Pitch is in [-90, 90]; at +/-90 the roll is folded into the yaw.
+	void toYawPitchRoll(float* yaw, float* pitch, float* roll) const {
+		const float RAD_TO_DEG_F = 57.2957795f;
+		const float sinPitch = 2.0f * (w * x - y * z);
+		if (fabsf(sinPitch) >= 0.99999f) {
+			*pitch = sinPitch > 0.0f ? 90.0f : -90.0f;
+			*yaw = atan2f(2.0f * (w * y - x * z), 1.0f - 2.0f * (y * y + z * z)) * RAD_TO_DEG_F;
+			*roll = 0.0f;
+			return;
+		}
+		*pitch = asinf(sinPitch) * RAD_TO_DEG_F;
+		*yaw   = atan2f(2.0f * (x * z + w * y), 1.0f - 2.0f * (x * x + y * y)) * RAD_TO_DEG_F;
+		*roll  = atan2f(2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z)) * RAD_TO_DEG_F;
+	}
+
+	Quaternion operator*(const Quaternion& q) const {
+		return Quaternion(
+			w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w,
+			w * q.w - x * q.x - y * q.y - z * q.z);
+	}
+
+	Quaternion& normalize() {
+		const float len = sqrtf(x * x + y * y + z * z + w * w);
+		if (len > 0.0f) {
+			const float inv = 1.0f / len;
+			x *= inv; y *= inv; z *= inv; w *= inv;
+		}
+		return *this;
+	}
+
+	bool isIdentity() const {
+		return x == 0.0f && y == 0.0f && z == 0.0f;
+	}
+
+	/*
+	 * Scales the rotation in the exponential map: the rotation vector (axis * angle) is
+	 * multiplied per component by (sx, sy, sz). A single-axis rotation of angle a becomes a
+	 * rotation of s * a around the same axis; mixed rotations are scaled without going
+	 * through Euler angles, so there are no singularities.
+	 */
+	Quaternion scaled(float sx, float sy, float sz) const {
+		// Take the shortest path, q and -q are the same rotation
+		const float sign = w < 0.0f ? -1.0f : 1.0f;
+		const float vx = sign * x, vy = sign * y, vz = sign * z;
+		const float vLen = sqrtf(vx * vx + vy * vy + vz * vz);
+		if (vLen < 1e-7f)
+			return Quaternion();
+		// log: half-angle times the unit axis
+		const float k = atan2f(vLen, sign * w) / vLen;
+		const float rx = vx * k * sx, ry = vy * k * sy, rz = vz * k * sz;
+		// exp
+		const float rLen = sqrtf(rx * rx + ry * ry + rz * rz);
+		if (rLen < 1e-7f)
+			return Quaternion();
+		const float s = sinf(rLen) / rLen;
+		return Quaternion(rx * s, ry * s, rz * s, cosf(rLen));
+	}
+
+	Matrix3 toMatrix3() const {
+		const float xx = x * x, yy = y * y, zz = z * z;
+		const float xy = x * y, xz = x * z, yz = y * z;
+		const float wx = w * x, wy = w * y, wz = w * z;
+		// Matrix3 takes its arguments in column order
+		return Matrix3(
+			1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy),
+			2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx),
+			2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+	}
+};
@@ -0,0 +1,135 @@
+#include <math.h>
+#include <stdlib.h>
+#include "ResponseCurve.h"
+
+void log_debug(const char *format, ...);
+
+ResponseCurve::ResponseCurve()
+{
+	Clear();
+}
+
+void ResponseCurve::Clear()
+{
+	numPoints = 0;
+	maxInput = inputToIndex = 0.0f;
+}
+
+bool ResponseCurve::Parse(const char* spec)
+{
+	Clear();
+	const char* p = spec;
+	while (*p != '\0') {
+		char* end;
+		const float x = (float)strtod(p, &end);
+		if (end == p || *end != ':')
+			break;
+		p = end + 1;
+		const float y = (float)strtod(p, &end);
+		if (end == p)
+			break;
+		p = (*end == ',') ? end + 1 : end;
+
+		if (numPoints == 0 && x > 0.0f) {
+			pointX[0] = pointY[0] = 0.0f;
+			numPoints = 1;
+		}
+		if (numPoints == RESPONSE_CURVE_MAX_POINTS) {
+			log_debug("[Curve] Too many points in %s, the maximum is %d", spec, RESPONSE_CURVE_MAX_POINTS);
+			Clear();
+			return false;
+		}
+		if (x < 0.0f || (numPoints > 0 && x <= pointX[numPoints - 1])) {
+			log_debug("[Curve] The inputs in %s must be positive and increasing", spec);
+			Clear();
+			return false;
+		}
+		pointX[numPoints] = x;
+		pointY[numPoints] = y;
+		numPoints++;
+	}
+
+	if (*p != '\0' || numPoints < 2) {
+		log_debug("[Curve] Could not parse %s", spec);
+		Clear();
+		return false;
+	}
+
+	for (int i = 1; i < numPoints; i++)
+		if (pointY[i] < pointY[i - 1]) {
+			log_debug("[Curve] Warning: %s is not monotonic, the view will move backwards at %0.1f degrees", spec, pointX[i - 1]);
+			break;
+		}
+
+	Bake();
+	return true;
+}
+
+/*
+ * Fritsch-Carlson monotone cubic interpolation: the tangents are limited so the spline never
+ * overshoots between two points, so a monotonic set of points gives a monotonic curve.
+ */
+void ResponseCurve::Bake()
+{
+	const int n = numPoints;
+	float secant[RESPONSE_CURVE_MAX_POINTS], tangent[RESPONSE_CURVE_MAX_POINTS];
+	for (int i = 0; i < n - 1; i++)
+		secant[i] = (pointY[i + 1] - pointY[i]) / (pointX[i + 1] - pointX[i]);
+
+	tangent[0] = secant[0];
+	tangent[n - 1] = secant[n - 2];
+	for (int i = 1; i < n - 1; i++)
+		tangent[i] = (secant[i - 1] * secant[i] <= 0.0f) ? 0.0f : 0.5f * (secant[i - 1] + secant[i]);
+
+	for (int i = 0; i < n - 1; i++) {
+		if (secant[i] == 0.0f) {
+			tangent[i] = tangent[i + 1] = 0.0f;
+			continue;
+		}
+		const float a = tangent[i] / secant[i];
+		const float b = tangent[i + 1] / secant[i];
+		const float len2 = a * a + b * b;
+		if (len2 > 9.0f) {
+			const float tau = 3.0f / sqrtf(len2);
+			tangent[i]     = tau * a * secant[i];
+			tangent[i + 1] = tau * b * secant[i];
+		}
+	}
+
+	maxInput = pointX[n - 1];
+	inputToIndex = RESPONSE_CURVE_LUT_SIZE / maxInput;
+	int segment = 0;
+	for (int i = 0; i <= RESPONSE_CURVE_LUT_SIZE; i++) {
+		const float x = i * maxInput / RESPONSE_CURVE_LUT_SIZE;
+		while (segment < n - 2 && x > pointX[segment + 1])
+			segment++;
+		// Cubic Hermite basis on the segment
+		const float h = pointX[segment + 1] - pointX[segment];
+		const float t = (x - pointX[segment]) / h;
+		const float t2 = t * t, t3 = t2 * t;
+		float y = (2 * t3 - 3 * t2 + 1) * pointY[segment] + (t3 - 2 * t2 + t) * h * tangent[segment] +
+			(-2 * t3 + 3 * t2) * pointY[segment + 1] + (t3 - t2) * h * tangent[segment + 1];
+		// The spline can't overshoot, but the float rounding can, by a hair: enough to make a
+		// flat stretch (a dead zone) wobble or step backwards
+		const float lo = fminf(pointY[segment], pointY[segment + 1]);
+		const float hi = fmaxf(pointY[segment], pointY[segment + 1]);
+		lut[i] = y < lo ? lo : (y > hi ? hi : y);
+	}
+}
+
+float ResponseCurve::Apply(float angle) const
+{
+	if (numPoints < 2)
+		return angle;
+
+	const float a = fabsf(angle);
+	float out;
+	if (a >= maxInput)
+		out = lut[RESPONSE_CURVE_LUT_SIZE];
+	else {
+		const float f = a * inputToIndex;
+		const int i = (int)f;
+		out = lut[i] + (f - i) * (lut[i + 1] - lut[i]);
+	}
+	return angle < 0.0f ? -out : out;
+}
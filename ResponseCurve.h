@@ -0,0 +1,35 @@
+#pragma once
+
+constexpr int RESPONSE_CURVE_MAX_POINTS = 16;
+constexpr int RESPONSE_CURVE_LUT_SIZE = 256;
+
+/*
+ * Response curve for one rotation axis, OpenTrack style: a handful of (input, output) points
+ * in degrees, joined by a monotone cubic spline and mirrored for negative angles. Inputs past
+ * the last point get the last output.
+ *
+ * The spline is only evaluated when the curve is parsed; after that, Apply() is a lookup in
+ * a fixed-size table and a lerp.
+ */
+class ResponseCurve
+{
+public:
+	ResponseCurve();
+
+	void Clear();
+	// Parses "x0:y0,x1:y1,..." with increasing, non-negative x. A (0, 0) point is added if the
+	// curve doesn't start at 0. Returns false (and clears the curve) if the spec is invalid.
+	bool Parse(const char* spec);
+	bool IsEnabled() const { return numPoints >= 2; }
+
+	float Apply(float angle) const;
+
+private:
+	void Bake();
+
+	float pointX[RESPONSE_CURVE_MAX_POINTS], pointY[RESPONSE_CURVE_MAX_POINTS];
+	int numPoints;
+	float maxInput, inputToIndex;
+	// One extra entry so the lerp never reads past the end
+	float lut[RESPONSE_CURVE_LUT_SIZE + 1];
+};
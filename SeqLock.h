@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ * Single-writer, multiple-reader sequence lock.
+ *
+ * The writer bumps the sequence to an odd number, copies the payload and then bumps it
+ * again to an even number. Readers copy the payload optimistically and retry if the
+ * sequence changed (or was odd) while they were copying. The writer never waits for the
+ * readers and the readers never wait for the writer: if a reader can't get a clean copy
+ * after a few attempts it just gives up and keeps whatever it had before.
+ *
+ * T must be trivially copyable.
+ */
+template<class T>
+class SeqLock
+{
+public:
+	SeqLock();
+
+	void Write(const T& value);
+	bool Read(T* value) const;
+	// Returns the number of completed writes. Useful to detect new data without copying it.
+	unsigned int GetWriteCount() const;
+
+private:
+	static const int MAX_READ_ATTEMPTS = 16;
+	std::atomic<unsigned int> sequence;
+	T data;
+};
+
+template<class T>
+SeqLock<T>::SeqLock()
+{
+	sequence.store(0, std::memory_order_relaxed);
+	data = T();
+}
+
+template<class T>
+void SeqLock<T>::Write(const T& value)
+{
+	unsigned int seq = sequence.load(std::memory_order_relaxed);
+	sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	data = value;
+	sequence.store(seq + 2, std::memory_order_release);
+}
+
+template<class T>
+bool SeqLock<T>::Read(T* value) const
+{
+	for (int i = 0; i < MAX_READ_ATTEMPTS; i++)
+	{
+		unsigned int seq0 = sequence.load(std::memory_order_acquire);
+		// Nothing has been published yet
+		if (seq0 == 0)
+			return false;
+		// A write is in progress, try again
+		if (seq0 & 1)
+			continue;
+
+		T copy = data;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		unsigned int seq1 = sequence.load(std::memory_order_relaxed);
+		if (seq0 == seq1)
+		{
+			*value = copy;
+			return true;
+		}
+	}
+	return false;
+}
+
+template<class T>
+unsigned int SeqLock<T>::GetWriteCount() const
+{
+	return sequence.load(std::memory_order_acquire) >> 1;
+}
@@ -1,3 +1,4 @@
+#include <math.h>
 #include "SharedMem.h"
 
 void log_debug(const char *format, ...);
@@ -16,15 +17,95 @@ void InitSharedMem() {
 	g_SharedMem.SetDataReady();
 
 	g_pSharedDataTelemetry = (SharedMemDataTelemetry*)g_SharedMemTelemetry.GetMemoryPointer();
-	if (g_pSharedDataTelemetry == nullptr) {
+	if (g_pSharedDataTelemetry == nullptr)
 		log_debug("[TLM] Could not get pointer to shared Telemetry data");
+
+	g_pSharedPoseHistory = (SharedMemDataPoseHistory*)g_SharedMemPoseHistory.GetMemoryPointer();
+	if (g_pSharedPoseHistory == nullptr) {
+		log_debug("Could not get pointer to the shared pose history");
+		return;
+	}
+	// The mapping starts zeroed: the header is all the setup it needs
+	g_pSharedPoseHistory->qpcFrequency = GetQPCFrequency();
+	g_pSharedPoseHistory->length = POSE_HISTORY_LENGTH;
+	g_pSharedPoseHistory->version = POSE_HISTORY_VERSION;
+	g_SharedMemPoseHistory.SetDataReady();
+}
+
+void PublishHeadPose(const SharedHeadPose& pose)
+{
+	static LONGLONG lastTimestamp = 0;
+	if (g_pSharedPoseHistory == nullptr)
 		return;
+	// SamplePoseHistory() needs the entries in strictly increasing time order
+	SharedHeadPose entry = pose;
+	if (entry.timestamp <= lastTimestamp)
+		entry.timestamp = lastTimestamp + 1;
+	lastTimestamp = entry.timestamp;
+	const unsigned int count = g_pSharedPoseHistory->count.load(std::memory_order_relaxed);
+	g_pSharedPoseHistory->poses[count % POSE_HISTORY_LENGTH].Write(entry);
+	g_pSharedPoseHistory->count.store(count + 1, std::memory_order_release);
+}
+
+static inline float LerpAngle(float a, float b, float u) {
+	float d = b - a;
+	while (d >= 180.0f) d -= 360.0f;
+	while (d < -180.0f) d += 360.0f;
+	return a + u * d;
+}
+
+bool SamplePoseHistory(const SharedMemDataPoseHistory* history, LONGLONG t, SharedHeadPose* out)
+{
+	const unsigned int count = history->count.load(std::memory_order_acquire);
+	if (count == 0)
+		return false;
+
+	// Walk back from the newest pose. Entries that are being overwritten can't be read, and
+	// that's where the search stops.
+	const unsigned int oldest = count > POSE_HISTORY_LENGTH ? count - POSE_HISTORY_LENGTH : 0;
+	SharedHeadPose next, prev;
+	if (!history->poses[(count - 1) % POSE_HISTORY_LENGTH].Read(&next))
+		return false;
+	if (t >= next.timestamp) {
+		*out = next;
+		return true;
+	}
+	for (unsigned int i = count - 1; i > oldest; i--) {
+		if (!history->poses[(i - 1) % POSE_HISTORY_LENGTH].Read(&prev) || prev.timestamp >= next.timestamp)
+			return false;
+		if (t >= prev.timestamp) {
+			const float u = (float)(t - prev.timestamp) / (float)(next.timestamp - prev.timestamp);
+			*out = u < 0.5f ? prev : next;
+			out->timestamp = t;
+			out->Yaw   = LerpAngle(prev.Yaw,   next.Yaw,   u);
+			out->Pitch = LerpAngle(prev.Pitch, next.Pitch, u);
+			out->Roll  = LerpAngle(prev.Roll,  next.Roll,  u);
+			out->X = prev.X + u * (next.X - prev.X);
+			out->Y = prev.Y + u * (next.Y - prev.Y);
+			out->Z = prev.Z + u * (next.Z - prev.Z);
+			// Normalized lerp, taking the short way around
+			const float dot = prev.qx * next.qx + prev.qy * next.qy + prev.qz * next.qz + prev.qw * next.qw;
+			const float s = dot < 0.0f ? -1.0f : 1.0f;
+			float qx = prev.qx + u * (s * next.qx - prev.qx);
+			float qy = prev.qy + u * (s * next.qy - prev.qy);
+			float qz = prev.qz + u * (s * next.qz - prev.qz);
+			float qw = prev.qw + u * (s * next.qw - prev.qw);
+			const float len = sqrtf(qx * qx + qy * qy + qz * qz + qw * qw);
+			if (len > 0.0f) {
+				out->qx = qx / len; out->qy = qy / len; out->qz = qz / len; out->qw = qw / len;
+			}
+			return true;
+		}
+		next = prev;
 	}
+	return false;
 }
 
 SharedMemDataCockpitLook* g_SharedData = nullptr;
 SharedMemDataTelemetry* g_pSharedDataTelemetry = nullptr;
+SharedMemDataPoseHistory* g_pSharedPoseHistory = nullptr;
 
 // Create the shared memory as a global variable
 SharedMem<SharedMemDataCockpitLook> g_SharedMem(SHARED_MEM_NAME_COCKPITLOOK, true, true);
 SharedMem<SharedMemDataTelemetry> g_SharedMemTelemetry(SHARED_MEM_NAME_TELEMETRY, true, true);
+SharedMem<SharedMemDataPoseHistory> g_SharedMemPoseHistory(SHARED_MEM_NAME_POSE_HISTORY, true, true);
@@ -1,7 +1,11 @@
 #pragma once
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include "SharedMemTemplate.h"
+#include "SeqLock.h"
+#include "TrackerSampler.h"
 
 struct SharedMemDataCockpitLook {
 	// Offset added to the current POV when VR is active. This is controlled by ddraw
@@ -18,6 +22,12 @@ struct SharedMemDataCockpitLook {
 	int bIsReticleSetup;
 	// XWA units to meters conversion factor. Set by CockpitLook. Used to apply POVOffset
 	float povFactor;
+	// Frame bookkeeping of UpdateTrackingData(), see FrameClock. Written by CockpitLook:
+	// the current frame, how many times UpdateTrackingData() was called in it so far, and how
+	// many frames had more than one call since the game started.
+	unsigned int frameId;
+	unsigned int trackingCallsThisFrame;
+	unsigned int repeatedFrames;
 
 	SharedMemDataCockpitLook() {
 		this->POVOffsetX = 0.0f;
@@ -31,9 +41,55 @@ struct SharedMemDataCockpitLook {
 		this->Z = 0.0f;
 		this->bIsReticleSetup = 0;
 		this->povFactor = 25.0f;
+		this->frameId = 0;
+		this->trackingCallsThisFrame = 0;
+		this->repeatedFrames = 0;
 	}
 };
 
+/*
+ * One entry of the head pose history. Yaw/Pitch/Roll and X/Y/Z use the same units as
+ * SharedMemDataCockpitLook; the quaternion is the rotation injected into the camera.
+ */
+struct SharedHeadPose {
+	// QueryPerformanceCounter() ticks when the pose was published. Strictly increasing from one
+	// entry to the next, even when the tracker didn't deliver a new sample for this frame.
+	LONGLONG timestamp;
+	// QueryPerformanceCounter() ticks when the tracker sample behind the pose was taken. Repeats
+	// while the device hasn't produced anything new; inertia and lean may still change the pose.
+	LONGLONG sampleTimestamp;
+	// Frame that produced the pose (see FrameClock), increases by one every rendered frame
+	unsigned int frameId;
+	// Tracker that produced the pose (see TrackerType in cockpitlook.cpp)
+	int source;
+	float Yaw, Pitch, Roll;
+	float X, Y, Z;
+	float qx, qy, qz, qw;
+};
+
+/*
+ * The last POSE_HISTORY_LENGTH head poses, with their timestamps. The renderer can use it to
+ * find out how old a pose is, or to interpolate the pose at the time it actually needs.
+ * Every entry has its own sequence lock, so readers never block CockpitLook and vice versa.
+ */
+constexpr int POSE_HISTORY_VERSION = 2;
+constexpr int POSE_HISTORY_LENGTH  = 64;
+struct SharedMemDataPoseHistory {
+	int version;
+	int length;
+	// Ticks per second of the timestamps
+	LONGLONG qpcFrequency;
+	// Number of poses written so far. The newest one is at (count - 1) % length.
+	std::atomic<unsigned int> count;
+	SeqLock<SharedHeadPose> poses[POSE_HISTORY_LENGTH];
+};
+
+// Adds a pose to the history. Only CockpitLook writes to it.
+void PublishHeadPose(const SharedHeadPose& pose);
+// Interpolates the pose at time t from the two entries around it. Times past the newest pose
+// return the newest pose. Returns false if there's nothing in the history that old.
+bool SamplePoseHistory(const SharedMemDataPoseHistory* history, LONGLONG t, SharedHeadPose* out);
+
 constexpr int TLM_MAX_NAME      = 120;
 constexpr int TLM_MAX_CARGO     =  80;
 constexpr int TLM_MAX_SUBCMP    =  80;
@@ -83,9 +139,13 @@ void InitSharedMem();
 
 constexpr auto SHARED_MEM_NAME_COCKPITLOOK = L"Local\\CockpitLookHook";
 constexpr auto SHARED_MEM_NAME_TELEMETRY   = L"Local\\XWATelemetry";
+constexpr auto SHARED_MEM_NAME_POSE_HISTORY = L"Local\\CockpitLookPoseHistory";
 
 extern SharedMem<SharedMemDataCockpitLook> g_SharedMem;
 extern SharedMemDataCockpitLook* g_SharedData;
 
 extern SharedMem<SharedMemDataTelemetry> g_SharedMemTelemetry;
-extern SharedMemDataTelemetry* g_pSharedDataTelemetry;
\ No newline at end of file
+extern SharedMemDataTelemetry* g_pSharedDataTelemetry;
+
+extern SharedMem<SharedMemDataPoseHistory> g_SharedMemPoseHistory;
+extern SharedMemDataPoseHistory* g_pSharedPoseHistory;
\ No newline at end of file
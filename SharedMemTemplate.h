@@ -1,7 +1,22 @@
 #pragma once
 
 #include <string>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+typedef const wchar_t* LPCWSTR;
+#endif
 
+/*
+ * Named shared memory holding one T, plus a semaphore that tells readers the data is ready.
+ * On Windows it's a file mapping backed by the paging file; elsewhere it's POSIX shared
+ * memory, so the shared structures can be exercised by the tests. The POSIX objects are
+ * named after the last component of the Windows name ("Local\\Foo" -> "/Foo"), and are
+ * removed by the instance that created them.
+ */
 template<class T>
 class SharedMem
 {
@@ -14,11 +29,19 @@ public:
 	void SetDataReady();
 
 private:
+#ifdef _WIN32
 	HANDLE hMapFile;
 	HANDLE hSemaphore;
+#else
+	std::string mapName, semaphoreName;
+	sem_t* pSemaphore;
+	bool bCreated;
+#endif
 	T* pSharedData;
 };
 
+#ifdef _WIN32
+
 template<class T>
 SharedMem<T>::SharedMem(LPCWSTR name, bool createIfNotExists, bool availableOnCreate)
 {
@@ -110,4 +133,83 @@ template<class T>
 void SharedMem<T>::SetDataReady()
 {
 	ReleaseSemaphore(hSemaphore, 1, NULL);
-}
\ No newline at end of file
+}
+#else
+template<class T>
+SharedMem<T>::SharedMem(LPCWSTR name, bool createIfNotExists, bool availableOnCreate)
+{
+	pSharedData = nullptr;
+	pSemaphore = SEM_FAILED;
+	bCreated = false;
+
+	std::wstring wideName = name;
+	const size_t slash = wideName.find_last_of(L'\\');
+	if (slash != std::wstring::npos)
+		wideName = wideName.substr(slash + 1);
+	mapName = "/" + std::string(wideName.begin(), wideName.end());
+	semaphoreName = mapName + "Semaphore";
+
+	int fd = -1;
+	if (createIfNotExists) {
+		fd = shm_open(mapName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		bCreated = fd != -1;
+		// New objects are zero-filled, like a new file mapping
+		if (bCreated && ftruncate(fd, sizeof(T)) != 0) {
+			close(fd);
+			fd = -1;
+		}
+	}
+	if (fd == -1 && !bCreated)
+		fd = shm_open(mapName.c_str(), O_RDWR, 0600);
+	if (fd == -1)
+		return;
+
+	void* p = mmap(NULL, sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return;
+	pSharedData = (T*)p;
+
+	// Same as the Windows version: the semaphore always starts available
+	pSemaphore = sem_open(semaphoreName.c_str(), O_CREAT, 0600, 1);
+}
+
+template<class T>
+SharedMem<T>::~SharedMem()
+{
+	if (pSharedData != nullptr)
+		munmap(pSharedData, sizeof(T));
+	if (pSemaphore != SEM_FAILED)
+		sem_close(pSemaphore);
+	if (bCreated) {
+		shm_unlink(mapName.c_str());
+		sem_unlink(semaphoreName.c_str());
+	}
+}
+
+template<class T>
+T* SharedMem<T>::GetMemoryPointer()
+{
+	return pSharedData;
+}
+
+template<class T>
+bool SharedMem<T>::IsDataReady()
+{
+	if (pSemaphore == SEM_FAILED || sem_trywait(pSemaphore) != 0)
+		return false;
+	sem_post(pSemaphore);
+	return true;
+}
+
+template<class T>
+void SharedMem<T>::SetDataReady()
+{
+	if (pSemaphore == SEM_FAILED)
+		return;
+	// The Windows semaphore has a maximum count of 1
+	int value = 0;
+	if (sem_getvalue(pSemaphore, &value) == 0 && value < 1)
+		sem_post(pSemaphore);
+}
+#endif
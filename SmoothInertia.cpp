@@ -0,0 +1,80 @@
+#include <float.h>
+#include <math.h>
+#include "SmoothInertia.h"
+
+// The curve reaches maxInertia at this multiple of it, and stays there
+constexpr float SMOOTH_INERTIA_SATURATION = 0.5f / 0.45f;
+
+static inline float clamp(float x, const float lowerlimit, const float upperlimit) {
+	if (x < lowerlimit) x = lowerlimit; else if (x > upperlimit) x = upperlimit;
+	return x;
+}
+
+static inline float smoothstep(const float min, const float max, float x) {
+	// Scale, bias and saturate x to 0..1 range
+	x = clamp((x - min) / (max - min), 0.0f, 1.0f);
+	// Evaluate polynomial
+	return x * x * (3.0f - 2.0f * x);
+}
+
+SmoothInertiaCurve::SmoothInertiaCurve()
+{
+	for (int i = 0; i <= SMOOTH_INERTIA_TABLE_SIZE; i++)
+		table[i] = 0.0f;
+	tableScale = 0.0f;
+	maxInertia = 0.0f;
+	bBaked = false;
+}
+
+/*
+ * The length L of the inertia vector is normalized to x = L / maxInertia and mapped to
+ * maxInertia * curve(x), where curve(x) takes the middle point of the smoothstep graph
+ * to the right so that it starts linear and then tapers off towards 1. Formally, x should be
+ * multiplied by 0.5, but using 0.45 makes a nicer curve. See the following link to visualize
+ * the curve we're using:
+ * https://www.iquilezles.org/apps/graphtoy/?f1(x)=2.0%20*%20clamp(smoothstep(0,%201,%20x%20*%200.45%20+%200.5)%20-%200.5,%200.0,%201.0)
+ * The gain is curve(x) / x, which tends to 2 * 1.5 * 0.45 at the origin instead of dividing by 0.
+ */
+void SmoothInertiaCurve::SetMaxInertia(float maxInertia)
+{
+	if (bBaked && maxInertia == this->maxInertia)
+		return;
+	this->maxInertia = maxInertia;
+	bBaked = true;
+	if (maxInertia <= 0.0f) {
+		// No room for any inertia
+		for (int i = 0; i <= SMOOTH_INERTIA_TABLE_SIZE; i++)
+			table[i] = 0.0f;
+		tableScale = 0.0f;
+		return;
+	}
+
+	const float maxX2 = SMOOTH_INERTIA_SATURATION * SMOOTH_INERTIA_SATURATION;
+	table[0] = 2.0f * 1.5f * 0.45f;
+	for (int i = 1; i <= SMOOTH_INERTIA_TABLE_SIZE; i++) {
+		const float x = sqrtf(maxX2 * i / SMOOTH_INERTIA_TABLE_SIZE);
+		table[i] = 2.0f * clamp(smoothstep(0.0f, 1.0f, x * 0.45f + 0.5f) - 0.5f, 0.0f, 1.0f) / x;
+	}
+	tableScale = SMOOTH_INERTIA_TABLE_SIZE / (maxX2 * maxInertia * maxInertia);
+}
+
+void SmoothInertiaCurve::Apply(float *inout_yawInertia, float *inout_pitchInertia, int count) const
+{
+	const float scale = tableScale;
+	for (int i = 0; i < count; i++) {
+		const float yawInertia = inout_yawInertia[i];
+		const float pitchInertia = inout_pitchInertia[i];
+		const float L2 = yawInertia * yawInertia + pitchInertia * pitchInertia;
+		// Both gains are computed and one is selected, so there's nothing to mispredict
+		const float f = L2 * scale;
+		const float fc = f < SMOOTH_INERTIA_TABLE_SIZE ? f : (float)SMOOTH_INERTIA_TABLE_SIZE;
+		const int j = (int)fc < SMOOTH_INERTIA_TABLE_SIZE ? (int)fc : SMOOTH_INERTIA_TABLE_SIZE - 1;
+		const float t = fc - j;
+		const float tableGain = table[j] + t * (table[j + 1] - table[j]);
+		// Saturated: the output length is maxInertia. Clamping L2 keeps a zero vector finite.
+		const float satGain = maxInertia / sqrtf(L2 > FLT_MIN ? L2 : FLT_MIN);
+		const float gain = f < SMOOTH_INERTIA_TABLE_SIZE ? tableGain : satGain;
+		inout_yawInertia[i] = yawInertia * gain;
+		inout_pitchInertia[i] = pitchInertia * gain;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+constexpr int SMOOTH_INERTIA_TABLE_SIZE = 256;
+
+/*
+ * The curve of the external view inertia. It takes [yaw,pitch] "linear" inertia vectors and
+ * makes a smooth transition between 0 at the origin and maxInertia near the edges.
+ *
+ * It's a radial curve: it only changes the length of the inertia vector. The curve is baked
+ * into a table of the gain (output length / input length) indexed by the squared input
+ * length, so looking it up needs no square root and no normalization.
+ */
+class SmoothInertiaCurve
+{
+public:
+	SmoothInertiaCurve();
+
+	// Bakes the table for maxInertia, unless it was already baked for it. <= 0 leaves no room
+	// for any inertia.
+	void SetMaxInertia(float maxInertia);
+	float GetMaxInertia() const { return maxInertia; }
+
+	// Applies the curve to count vectors in place. A zero vector stays zero.
+	void Apply(float *inout_yawInertia, float *inout_pitchInertia, int count) const;
+
+private:
+	float table[SMOOTH_INERTIA_TABLE_SIZE + 1];
+	// Table entries per unit of squared length
+	float tableScale;
+	// The maxInertia the table was baked for
+	float maxInertia;
+	bool bBaked;
+};
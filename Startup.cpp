@@ -0,0 +1,115 @@
+#include <windows.h>
+#include <atomic>
+#include "Startup.h"
+#include "TrackerSampler.h"
+
+void log_debug(const char *format, ...);
+
+static const StartupTask* g_StartupTasks = NULL;
+static int g_iStartupTaskCount = 0;
+static std::atomic<int> g_StartupTaskStates[MAX_STARTUP_TASKS];
+static LONGLONG g_StartupBegin = 0;
+// Signaled every time a task finishes
+static HANDLE g_hStartupEvent = NULL;
+
+static inline double MillisecondsSinceStartup(LONGLONG t)
+{
+	return 1000.0 * QPCToSeconds(t - g_StartupBegin);
+}
+
+static DWORD WINAPI StartupTaskThreadFun(LPVOID lpParam)
+{
+	const int index = (int)(INT_PTR)lpParam;
+	const StartupTask& task = g_StartupTasks[index];
+	const LONGLONG start = GetQPCTime();
+	const bool bReady = task.fun();
+	const LONGLONG end = GetQPCTime();
+
+	g_StartupTaskStates[index] = bReady ? STARTUP_TASK_READY : STARTUP_TASK_FAILED;
+	log_debug("[Startup] %s %s in %0.1fms (started at +%0.1fms)", task.name, bReady ? "ready" : "FAILED",
+		1000.0 * QPCToSeconds(end - start), MillisecondsSinceStartup(start));
+	SetEvent(g_hStartupEvent);
+	return 0;
+}
+
+static DWORD WINAPI StartupThreadFun(LPVOID lpParam)
+{
+	for (;;) {
+		bool bDone = true;
+		for (int i = 0; i < g_iStartupTaskCount; i++) {
+			if (g_StartupTaskStates[i] == STARTUP_TASK_RUNNING)
+				bDone = false;
+			if (g_StartupTaskStates[i] != STARTUP_TASK_PENDING)
+				continue;
+
+			bool bBlocked = false, bWaiting = false;
+			for (int j = 0; j < g_iStartupTaskCount; j++) {
+				if ((g_StartupTasks[i].dependencies & (1u << j)) == 0)
+					continue;
+				const int state = g_StartupTaskStates[j];
+				if (state == STARTUP_TASK_FAILED || state == STARTUP_TASK_SKIPPED)
+					bBlocked = true;
+				else if (state != STARTUP_TASK_READY)
+					bWaiting = true;
+			}
+
+			if (bBlocked) {
+				g_StartupTaskStates[i] = STARTUP_TASK_SKIPPED;
+				log_debug("[Startup] %s skipped, a task it depends on failed", g_StartupTasks[i].name);
+				// Tasks that depend on this one get another look
+				i = -1;
+				continue;
+			}
+			bDone = false;
+			if (bWaiting)
+				continue;
+
+			g_StartupTaskStates[i] = STARTUP_TASK_RUNNING;
+			HANDLE hThread = CreateThread(NULL, 0, StartupTaskThreadFun, (LPVOID)(INT_PTR)i, 0, NULL);
+			if (hThread != NULL)
+				CloseHandle(hThread);
+			else
+				StartupTaskThreadFun((LPVOID)(INT_PTR)i);
+		}
+		if (bDone)
+			break;
+		WaitForSingleObject(g_hStartupEvent, INFINITE);
+	}
+
+	log_debug("[Startup] All tasks done %0.1fms after attach", MillisecondsSinceStartup(GetQPCTime()));
+	CloseHandle(g_hStartupEvent);
+	g_hStartupEvent = NULL;
+	return 0;
+}
+
+bool RunStartupTasks(const StartupTask* tasks, int count)
+{
+	g_StartupBegin = GetQPCTime();
+	g_StartupTasks = tasks;
+	g_iStartupTaskCount = count < MAX_STARTUP_TASKS ? count : MAX_STARTUP_TASKS;
+	for (int i = 0; i < g_iStartupTaskCount; i++)
+		g_StartupTaskStates[i] = STARTUP_TASK_PENDING;
+
+	g_hStartupEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	HANDLE hThread = g_hStartupEvent != NULL ? CreateThread(NULL, 0, StartupThreadFun, NULL, 0, NULL) : NULL;
+	if (hThread == NULL) {
+		// Better late than never: run the tasks right here, one after the other
+		log_debug("[Startup] Could not create the startup thread, running the tasks in DllMain");
+		StartupThreadFun(NULL);
+		return false;
+	}
+	CloseHandle(hThread);
+	return true;
+}
+
+StartupTaskState GetStartupTaskState(int task)
+{
+	if (task < 0 || task >= g_iStartupTaskCount)
+		return STARTUP_TASK_SKIPPED;
+	return (StartupTaskState)g_StartupTaskStates[task].load();
+}
+
+bool IsStartupTaskReady(int task)
+{
+	return GetStartupTaskState(task) == STARTUP_TASK_READY;
+}
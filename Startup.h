@@ -0,0 +1,35 @@
+#pragma once
+
+/*
+ * Deferred startup.
+ *
+ * DllMain runs under the loader lock, so anything slow done there (file I/O, Winsock, a TCP
+ * connection that times out) holds up the whole game launch. Instead, DllMain hands a table
+ * of tasks to RunStartupTasks(); a coordinator thread starts each task on its own thread as
+ * soon as the tasks it depends on are ready, so independent subsystems come up in parallel.
+ * Each task reports whether it succeeded, and tasks that depend on a failed one are skipped.
+ * The time taken by every task is logged.
+ */
+typedef bool (*StartupTaskFun)();
+
+struct StartupTask {
+	const char* name;
+	StartupTaskFun fun;
+	// Bit mask of the tasks (by index) that must be ready before this one starts
+	unsigned int dependencies;
+};
+
+enum StartupTaskState {
+	STARTUP_TASK_PENDING,
+	STARTUP_TASK_RUNNING,
+	STARTUP_TASK_READY,
+	STARTUP_TASK_FAILED,
+	STARTUP_TASK_SKIPPED,
+};
+
+constexpr int MAX_STARTUP_TASKS = 16;
+
+// The table must outlive the startup (a static array, typically)
+bool RunStartupTasks(const StartupTask* tasks, int count);
+StartupTaskState GetStartupTaskState(int task);
+bool IsStartupTaskReady(int task);
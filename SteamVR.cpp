@@ -8,6 +8,8 @@
 constexpr float DEFAULT_PREDICTED_SECONDS_TO_PHOTONS = 0.0f;
 float g_fPredictedSecondsToPhotons = DEFAULT_PREDICTED_SECONDS_TO_PHOTONS;
 float g_fVsyncToPhotons, g_fHMDDisplayFreq = 0;
+// Use GetDeviceToAbsoluteTrackingPose() instead of WaitGetPoses() in the camera hook
+bool g_bSteamVRNonBlockingPose = false;
 
 void log_debug(const char *format, ...);
 bool g_bSteamVRInitialized = false;
@@ -46,6 +48,50 @@ void ShutdownSteamVR() {
 	log_debug("SteamVR shut down");
 }
 
+/*
+ * SteamVRPoseRuntime backed by the actual OpenVR runtime
+ */
+class OpenVRPoseRuntime : public SteamVRPoseRuntime
+{
+public:
+	bool IsHMDConnected() {
+		return g_pHMD != NULL && g_pHMD->IsTrackedDeviceConnected(vr::k_unTrackedDeviceIndex_Hmd);
+	}
+
+	bool WaitGetHMDPose(vr::TrackedDevicePose_t* pose) {
+		vr::VRControllerState_t state;
+		if (!g_pHMD->GetControllerState(vr::k_unTrackedDeviceIndex_Hmd, &state, sizeof(state)))
+			return false;
+		vr::TrackedDevicePose_t trackedDevicePoseArray[vr::k_unMaxTrackedDeviceCount];
+		vr::VRCompositor()->WaitGetPoses(trackedDevicePoseArray, vr::k_unMaxTrackedDeviceCount, NULL, 0);
+		*pose = trackedDevicePoseArray[vr::k_unTrackedDeviceIndex_Hmd];
+		return true;
+	}
+
+	bool GetPredictedHMDPose(float secondsFromNow, vr::TrackedDevicePose_t* pose) {
+		// Only the HMD is needed, and it's always device 0. Use the compositor's tracking space
+		// so the poses match the ones from WaitGetPoses().
+		g_pHMD->GetDeviceToAbsoluteTrackingPose(vr::VRCompositor()->GetTrackingSpace(), secondsFromNow, pose, 1);
+		return true;
+	}
+
+	bool GetTimeSinceLastVsync(float* seconds) {
+		uint64_t frameCounter;
+		return g_pHMD->GetTimeSinceLastVsync(seconds, &frameCounter);
+	}
+
+	float GetDisplayFrequency() { return g_fHMDDisplayFreq; }
+	float GetVsyncToPhotons() { return g_fVsyncToPhotons; }
+};
+
+static OpenVRPoseRuntime g_OpenVRPoseRuntime;
+static SteamVRPoseRuntime* g_pSteamVRPoseRuntime = &g_OpenVRPoseRuntime;
+
+void SetSteamVRPoseRuntime(SteamVRPoseRuntime* runtime)
+{
+	g_pSteamVRPoseRuntime = runtime != NULL ? runtime : &g_OpenVRPoseRuntime;
+}
+
 void ResetZeroPose() {
 	if (g_pChaperone == NULL)
 		return;
@@ -137,6 +183,16 @@ void quatToEuler(vr::HmdQuaternionf_t q, float *yaw, float *roll, float *pitch)
 	*roll = atan2(2.0f * q.x*q.w - 2.0f * q.y*q.z, 1.0f - 2.0f * sqx - 2.0f * sqz);
 }
 
+void GetSteamVREulerAngles(const Quaternion& rotation, float* yaw, float* pitch, float* roll)
+{
+	vr::HmdQuaternionf_t q;
+	q.w = rotation.w;
+	q.x = rotation.x;
+	q.y = rotation.y;
+	q.z = rotation.z;
+	quatToEuler(q, yaw, pitch, roll);
+}
+
 /* DEPRECATED, WE APPLY ROTATION MATRIX DIRECTLY INSTEAD
 Formulas from https://www.geometrictools.com/Documentation/EulerAngles.pdf
 
@@ -275,44 +331,38 @@ void rotMatrixToEuler(vr::HmdMatrix34_t pose, float* yaw, float* pitch, float* r
 	*roll = -thetaZ;
 }
 
-bool GetSteamVRPositionalData(float *yaw, float *pitch, float *roll, float *x, float *y, float *z, Matrix3* rotMatrix)
+bool GetSteamVRPositionalData(float *yaw, float *pitch, float *roll, float *x, float *y, float *z, Quaternion* rotation)
 {
-	if (g_pHMD == NULL) {
-		log_debug("GetSteamVRPositional Data with g_pHMD = NULL");
-		// Try to initialize once more
-		if (!g_bSteamVRInitialized) {
-			log_debug("Attempting SteamVR initialization again...");
-			InitSteamVR();
-			g_bSteamVRInitialized = true; // Don't try initializing again if this fails
-		}
-		if (g_pHMD == NULL)
-			return false;
-		log_debug("SteamVR initialized in the second attempt, continuing");
-	}
+	// A fake runtime doesn't need SteamVR to be loaded. The retries are up to the device
+	// manager, this runs in the camera hook.
+	if (g_pSteamVRPoseRuntime == &g_OpenVRPoseRuntime && g_pHMD == NULL)
+		return false;
 
-	vr::TrackedDeviceIndex_t unDevice = vr::k_unTrackedDeviceIndex_Hmd;
-	vr::Compositor_FrameTiming frametiming;
-	frametiming.m_nSize = sizeof(vr::Compositor_FrameTiming);
-	if (!g_pHMD->IsTrackedDeviceConnected(unDevice))
+	SteamVRPoseRuntime* runtime = g_pSteamVRPoseRuntime;
+	if (!runtime->IsHMDConnected())
 		return false;
 
-	vr::VRControllerState_t state;
-	if (g_pHMD->GetControllerState(unDevice, &state, sizeof(state)))
+	vr::TrackedDevicePose_t hmdPose;
+	// WaitGetPoses() blocks until the compositor is ready for a new frame, which can cap or
+	// jitter the game's frame rate when it's called from the camera hook. The non-blocking
+	// mode asks for a pose predicted to the time the next frame will be displayed instead.
+	const bool bPoseRead = g_bSteamVRNonBlockingPose ?
+		runtime->GetPredictedHMDPose(GetSteamVRPoseSecondsFromNow(runtime, g_fPredictedSecondsToPhotons), &hmdPose) :
+		runtime->WaitGetHMDPose(&hmdPose);
+
+	if (bPoseRead)
 	{
-		vr::TrackedDevicePose_t trackedDevicePoseArray[vr::k_unMaxTrackedDeviceCount];
 		vr::HmdMatrix34_t poseMatrix;
 		vr::HmdQuaternionf_t q;
 
-		vr::VRCompositor()->WaitGetPoses(trackedDevicePoseArray, vr::k_unMaxTrackedDeviceCount, NULL, 0);
-
-		if (trackedDevicePoseArray[vr::k_unTrackedDeviceIndex_Hmd].bPoseIsValid) {
+		if (hmdPose.bPoseIsValid) {
 		//if (g_hmdPose.bPoseIsValid) {
-			g_hmdPose = trackedDevicePoseArray[vr::k_unTrackedDeviceIndex_Hmd]; // This matrix contains all positional and rotational data.
+			g_hmdPose = hmdPose; // This matrix contains all positional and rotational data.
 			poseMatrix = g_hmdPose.mDeviceToAbsoluteTracking; // This matrix contains all positional and rotational data.
 			//rotMatrixToEuler(poseMatrix, yaw, pitch, roll);
-			*rotMatrix = HmdMatrix34toMatrix3(poseMatrix);
-
 			q = rotationToQuaternion(poseMatrix);
+			// The quaternion drives the camera; the Euler angles are only reported (shared mem, UDP)
+			*rotation = Quaternion(q.x, q.y, q.z, q.w);
 			quatToEuler(q, yaw, pitch, roll);
 			*x = poseMatrix.m[0][3];
 			*y = poseMatrix.m[1][3];
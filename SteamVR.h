@@ -2,11 +2,19 @@
 #include <headers/openvr.h>
 #include "cockpitlook.h"
 #include "Matrices.h"
+#include "Quaternion.h"
+#include "SteamVRPose.h"
 
 extern float g_fPredictedSecondsToPhotons;
+extern bool g_bSteamVRNonBlockingPose;
+
+// NULL puts the OpenVR runtime back
+void SetSteamVRPoseRuntime(SteamVRPoseRuntime* runtime);
 
 bool InitSteamVR();
 void ShutdownSteamVR();
 void ResetZeroPose();
 Matrix3 HmdMatrix34toMatrix3(const vr::HmdMatrix34_t& mat);
-bool GetSteamVRPositionalData(float* yaw, float* pitch, float* roll, float* x, float* y, float* z, Matrix3* poseMatrix);
+bool GetSteamVRPositionalData(float* yaw, float* pitch, float* roll, float* x, float* y, float* z, Quaternion* rotation);
+// The Euler angles GetSteamVRPositionalData() reports for a rotation (radians)
+void GetSteamVREulerAngles(const Quaternion& rotation, float* yaw, float* pitch, float* roll);
@@ -0,0 +1,16 @@
+#include "SteamVRPose.h"
+
+float GetSteamVRPoseSecondsFromNow(SteamVRPoseRuntime* runtime, float fallbackSeconds)
+{
+	// The next frame is scanned out at the next vsync and lit vsyncToPhotons after that
+	// (this is the formula from the OpenVR docs for GetDeviceToAbsoluteTrackingPose).
+	const float displayFreq = runtime->GetDisplayFrequency();
+	float sinceVsync;
+	if (displayFreq <= 0.0f || !runtime->GetTimeSinceLastVsync(&sinceVsync))
+		return fallbackSeconds;
+
+	const float frameDuration = 1.0f / displayFreq;
+	// If the hook runs late, don't predict into the frame after the next one
+	if (sinceVsync > frameDuration) sinceVsync = frameDuration;
+	return frameDuration - sinceVsync + runtime->GetVsyncToPhotons();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// openvr.h is only needed by the real runtime, in SteamVR.cpp
+namespace vr { struct TrackedDevicePose_t; }
+
+/*
+ * The parts of the OpenVR runtime used to get the HMD's pose. The real implementation talks
+ * to SteamVR; a fake one can be installed with SetSteamVRPoseRuntime() to exercise the pose
+ * scheduling without a headset.
+ */
+class SteamVRPoseRuntime
+{
+public:
+	virtual ~SteamVRPoseRuntime() {}
+	virtual bool IsHMDConnected() = 0;
+	// Waits for the compositor (vsync-blocking) and returns the HMD's pose
+	virtual bool WaitGetHMDPose(vr::TrackedDevicePose_t* pose) = 0;
+	// Returns the HMD's pose predicted secondsFromNow into the future. Never blocks.
+	virtual bool GetPredictedHMDPose(float secondsFromNow, vr::TrackedDevicePose_t* pose) = 0;
+	virtual bool GetTimeSinceLastVsync(float* seconds) = 0;
+	virtual float GetDisplayFrequency() = 0;
+	virtual float GetVsyncToPhotons() = 0;
+};
+
+/*
+ * How far ahead the non-blocking pose must be predicted so it matches the next frame's photons.
+ * fallbackSeconds is returned when the runtime doesn't know its display timing.
+ */
+float GetSteamVRPoseSecondsFromNow(SteamVRPoseRuntime* runtime, float fallbackSeconds);
@@ -179,6 +179,10 @@ void SendXWADataOverUDP()
 			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, absYaw, g_PlayerTelemetry.absYaw, "XWA.player", "abs_yaw");
 			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, absPitch, g_PlayerTelemetry.absPitch, "XWA.player", "abs_pitch");
 			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, absRoll, g_PlayerTelemetry.absRoll, "XWA.player", "abs_roll");
+			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, yawNoise, g_PlayerTelemetry.yawNoise, "XWA.player", "tracker_yaw_noise");
+			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, pitchNoise, g_PlayerTelemetry.pitchNoise, "XWA.player", "tracker_pitch_noise");
+			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, rollNoise, g_PlayerTelemetry.rollNoise, "XWA.player", "tracker_roll_noise");
+			SEND_TELEMETRY_VALUE_JSON(g_PrevPlayerTelemetry, posNoise, g_PlayerTelemetry.posNoise, "XWA.player", "tracker_pos_noise");
 		}
 		else // TELEMETRY_FORMAT_SIMPLIFIED
 		{
@@ -209,6 +213,10 @@ void SendXWADataOverUDP()
 			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, absYaw, g_PlayerTelemetry.absYaw, "XWA.player", "abs_yaw");
 			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, absPitch, g_PlayerTelemetry.absPitch, "XWA.player", "abs_pitch");
 			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, absRoll, g_PlayerTelemetry.absRoll, "XWA.player", "abs_roll");
+			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, yawNoise, g_PlayerTelemetry.yawNoise, "player", "tracker_yaw_noise");
+			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, pitchNoise, g_PlayerTelemetry.pitchNoise, "player", "tracker_pitch_noise");
+			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, rollNoise, g_PlayerTelemetry.rollNoise, "player", "tracker_roll_noise");
+			SEND_TELEMETRY_VALUE_SIMPLE(g_PrevPlayerTelemetry, posNoise, g_PlayerTelemetry.posNoise, "player", "tracker_pos_noise");
 		}
 
 		//log_debug("[UDP] Throttle: %d", CraftDefinitionTable[objectIndex].EngineThrottle);
@@ -247,6 +255,10 @@ void SendXWADataOverUDP()
 		g_PrevPlayerTelemetry.absYaw   = g_PlayerTelemetry.absYaw;
 		g_PrevPlayerTelemetry.absPitch = g_PlayerTelemetry.absPitch;
 		g_PrevPlayerTelemetry.absRoll  = g_PlayerTelemetry.absRoll;
+		g_PrevPlayerTelemetry.yawNoise   = g_PlayerTelemetry.yawNoise;
+		g_PrevPlayerTelemetry.pitchNoise = g_PlayerTelemetry.pitchNoise;
+		g_PrevPlayerTelemetry.rollNoise  = g_PlayerTelemetry.rollNoise;
+		g_PrevPlayerTelemetry.posNoise   = g_PlayerTelemetry.posNoise;
 
 		//Reset the telemetry ephemeral flags
 		g_PlayerTelemetry.laserFired = false;
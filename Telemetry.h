@@ -101,6 +101,12 @@ public:
 	TelemetryValue<float> absYaw{200};
 	TelemetryValue<float> absPitch{200};
 	TelemetryValue<float> absRoll{200};
+	// Head tracker noise measured by the pose filter (standard deviation). The angles are
+	// in degrees, the position is the noisiest axis in the tracker's own units.
+	TelemetryValue<float> yawNoise{200};
+	TelemetryValue<float> pitchNoise{200};
+	TelemetryValue<float> rollNoise{200};
+	TelemetryValue<float> posNoise{200};
 
 	PlayerTelemetry() {
 		craft_name = NULL;
@@ -127,6 +133,10 @@ public:
 		absYaw = 0;
 		absPitch = 0;
 		absRoll = 0;
+		yawNoise = 0;
+		pitchNoise = 0;
+		rollNoise = 0;
+		posNoise = 0;
 	}
 };
 
@@ -0,0 +1,342 @@
+#pragma once
+
+/*
+ * Threads, locks and events for the background workers (the tracker sampler and the device
+ * manager). On Windows these are the same Win32 objects the workers always used; elsewhere
+ * they're built on pthreads, so the workers can be driven by fake devices in the Linux tests.
+ */
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#endif
+
+// Timeout for the waits that must not give up
+constexpr unsigned int WAIT_FOREVER = 0xFFFFFFFF;
+
+typedef void (*ThreadFun)(void *param);
+
+/*
+ * A thread that can be joined with a timeout. A thread that doesn't exit in time keeps
+ * running, and the Thread can be joined again later.
+ */
+class Thread
+{
+public:
+	Thread() : started(false) {}
+
+	bool Start(ThreadFun fun, void *param);
+	// Returns true if the thread has exited (or was never started); the Thread is empty again
+	bool Join(unsigned int timeoutMs);
+	// Lets the thread run on its own; the Thread is empty again
+	void Detach();
+	bool IsStarted() const { return started; }
+	void RaisePriority();
+
+private:
+	struct StartParams {
+		ThreadFun fun;
+		void *param;
+	};
+#ifdef _WIN32
+	static DWORD WINAPI Entry(LPVOID lpParam);
+	HANDLE handle;
+#else
+	static void *Entry(void *param);
+	pthread_t handle;
+#endif
+	bool started;
+};
+
+class Mutex
+{
+public:
+	Mutex();
+	~Mutex();
+	void Lock();
+	void Unlock();
+
+private:
+	Mutex(const Mutex &) = delete;
+	Mutex &operator=(const Mutex &) = delete;
+#ifdef _WIN32
+	SRWLOCK lock;
+#else
+	pthread_mutex_t lock;
+#endif
+};
+
+// Reader/writer lock
+class RWLock
+{
+public:
+	RWLock();
+	~RWLock();
+	void LockExclusive();
+	void UnlockExclusive();
+	// Never blocks
+	bool TryLockShared();
+	void UnlockShared();
+
+private:
+	RWLock(const RWLock &) = delete;
+	RWLock &operator=(const RWLock &) = delete;
+#ifdef _WIN32
+	SRWLOCK lock;
+#else
+	pthread_rwlock_t lock;
+#endif
+};
+
+// Auto-reset event: Wait() consumes the signal
+class Event
+{
+public:
+	Event();
+	~Event() { Close(); }
+	bool Create();
+	void Close();
+	bool IsCreated() const;
+	void Set();
+	// Returns false on timeout
+	bool Wait(unsigned int timeoutMs);
+
+private:
+	Event(const Event &) = delete;
+	Event &operator=(const Event &) = delete;
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool created, signaled;
+#endif
+};
+
+void SleepMs(unsigned int ms);
+
+#ifdef _WIN32
+
+inline DWORD WINAPI Thread::Entry(LPVOID lpParam)
+{
+	const StartParams params = *(StartParams *)lpParam;
+	delete (StartParams *)lpParam;
+	params.fun(params.param);
+	return 0;
+}
+
+inline bool Thread::Start(ThreadFun fun, void *param)
+{
+	StartParams *params = new StartParams{ fun, param };
+	handle = CreateThread(NULL, 0, Entry, params, 0, NULL);
+	started = handle != NULL;
+	if (!started)
+		delete params;
+	return started;
+}
+
+inline bool Thread::Join(unsigned int timeoutMs)
+{
+	if (!started)
+		return true;
+	if (WaitForSingleObject(handle, timeoutMs == WAIT_FOREVER ? INFINITE : timeoutMs) != WAIT_OBJECT_0)
+		return false;
+	CloseHandle(handle);
+	started = false;
+	return true;
+}
+
+inline void Thread::Detach()
+{
+	if (started)
+		CloseHandle(handle);
+	started = false;
+}
+
+inline void Thread::RaisePriority()
+{
+	if (started)
+		SetThreadPriority(handle, THREAD_PRIORITY_ABOVE_NORMAL);
+}
+
+inline Mutex::Mutex() { InitializeSRWLock(&lock); }
+inline Mutex::~Mutex() {}
+inline void Mutex::Lock() { AcquireSRWLockExclusive(&lock); }
+inline void Mutex::Unlock() { ReleaseSRWLockExclusive(&lock); }
+
+inline RWLock::RWLock() { InitializeSRWLock(&lock); }
+inline RWLock::~RWLock() {}
+inline void RWLock::LockExclusive() { AcquireSRWLockExclusive(&lock); }
+inline void RWLock::UnlockExclusive() { ReleaseSRWLockExclusive(&lock); }
+inline bool RWLock::TryLockShared() { return TryAcquireSRWLockShared(&lock) != 0; }
+inline void RWLock::UnlockShared() { ReleaseSRWLockShared(&lock); }
+
+inline Event::Event() : handle(NULL) {}
+
+inline bool Event::Create()
+{
+	if (handle == NULL)
+		handle = CreateEvent(NULL, FALSE, FALSE, NULL);
+	return handle != NULL;
+}
+
+inline void Event::Close()
+{
+	if (handle != NULL)
+		CloseHandle(handle);
+	handle = NULL;
+}
+
+inline bool Event::IsCreated() const { return handle != NULL; }
+
+inline void Event::Set()
+{
+	if (handle != NULL)
+		SetEvent(handle);
+}
+
+inline bool Event::Wait(unsigned int timeoutMs)
+{
+	return WaitForSingleObject(handle, timeoutMs == WAIT_FOREVER ? INFINITE : timeoutMs) == WAIT_OBJECT_0;
+}
+
+inline void SleepMs(unsigned int ms) { Sleep(ms); }
+
+#else
+
+// Absolute time timeoutMs from now, for the timed pthread calls
+inline timespec DeadlineFromNow(clockid_t clock, unsigned int timeoutMs)
+{
+	timespec t;
+	clock_gettime(clock, &t);
+	t.tv_sec += timeoutMs / 1000;
+	t.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+	if (t.tv_nsec >= 1000000000L) {
+		t.tv_sec++;
+		t.tv_nsec -= 1000000000L;
+	}
+	return t;
+}
+
+inline void *Thread::Entry(void *param)
+{
+	const StartParams params = *(StartParams *)param;
+	delete (StartParams *)param;
+	params.fun(params.param);
+	return NULL;
+}
+
+inline bool Thread::Start(ThreadFun fun, void *param)
+{
+	StartParams *params = new StartParams{ fun, param };
+	started = pthread_create(&handle, NULL, Entry, params) == 0;
+	if (!started)
+		delete params;
+	return started;
+}
+
+inline bool Thread::Join(unsigned int timeoutMs)
+{
+	if (!started)
+		return true;
+	int result;
+	if (timeoutMs == WAIT_FOREVER)
+		result = pthread_join(handle, NULL);
+	else {
+		const timespec deadline = DeadlineFromNow(CLOCK_REALTIME, timeoutMs);
+		result = pthread_timedjoin_np(handle, NULL, &deadline);
+	}
+	if (result != 0)
+		return false;
+	started = false;
+	return true;
+}
+
+inline void Thread::Detach()
+{
+	if (started)
+		pthread_detach(handle);
+	started = false;
+}
+
+// The tests don't need it, and raising the priority needs privileges on Linux
+inline void Thread::RaisePriority() {}
+
+inline Mutex::Mutex() { pthread_mutex_init(&lock, NULL); }
+inline Mutex::~Mutex() { pthread_mutex_destroy(&lock); }
+inline void Mutex::Lock() { pthread_mutex_lock(&lock); }
+inline void Mutex::Unlock() { pthread_mutex_unlock(&lock); }
+
+inline RWLock::RWLock() { pthread_rwlock_init(&lock, NULL); }
+inline RWLock::~RWLock() { pthread_rwlock_destroy(&lock); }
+inline void RWLock::LockExclusive() { pthread_rwlock_wrlock(&lock); }
+inline void RWLock::UnlockExclusive() { pthread_rwlock_unlock(&lock); }
+inline bool RWLock::TryLockShared() { return pthread_rwlock_tryrdlock(&lock) == 0; }
+inline void RWLock::UnlockShared() { pthread_rwlock_unlock(&lock); }
+
+inline Event::Event() : created(false), signaled(false) {}
+
+inline bool Event::Create()
+{
+	if (created)
+		return true;
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, &attr);
+	pthread_condattr_destroy(&attr);
+	created = true;
+	signaled = false;
+	return true;
+}
+
+inline void Event::Close()
+{
+	if (!created)
+		return;
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+	created = false;
+}
+
+inline bool Event::IsCreated() const { return created; }
+
+inline void Event::Set()
+{
+	if (!created)
+		return;
+	pthread_mutex_lock(&mutex);
+	signaled = true;
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+inline bool Event::Wait(unsigned int timeoutMs)
+{
+	const timespec deadline = DeadlineFromNow(CLOCK_MONOTONIC, timeoutMs == WAIT_FOREVER ? 0 : timeoutMs);
+	pthread_mutex_lock(&mutex);
+	int result = 0;
+	while (!signaled && result != ETIMEDOUT) {
+		if (timeoutMs == WAIT_FOREVER)
+			pthread_cond_wait(&cond, &mutex);
+		else
+			result = pthread_cond_timedwait(&cond, &mutex, &deadline);
+	}
+	const bool bSignaled = signaled;
+	signaled = false;
+	pthread_mutex_unlock(&mutex);
+	return bSignaled;
+}
+
+inline void SleepMs(unsigned int ms)
+{
+	timespec t;
+	t.tv_sec = ms / 1000;
+	t.tv_nsec = (long)(ms % 1000) * 1000000L;
+	nanosleep(&t, NULL);
+}
+
+#endif
@@ -77,6 +77,9 @@ short g_FreePIEProfileID = 13302; // Borrowing FreePIE's ID since I don't think
 TRACKIRDATA data;
 extern bool g_bGlobalDebug;
 
+// Minimum time between two identical read errors in the log, in milliseconds
+constexpr DWORD TRACKIR_ERROR_LOG_INTERVAL = 5000;
+
 bool InitTrackIR() {
 	LONG lRes = ERROR_SUCCESS;
 	char regvalue[1024], npclientPath[1024];
@@ -219,13 +222,42 @@ void ShutdownTrackIR()
 	FreeLibrary(hTrackIR);
 }
 
-bool ReadTrackIRData(float *yaw, float *pitch, float *x, float *y, float *z) {
+/*
+ * Reads fail on every frame while TrackIR is paused or disconnected. Only log when the error
+ * changes, or every few seconds otherwise, so the log isn't written to on every frame.
+ */
+static void LogTrackIRReadError(int error, WORD status)
+{
+	static int lastError = NP_OK;
+	static WORD lastStatus = 0;
+	static DWORD lastLogTime = 0;
+	static unsigned int suppressed = 0;
+
+	const DWORD now = GetTickCount();
+	if (error == lastError && status == lastStatus && now - lastLogTime < TRACKIR_ERROR_LOG_INTERVAL) {
+		suppressed++;
+		return;
+	}
+
+	if (suppressed > 0)
+		log_debug("error: %d, wNPStatus: %d (%u similar errors skipped)", error, status, suppressed);
+	else
+		log_debug("error: %d, wNPStatus: %d", error, status);
+	lastError = error;
+	lastStatus = status;
+	lastLogTime = now;
+	suppressed = 0;
+}
+
+bool ReadTrackIRData(float *yaw, float *pitch, float *x, float *y, float *z, unsigned short *frameSignature) {
 	int error;
 	error = NP_GetData(&data);
 	if (error != NP_OK || data.wNPStatus != 0) {
-		log_debug("error: %d, wNPStatus: %d", error, data.wNPStatus);
+		LogTrackIRReadError(error, data.wNPStatus);
 		return false;
 	}
+	if (frameSignature != NULL)
+		*frameSignature = data.wPFrameSignature;
 	*yaw   = data.fNPYaw   / 100.0f;
 	*pitch = data.fNPPitch / 100.0f;
 	*x     = data.fNPX;
@@ -2,4 +2,5 @@
 
 bool InitTrackIR();
 void ShutdownTrackIR();
-bool ReadTrackIRData(float *yaw, float *pitch, float *x, float *y, float *z);
+// frameSignature (optional) receives NPClient's frame counter: it only changes when there's a new frame
+bool ReadTrackIRData(float *yaw, float *pitch, float *x, float *y, float *z, unsigned short *frameSignature = NULL);
@@ -0,0 +1,235 @@
+/*
+ * Tracker capture and replay.
+ *
+ * The recorder writes every raw sample (before filtering and prediction) to an append-only
+ * binary file. The replayer loads one of those files and hands its samples back to
+ * UpdateTrackingData() in place of the device, so tracking problems can be reproduced
+ * without the hardware, either at the recorded pace or as fast as the game asks for them.
+ */
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "TrackerCapture.h"
+
+void log_debug(const char *format, ...);
+
+static const char TRACKER_CAPTURE_MAGIC[4] = { 'X', 'W', 'T', 'C' };
+
+// The recorder may be fed by the sampler thread and stopped by the game thread
+static CRITICAL_SECTION g_CaptureLock;
+static bool g_bCaptureLockInitialized = false;
+static FILE* g_CaptureFile = NULL;
+static int g_iCaptureSource = 0;
+static unsigned int g_iCaptureRecords = 0;
+
+bool g_bTrackerReplayRealTime = true;
+bool g_bTrackerReplayLoop = false;
+
+static std::vector<TrackerCaptureRecord> g_ReplayRecords;
+static double g_fReplayTickScale = 1.0; // Capture ticks to current QPC ticks
+static size_t g_iReplayIndex = 0;
+static LONGLONG g_ReplayStartTime = 0;
+static bool g_bReplayStarted = false;
+
+static LONGLONG GetQPCFrequency()
+{
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	return freq.QuadPart;
+}
+
+bool StartTrackerCapture(const char* fileName, int source)
+{
+	if (!g_bCaptureLockInitialized) {
+		InitializeCriticalSection(&g_CaptureLock);
+		g_bCaptureLockInitialized = true;
+	}
+
+	StopTrackerCapture();
+
+	FILE* file = NULL;
+	if (fopen_s(&file, fileName, "wb") != 0 || file == NULL) {
+		log_debug("[Capture] Could not create %s", fileName);
+		return false;
+	}
+	// Keep the writes in memory most of the time; the records are tiny
+	setvbuf(file, NULL, _IOFBF, 64 * 1024);
+
+	TrackerCaptureHeader header;
+	memcpy(header.magic, TRACKER_CAPTURE_MAGIC, sizeof(header.magic));
+	header.version = TRACKER_CAPTURE_VERSION;
+	header.recordSize = sizeof(TrackerCaptureRecord);
+	header.qpcFrequency = GetQPCFrequency();
+	if (fwrite(&header, sizeof(header), 1, file) != 1) {
+		log_debug("[Capture] Could not write the header of %s", fileName);
+		fclose(file);
+		return false;
+	}
+
+	EnterCriticalSection(&g_CaptureLock);
+	g_CaptureFile = file;
+	g_iCaptureSource = source;
+	g_iCaptureRecords = 0;
+	LeaveCriticalSection(&g_CaptureLock);
+	log_debug("[Capture] Recording tracker samples to %s", fileName);
+	return true;
+}
+
+void StopTrackerCapture()
+{
+	if (!g_bCaptureLockInitialized)
+		return;
+
+	EnterCriticalSection(&g_CaptureLock);
+	if (g_CaptureFile != NULL) {
+		fclose(g_CaptureFile);
+		g_CaptureFile = NULL;
+		log_debug("[Capture] Recorded %u samples", g_iCaptureRecords);
+	}
+	LeaveCriticalSection(&g_CaptureLock);
+}
+
+bool IsTrackerCaptureActive()
+{
+	return g_CaptureFile != NULL;
+}
+
+void RecordTrackerSample(const TrackerSample& sample)
+{
+	if (g_CaptureFile == NULL)
+		return;
+
+	TrackerCaptureRecord record;
+	record.timestamp = sample.timestamp;
+	record.yaw   = sample.yaw;
+	record.pitch = sample.pitch;
+	record.roll  = sample.roll;
+	record.x = sample.x;
+	record.y = sample.y;
+	record.z = sample.z;
+	record.valid = sample.valid ? 1 : 0;
+	record.reserved = 0;
+
+	EnterCriticalSection(&g_CaptureLock);
+	if (g_CaptureFile != NULL) {
+		record.source = (uint8_t)g_iCaptureSource;
+		if (fwrite(&record, sizeof(record), 1, g_CaptureFile) == 1)
+			g_iCaptureRecords++;
+	}
+	LeaveCriticalSection(&g_CaptureLock);
+}
+
+int LoadTrackerReplay(const char* fileName)
+{
+	UnloadTrackerReplay();
+
+	FILE* file = NULL;
+	if (fopen_s(&file, fileName, "rb") != 0 || file == NULL) {
+		log_debug("[Replay] Could not open %s", fileName);
+		return -1;
+	}
+
+	TrackerCaptureHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+		memcmp(header.magic, TRACKER_CAPTURE_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != TRACKER_CAPTURE_VERSION ||
+		header.recordSize != sizeof(TrackerCaptureRecord) ||
+		header.qpcFrequency <= 0)
+	{
+		log_debug("[Replay] %s is not a valid tracker capture", fileName);
+		fclose(file);
+		return -1;
+	}
+
+	// A truncated last record is simply dropped
+	TrackerCaptureRecord record;
+	while (fread(&record, sizeof(record), 1, file) == 1)
+		g_ReplayRecords.push_back(record);
+	fclose(file);
+
+	if (g_ReplayRecords.empty()) {
+		log_debug("[Replay] %s doesn't have any samples", fileName);
+		return -1;
+	}
+
+	g_fReplayTickScale = (double)GetQPCFrequency() / (double)header.qpcFrequency;
+	log_debug("[Replay] Loaded %u samples from %s, %0.3fs, source: %d",
+		(unsigned int)g_ReplayRecords.size(), fileName,
+		(double)(g_ReplayRecords.back().timestamp - g_ReplayRecords.front().timestamp) / (double)header.qpcFrequency,
+		g_ReplayRecords.front().source);
+	return g_ReplayRecords.front().source;
+}
+
+void UnloadTrackerReplay()
+{
+	g_ReplayRecords.clear();
+	g_iReplayIndex = 0;
+	g_bReplayStarted = false;
+}
+
+bool IsTrackerReplayLoaded()
+{
+	return !g_ReplayRecords.empty();
+}
+
+// Recorded time of a record, relative to the first one, in current QPC ticks
+static inline LONGLONG ReplayOffset(size_t index)
+{
+	return (LONGLONG)((double)(g_ReplayRecords[index].timestamp - g_ReplayRecords[0].timestamp) * g_fReplayTickScale);
+}
+
+bool ReadTrackerReplaySample(TrackerSample* sample)
+{
+	if (g_ReplayRecords.empty())
+		return false;
+
+	const LONGLONG now = GetQPCTime();
+	if (!g_bReplayStarted) {
+		g_ReplayStartTime = now;
+		g_iReplayIndex = 0;
+		g_bReplayStarted = true;
+	}
+
+	const size_t lastIndex = g_ReplayRecords.size() - 1;
+	bool bFinished;
+	if (g_bTrackerReplayRealTime) {
+		// Skip ahead to the newest record that would have been read by now
+		const LONGLONG elapsed = now - g_ReplayStartTime;
+		while (g_iReplayIndex < lastIndex && ReplayOffset(g_iReplayIndex + 1) <= elapsed)
+			g_iReplayIndex++;
+		bFinished = elapsed > ReplayOffset(lastIndex);
+	}
+	else
+		bFinished = g_iReplayIndex > lastIndex;
+
+	if (bFinished) {
+		if (!g_bTrackerReplayLoop) {
+			if (g_iReplayIndex <= lastIndex) {
+				log_debug("[Replay] End of capture");
+				// Park the index past the end so the message is only logged once
+				g_iReplayIndex = lastIndex + 1;
+			}
+			return false;
+		}
+		log_debug("[Replay] Restarting capture");
+		// Move the new start past the last timestamp handed out, so time keeps going forward
+		const LONGLONG nextStart = g_ReplayStartTime + ReplayOffset(lastIndex) + 1;
+		g_ReplayStartTime = now > nextStart ? now : nextStart;
+		g_iReplayIndex = 0;
+	}
+
+	const TrackerCaptureRecord& record = g_ReplayRecords[g_iReplayIndex];
+	sample->timestamp = g_ReplayStartTime + ReplayOffset(g_iReplayIndex);
+	sample->yaw   = record.yaw;
+	sample->pitch = record.pitch;
+	sample->roll  = record.roll;
+	sample->x = record.x;
+	sample->y = record.y;
+	sample->z = record.z;
+	sample->valid = record.valid != 0;
+
+	if (!g_bTrackerReplayRealTime)
+		g_iReplayIndex++;
+	return sample->valid;
+}
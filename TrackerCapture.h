@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include "TrackerSampler.h"
+
+/*
+ * Tracker capture files.
+ *
+ * A capture is a small header followed by fixed-size records, one per raw sample, in the
+ * order they were read. Files are only ever appended to, so a capture that was cut short
+ * (because the game crashed, for instance) is still readable up to the last full record.
+ * All fields are little-endian.
+ */
+#pragma pack(push, 1)
+struct TrackerCaptureHeader {
+	char     magic[4];     // "XWTC"
+	uint32_t version;
+	uint32_t recordSize;   // sizeof(TrackerCaptureRecord)
+	int64_t  qpcFrequency; // Ticks per second of the timestamps below
+};
+
+struct TrackerCaptureRecord {
+	int64_t timestamp;     // QueryPerformanceCounter() ticks
+	float   yaw, pitch, roll;
+	float   x, y, z;
+	uint8_t source;        // TrackerType that produced the sample
+	uint8_t valid;
+	uint16_t reserved;
+};
+#pragma pack(pop)
+
+constexpr uint32_t TRACKER_CAPTURE_VERSION = 1;
+
+// Recording
+bool StartTrackerCapture(const char* fileName, int source);
+void StopTrackerCapture();
+bool IsTrackerCaptureActive();
+// Appends a sample to the current capture. Does nothing if no capture is active.
+void RecordTrackerSample(const TrackerSample& sample);
+
+// Replay
+extern bool g_bTrackerReplayRealTime;
+extern bool g_bTrackerReplayLoop;
+
+// Loads a whole capture into memory. Returns the source of the first record, or -1 on error.
+int  LoadTrackerReplay(const char* fileName);
+void UnloadTrackerReplay();
+bool IsTrackerReplayLoaded();
+// Returns the next sample from the capture, with its timestamp moved to the current clock.
+// With real-time replay, this is the newest sample at the recorded pace; otherwise every
+// call advances exactly one record.
+bool ReadTrackerReplaySample(TrackerSample* sample);
@@ -0,0 +1,233 @@
+/*
+ * Background tracker sampling.
+ *
+ * Reading the tracker inside the camera hooks means that any stall in the device's driver
+ * shows up as a hitch in the game. When the sampler is enabled, a dedicated thread polls the
+ * tracker at its own rate and publishes timestamped samples through a SeqLock. The hooks only
+ * copy the newest complete sample, so they never wait for the device.
+ */
+#include <atomic>
+#include "TrackerSampler.h"
+#include "SeqLock.h"
+#include "Threading.h"
+#include "TrackerCapture.h"
+
+void log_debug(const char *format, ...);
+
+bool g_bTrackerSamplerEnabled = false;
+int  g_iTrackerSamplerRate    = DEFAULT_TRACKER_SAMPLER_RATE;
+
+static SeqLock<TrackerSample> g_LatestSample;
+
+// Each sampler thread gets its own stop flag, so a thread that didn't stop in time can't be
+// brought back to life by the next StartTrackerSampler().
+struct SamplerThreadContext {
+	std::atomic<bool> bRun;
+	TrackerReadFun readFun;
+	unsigned int sleepMs;
+};
+static Thread g_SamplerThread;
+static SamplerThreadContext* g_pSamplerContext = NULL;
+// A sampler thread that was stopped but hadn't exited yet. SeqLock only supports one writer,
+// so no new sampler is started until this one is gone.
+static Thread g_StraySamplerThread;
+static SamplerThreadContext* g_pStraySamplerContext = NULL;
+// The device manager starts and stops the sampler, and the game thread pauses it around a
+// config reload, so the state below is only touched with this lock held
+static Mutex g_SamplerLock;
+// The read function the sampler should be running, unless it's paused
+static TrackerReadFun g_SamplerReadFun = NULL;
+static int g_iSamplerPauses = 0;
+// StartTrackerSampler() was called while the sampler was paused
+static bool g_bSamplerStartedWhilePaused = false;
+
+#ifdef _WIN32
+static double QueryQPCInvFrequency()
+{
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	return 1.0 / (double)freq.QuadPart;
+}
+
+// Initialized when the DLL is loaded, before any of the threads that use it exist
+static const double g_fQPCInvFrequency = QueryQPCInvFrequency();
+
+LONGLONG GetQPCTime()
+{
+	LARGE_INTEGER t;
+	QueryPerformanceCounter(&t);
+	return t.QuadPart;
+}
+
+LONGLONG GetQPCFrequency()
+{
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	return freq.QuadPart;
+}
+#else
+// Elsewhere, the ticks are nanoseconds of the monotonic clock
+static const double g_fQPCInvFrequency = 1e-9;
+
+LONGLONG GetQPCTime()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (LONGLONG)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+LONGLONG GetQPCFrequency()
+{
+	return 1000000000LL;
+}
+#endif
+
+double QPCToSeconds(LONGLONG ticks)
+{
+	return (double)ticks * g_fQPCInvFrequency;
+}
+
+static void SamplerThreadFun(void* lpParam)
+{
+	SamplerThreadContext* context = (SamplerThreadContext*)lpParam;
+
+	while (context->bRun)
+	{
+		TrackerSample sample;
+		sample.timestamp = GetQPCTime();
+		sample.valid = context->readFun(&sample);
+		// The read may have taken a while; don't publish anything once we've been stopped
+		if (!context->bRun)
+			break;
+		RecordTrackerSample(sample);
+		// Invalid samples are published too, so that the hook can tell when the tracker drops out
+		g_LatestSample.Write(sample);
+		SleepMs(context->sleepMs);
+	}
+}
+
+// Waits a little for a stray sampler thread to exit. Returns true if there's none left.
+static bool ReapStraySamplerThread(unsigned int timeoutMs)
+{
+	if (!g_StraySamplerThread.IsStarted())
+		return true;
+	if (!g_StraySamplerThread.Join(timeoutMs))
+		return false;
+	delete g_pStraySamplerContext;
+	g_pStraySamplerContext = NULL;
+	return true;
+}
+
+static bool StartSamplerThread(TrackerReadFun readFun)
+{
+	if (g_SamplerThread.IsStarted())
+		return true;
+
+	if (!ReapStraySamplerThread(1000)) {
+		log_debug("[Sampler] The previous sampler thread is still running, the tracker will be read inline");
+		return false;
+	}
+
+	if (g_iTrackerSamplerRate <= 0)
+		g_iTrackerSamplerRate = DEFAULT_TRACKER_SAMPLER_RATE;
+
+	SamplerThreadContext* context = new SamplerThreadContext();
+	context->bRun = true;
+	context->readFun = readFun;
+	context->sleepMs = g_iTrackerSamplerRate >= 1000 ? 1 : 1000 / g_iTrackerSamplerRate;
+	if (!g_SamplerThread.Start(SamplerThreadFun, context)) {
+		log_debug("[Sampler] Could not create the tracker sampler thread");
+		delete context;
+		return false;
+	}
+	g_pSamplerContext = context;
+	g_SamplerThread.RaisePriority();
+	log_debug("[Sampler] Tracker sampler started at %d Hz", g_iTrackerSamplerRate);
+	return true;
+}
+
+static void StopSamplerThread(unsigned int timeoutMs)
+{
+	if (!g_SamplerThread.IsStarted())
+		return;
+
+	g_pSamplerContext->bRun = false;
+	// Don't wait forever: this may be called from DllMain, where the thread can't exit
+	// until the loader lock is released.
+	if (g_SamplerThread.Join(timeoutMs)) {
+		delete g_pSamplerContext;
+		log_debug("[Sampler] Tracker sampler stopped");
+	}
+	else {
+		// Probably stuck in the device's driver. It won't publish anything else, but it keeps
+		// its context until it's gone. Start refuses to run while this one is still around.
+		log_debug("[Sampler] The tracker sampler thread didn't stop in time");
+		g_StraySamplerThread = g_SamplerThread;
+		g_pStraySamplerContext = g_pSamplerContext;
+	}
+	g_SamplerThread = Thread();
+	g_pSamplerContext = NULL;
+}
+
+bool StartTrackerSampler(TrackerReadFun readFun)
+{
+	g_SamplerLock.Lock();
+	g_SamplerReadFun = readFun;
+	bool bResult = true;
+	if (g_iSamplerPauses > 0)
+		g_bSamplerStartedWhilePaused = true;
+	else
+		bResult = StartSamplerThread(readFun);
+	g_SamplerLock.Unlock();
+	return bResult;
+}
+
+void SignalTrackerSamplerStop()
+{
+	g_SamplerLock.Lock();
+	if (g_pSamplerContext != NULL)
+		g_pSamplerContext->bRun = false;
+	g_SamplerLock.Unlock();
+}
+
+void StopTrackerSampler(unsigned int timeoutMs)
+{
+	g_SamplerLock.Lock();
+	g_SamplerReadFun = NULL;
+	g_bSamplerStartedWhilePaused = false;
+	StopSamplerThread(timeoutMs);
+	g_SamplerLock.Unlock();
+}
+
+void PauseTrackerSampler()
+{
+	g_SamplerLock.Lock();
+	if (g_iSamplerPauses++ == 0)
+		StopSamplerThread(1000);
+	g_SamplerLock.Unlock();
+}
+
+void ResumeTrackerSampler(bool bSameDevice)
+{
+	g_SamplerLock.Lock();
+	if (g_iSamplerPauses > 0 && --g_iSamplerPauses == 0) {
+		// A read function from before the pause belongs to a device that's about to be
+		// replaced; the device manager starts the sampler again once the new one is up
+		if (!bSameDevice && !g_bSamplerStartedWhilePaused)
+			g_SamplerReadFun = NULL;
+		if (g_SamplerReadFun != NULL)
+			StartSamplerThread(g_SamplerReadFun);
+		g_bSamplerStartedWhilePaused = false;
+	}
+	g_SamplerLock.Unlock();
+}
+
+bool IsTrackerSamplerRunning()
+{
+	return g_SamplerThread.IsStarted();
+}
+
+bool GetLatestTrackerSample(TrackerSample* sample)
+{
+	return g_LatestSample.Read(sample);
+}
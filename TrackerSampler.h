@@ -0,0 +1,69 @@
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+// The portable parts (filters, predictor, tests) only need the timestamp type
+typedef long long LONGLONG;
+#endif
+
+/*
+ * A raw sample read from a tracking device. The angles and positions are in the device's
+ * own units: the multipliers, offsets and recentering are applied later by UpdateTrackingData().
+ */
+struct TrackerSample {
+	// QueryPerformanceCounter() ticks when the sample was read
+	LONGLONG timestamp;
+	float yaw, pitch, roll;
+	float x, y, z;
+	// false if the device could not be read
+	bool valid;
+
+	TrackerSample() {
+		this->timestamp = 0;
+		this->yaw = this->pitch = this->roll = 0.0f;
+		this->x = this->y = this->z = 0.0f;
+		this->valid = false;
+	}
+};
+
+// Reads one sample from a device. Returns false if the device could not be read.
+// The timestamp is set to the time of the read beforehand; devices that can tell when the
+// data was actually produced may overwrite it.
+typedef bool (*TrackerReadFun)(TrackerSample* sample);
+
+// Shortest signed difference between two sample angles, in degrees
+inline float AngleDiff(float a, float b) {
+	float d = a - b;
+	while (d >= 180.0f) d -= 360.0f;
+	while (d < -180.0f) d += 360.0f;
+	return d;
+}
+
+constexpr int DEFAULT_TRACKER_SAMPLER_RATE = 500; // Hz
+
+extern bool g_bTrackerSamplerEnabled;
+extern int  g_iTrackerSamplerRate;
+
+LONGLONG GetQPCTime();
+// Ticks per second of GetQPCTime()
+LONGLONG GetQPCFrequency();
+double QPCToSeconds(LONGLONG ticks);
+
+bool StartTrackerSampler(TrackerReadFun readFun);
+// Tells the sampler thread to stop without waiting for it, so that DllMain can stop every
+// thread before it waits for any of them. StopTrackerSampler() still has to be called.
+void SignalTrackerSamplerStop();
+// Waits up to timeoutMs for the sampler thread to exit
+void StopTrackerSampler(unsigned int timeoutMs = 1000);
+/*
+ * Stops the sampler thread while the state it reads is rewritten (a config reload). Starting
+ * the sampler while it's paused only takes effect when it's resumed. bSameDevice tells if the
+ * device it was reading stays the same: if not, the sampler stays down until it's started for
+ * the new one.
+ */
+void PauseTrackerSampler();
+void ResumeTrackerSampler(bool bSameDevice);
+bool IsTrackerSamplerRunning();
+// Copies the newest complete sample. Never blocks. Returns false if nothing has been sampled yet.
+bool GetLatestTrackerSample(TrackerSample* sample);
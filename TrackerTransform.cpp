@@ -0,0 +1,71 @@
+#include <math.h>
+#include "TrackerTransform.h"
+
+static inline float WrapAngle(float angle) {
+	// Same as adding 360 until the angle is positive, without the loop
+	return angle < 0.0f ? angle - 360.0f * floorf(angle / 360.0f) : angle;
+}
+
+TrackerTransform::TrackerTransform()
+{
+	posMultiplier.set(1.0f, 1.0f, 1.0f);
+	minPos.set(-1e9f, -1e9f, -1e9f);
+	maxPos.set( 1e9f,  1e9f,  1e9f);
+	rotScale.set(1.0f, 1.0f, 1.0f);
+	rotOffset.set(0.0f, 0.0f, 0.0f);
+	center.set(0.0f, 0.0f, 0.0f, 1.0f);
+	Compile();
+}
+
+void TrackerTransform::Compile()
+{
+	const Matrix4 multipliers(
+		posMultiplier.x, 0, 0, 0,
+		0, posMultiplier.y, 0, 0,
+		0, 0, posMultiplier.z, 0,
+		0, 0, 0, 1);
+	composed = multipliers * deviceToXWA;
+	// Only the linear part of deviceToXWA is used, so the center goes in the translation
+	composed[12] = composed[13] = composed[14] = 0.0f;
+	const Vector4 offset = composed * Vector4(center.x, center.y, center.z, 0.0f);
+	composed[12] = -offset.x;
+	composed[13] = -offset.y;
+	composed[14] = -offset.z;
+}
+
+void TrackerTransform::SetCenter(const Vector4& center)
+{
+	this->center.set(center.x, center.y, center.z, 1.0f);
+	Compile();
+}
+
+void TrackerTransform::ApplyRotation(float* yaw, float* pitch, float* roll) const
+{
+	*yaw   = WrapAngle(yawCurve.Apply(*yaw     * rotScale.x) + rotOffset.x);
+	*pitch = WrapAngle(pitchCurve.Apply(*pitch * rotScale.y) + rotOffset.y);
+	*roll  = WrapAngle(rollCurve.Apply(*roll   * rotScale.z) + rotOffset.z);
+}
+
+void TrackerTransform::ApplyCurves(float* yaw, float* pitch, float* roll) const
+{
+	*yaw   = yawCurve.Apply(*yaw     * rotScale.x);
+	*pitch = pitchCurve.Apply(*pitch * rotScale.y);
+	*roll  = rollCurve.Apply(*roll   * rotScale.z);
+}
+
+Vector4 TrackerTransform::ApplyPosition(const Vector4& pos, const Vector3& lean, const Matrix4* turret) const
+{
+	Vector4 out;
+	if (turret == NULL)
+		out = composed * Vector4(pos.x, pos.y, pos.z, 1.0f);
+	else {
+		Vector4 v = deviceToXWA * Vector4(pos.x - center.x, pos.y - center.y, pos.z - center.z, 0.0f);
+		v = *turret * v;
+		out.set(v.x * posMultiplier.x, v.y * posMultiplier.y, v.z * posMultiplier.z, 0.0f);
+	}
+	out.x = fminf(fmaxf(out.x + lean.x, minPos.x), maxPos.x);
+	out.y = fminf(fmaxf(out.y + lean.y, minPos.y), maxPos.y);
+	out.z = fminf(fmaxf(out.z + lean.z, minPos.z), maxPos.z);
+	out.w = 0.0f;
+	return out;
+}
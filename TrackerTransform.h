@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Matrices.h"
+#include "ResponseCurve.h"
+
+/*
+ * Per-tracker conventions: axis signs and swaps, units, multipliers, offsets and limits.
+ *
+ * LoadParams() compiles them once for the current tracker; the trackers only report their
+ * raw angles and position and UpdateTrackingData() turns them into the head's pose with a
+ * single call to ApplyRotation() and ApplyPosition().
+ */
+class TrackerTransform
+{
+public:
+	// Device position to XWA's axes, in meters (before the multipliers)
+	Matrix4 deviceToXWA;
+	Vector3 posMultiplier;
+	Vector3 minPos, maxPos;
+	// Angles: out = curve(angle * rotScale) + rotOffset, in degrees. x: yaw, y: pitch, z: roll.
+	Vector3 rotScale, rotOffset;
+	ResponseCurve yawCurve, pitchCurve, rollCurve;
+
+	TrackerTransform();
+
+	// Rebuilds the precomposed position transform. Must be called after changing deviceToXWA
+	// or posMultiplier.
+	void Compile();
+	// Position that maps to the origin, in device units
+	void SetCenter(const Vector4& center);
+	const Vector4& GetCenter() const { return center; }
+
+	// Scales, shapes and offsets the angles; negative results are wrapped into [0, 360)
+	void ApplyRotation(float* yaw, float* pitch, float* roll) const;
+	// Only scales and shapes the angles: curve(angle * rotScale). The trackers that inject
+	// their rotation into the camera use it to build that rotation from the same angles
+	// ApplyRotation() exports.
+	void ApplyCurves(float* yaw, float* pitch, float* roll) const;
+	bool HasCurves() const { return yawCurve.IsEnabled() || pitchCurve.IsEnabled() || rollCurve.IsEnabled(); }
+	// Returns clamp(multipliers * turret * deviceToXWA * (pos - center) + lean). The turret
+	// rotation sits in the middle of the chain, so it can't be precomposed.
+	Vector4 ApplyPosition(const Vector4& pos, const Vector3& lean, const Matrix4* turret = NULL) const;
+
+private:
+	Vector4 center;
+	// multipliers * deviceToXWA, with -center folded into the translation
+	Matrix4 composed;
+};
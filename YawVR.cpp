@@ -423,27 +423,27 @@ namespace YawVR
         return 0;
     }
 
-    void Initialize()
+    bool Initialize()
     {
         if (!InitializeSockets())
         {
             bEnabled = false;
             debug("[YVR] InitializeSockets() failed. Disabling YawVR");
-            return;
+            return false;
         }
 
         if (!Connect())
         {
             bEnabled = false;
             debug("[YVR] Connect() failed. Disabling YawVR");
-            return;
+            return false;
         }
 
         if (!CheckIn())
         {
             bEnabled = false;
             debug("[YVR] CheckIn() failed. Disabling YawVR");
-            return;
+            return false;
         }
 
         /*
@@ -462,11 +462,12 @@ namespace YawVR
         {
             bEnabled = false;
             debug("[YVR] Start() failed. Disabling YawVR");
-            return;
+            return false;
         }
 
         bRunThread = true;
         hThread = CreateThread(NULL, 0, ThreadFun, NULL, 0, NULL);
+        return true;
     }
 
     void Shutdown()
@@ -25,7 +25,8 @@ namespace YawVR
 
 	bool InitializeSockets();
 	void Shutdown();
-	void Initialize();
+	// Connects to the YawVR server; blocks until it answers or the connection fails
+	bool Initialize();
 	void ApplyInertia(float yawInertia, float pitchInertia, float rollInertia, float distInertia);
 
 	void debug(const char* format, ...);
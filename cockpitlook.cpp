@@ -27,6 +27,24 @@
 #include "YawVR.h"
 #include "Telemetry.h"
 #include "SharedMem.h"
+#include "TrackerSampler.h"
+#include "PosePredictor.h"
+#include "PoseFilter.h"
+#include "TrackerCapture.h"
+#include "Quaternion.h"
+#include "OpenTrack.h"
+#include "PoseFusion.h"
+#include "PoseDropout.h"
+#include "TrackerTransform.h"
+#include "FrameClock.h"
+#include "DeviceManager.h"
+#include "Startup.h"
+#include "AngleTable.h"
+#include "HeadingBasis.h"
+#include "LagFilter.h"
+#include "HeadModel.h"
+#include "SmoothInertia.h"
+#include "LeanAnim.h"
 
 // Unfortunately, applying roll inertia modifies the worldview transform in such a way
 // that roll inertia is "inherited" to the lights, causing shadows to "dance" in VR.
@@ -42,7 +60,10 @@ bool g_bForceSteamVRShutdown = false;
 bool g_bHeadtrackingApplied = false;
 
 vr::TrackedDevicePose_t g_hmdPose;
-Matrix3 g_headRotation;
+// Rotation injected into the camera by DoRotationPitchHook() (FreePIE and SteamVR)
+Quaternion g_headRotation;
+// Yaw/pitch/roll offsets as a rotation, composed once in LoadParams()
+Quaternion g_headOffsetRotation;
 float g_headYaw = 0.0f, g_headPitch = 0.0f, g_headRoll = 0.0f, g_rollInertia = 0.0f;
 
 vr::HmdQuaternionf_t rotationToQuaternion(vr::HmdMatrix34_t m);
@@ -67,8 +88,9 @@ std::vector<Inertia> g_InertiaData;
 
 void log_debug(const char *format, ...)
 {
-	static char buf[300];
-	static char out[300];
+	// These buffers live on the stack because the tracker sampler thread may log too
+	char buf[300];
+	char out[300];
 
 #ifdef DEBUG_TO_FILE
 	if (g_DebugFile == NULL) {
@@ -202,13 +224,20 @@ void UpdateHyperspaceState(int playerIndex) {
 }
 
 void LoadParams();
+TrackerDeviceConfig GetTrackerDeviceConfig();
+// State of the startup tasks, see g_StartupTasks
+bool IsConfigLoaded();
+bool IsTelemetryReady();
 
 // cockpitlook.cfg parameter names
 const char *TRACKER_TYPE					= "tracker_type"; // Defines which tracker to use
 const char *TRACKER_TYPE_FREEPIE			= "FreePIE"; // Use FreePIE as the tracker
 const char *TRACKER_TYPE_STEAMVR			= "SteamVR"; // Use SteamVR as the tracker
 const char *TRACKER_TYPE_TRACKIR			= "TrackIR"; // Use TrackIR (or OpenTrack) as the tracker
+const char *TRACKER_TYPE_OPENTRACK			= "OpenTrackUDP"; // Receive OpenTrack's "UDP over network" output
+const char *TRACKER_TYPE_FUSION				= "Fusion"; // Rotation and position from two different trackers
 const char *TRACKER_TYPE_NONE				= "None";
+const char *TRACKER_TYPE_REPLAY				= "Replay"; // Play back a tracker capture instead of reading a device
 const char *DISABLE_HANGAR_RANDOM_CAMERA	= "disable_hangar_random_camera";
 const char *YAW_MULTIPLIER					= "yaw_multiplier";
 const char *PITCH_MULTIPLIER				= "pitch_multiplier";
@@ -216,7 +245,11 @@ const char *ROLL_MULTIPLIER					= "roll_multiplier";
 const char *YAW_OFFSET						= "yaw_offset";
 const char *PITCH_OFFSET					= "pitch_offset";
 const char *ROLL_OFFSET						= "roll_offset";
+const char *YAW_CURVE						= "yaw_curve";
+const char *PITCH_CURVE						= "pitch_curve";
+const char *ROLL_CURVE						= "roll_curve";
 const char *FREEPIE_SLOT					= "freepie_slot";
+const char *OPENTRACK_PORT					= "opentrack_port";
 
 const char *POS_X_MULTIPLIER_VRPARAM = "positional_x_multiplier";
 const char *POS_Y_MULTIPLIER_VRPARAM = "positional_y_multiplier";
@@ -257,24 +290,84 @@ typedef enum {
 	TRACKER_NONE,
 	TRACKER_FREEPIE,
 	TRACKER_STEAMVR,
-	TRACKER_TRACKIR
+	TRACKER_TRACKIR,
+	TRACKER_OPENTRACK,
+	TRACKER_FUSION
 } TrackerType;
 TrackerType g_TrackerType = TRACKER_NONE;
 
+// Per-tracker limits for the pose prediction stage, in the units reported by each device
+typedef struct PredictionLimitsStruct {
+	float maxAngle, maxPos;
+} PredictionLimits;
+PredictionLimits g_PredictionLimits[] = {
+	{  0.0f,   0.0f }, // TRACKER_NONE
+	{ 10.0f,   0.05f }, // TRACKER_FREEPIE: degrees, meters
+	{ 10.0f,   0.05f }, // TRACKER_STEAMVR: unused, SteamVR does its own prediction
+	{ 10.0f, 250.0f }, // TRACKER_TRACKIR: degrees, NPClient units (later scaled by 0.0002)
+	{ 10.0f,   5.0f }, // TRACKER_OPENTRACK: degrees, centimeters
+	{ 10.0f,   0.05f }, // TRACKER_FUSION: degrees, meters
+};
+bool g_bPosePredictionEnabled = false;
+PosePredictor g_PosePredictor;
+
+// Per-tracker One-Euro filter settings. The rotation is always in degrees, but the
+// position speed (and therefore its beta) depends on the units reported by each device.
+// The noise target is the position jitter that filter_auto_cutoff aims for, about 0.3mm.
+typedef struct FilterParamsStruct {
+	float posMinCutoff, posBeta, posNoiseTarget;
+} FilterParams;
+FilterParams g_FilterParams[] = {
+	{ 1.0f, 0.0f,   0.0f    }, // TRACKER_NONE
+	{ 1.0f, 10.0f,  0.0003f }, // TRACKER_FREEPIE: meters
+	{ 1.0f, 10.0f,  0.0003f }, // TRACKER_STEAMVR: meters, only the position is filtered
+	{ 1.0f, 0.004f, 1.5f    }, // TRACKER_TRACKIR: NPClient units
+	{ 1.0f, 0.1f,   0.03f   }, // TRACKER_OPENTRACK: centimeters
+	{ 1.0f, 10.0f,  0.0003f }, // TRACKER_FUSION: meters
+};
+bool g_bPoseFilterEnabled = false;
+PoseFilter g_PoseFilter;
+// Seconds between two reports of the measured tracker noise in the log
+constexpr double POSE_NOISE_LOG_INTERVAL = 10.0;
+bool g_bPoseDropoutEnabled = false;
+PoseDropout g_PoseDropout;
+// Conventions of the current tracker, compiled by CompileTrackerTransform()
+TrackerTransform g_TrackerTransform;
+
+// Sources of the Fusion tracker
+TrackerType g_FusionRotationSource = TRACKER_STEAMVR;
+TrackerType g_FusionPositionSource = TRACKER_FREEPIE;
+PoseFusion g_PoseFusion;
+
+// Resample TrackIR's frames at the game's frame rate
+bool g_bTrackIRInterpolation = false;
+float g_fTrackIRInterpolationDelay = -1.0f; // Seconds, negative: one sample period
+bool g_bPoseInterpolationEnabled = false;
+PoseInterpolator g_PoseInterpolator;
+
+// Tracker capture/replay. When replaying, g_TrackerType is set to the tracker that made
+// the capture, so the samples go through the same code as the real device.
+bool g_bTrackerCaptureEnabled = false;
+char g_sTrackerCaptureFile[MAX_PATH] = "./TrackerCapture.bin";
+bool g_bTrackerReplay = false;
+char g_sTrackerReplayFile[MAX_PATH] = "./TrackerCapture.bin";
+
 float g_fYawMultiplier   = DEFAULT_YAW_MULTIPLIER;
 float g_fPitchMultiplier = DEFAULT_PITCH_MULTIPLIER;
 float g_fRollMultiplier  = DEFAULT_ROLL_MULTIPLIER;
 float g_fYawOffset       = DEFAULT_YAW_OFFSET;
 float g_fPitchOffset     = DEFAULT_PITCH_OFFSET;
 float g_fRollOffset      = DEFAULT_ROLL_OFFSET;
+// Optional response curves, applied to the tracked angles after the multipliers
+ResponseCurve g_YawCurve, g_PitchCurve, g_RollCurve;
 int   g_iFreePIESlot     = DEFAULT_FREEPIE_SLOT;
 bool  g_bYawPitchFromMouseOverride = false;
 bool  g_bKeyboardLean = false, g_bKeyboardLook = false;
 bool  g_bTestJoystick = true;
 Vector4 g_headCenter(0, 0, 0, 0), g_headPos(0, 0, 0, 0), g_headRotationHome(0, 0, 0, 0);
 Vector3 g_headPosFromKeyboard(0, 0, 0);
-Vector4 g_prevRs(1, 0, 0, 0);
-Vector4 g_prevFs(0, 0, 1, 0);
+// The heading the cockpit inertia is measured against: it trails the craft's Rs and Fs
+LagFilter<Vector4> g_prevRs, g_prevFs;
 int g_FreePIEOutputSlot = -1;
 bool g_bTrackIRLoaded = false;
 int g_iNumPadSpeed = -1;
@@ -295,8 +388,29 @@ bool g_bEnableExternalInertiaInMap = false;
 // The following flag is set when the MapCameraUpdateHook() is running, so that the external inertia
 // can be disabled while the map is displayed.
 bool g_bInsideMapCameraUpdateHook = false;
+// Set while MapCameraUpdateHook() is running, regardless of g_bEnableExternalInertiaInMap
+bool g_bInMapCameraUpdate = false;
+// Frame boundaries for UpdateTrackingData(). The engine doesn't give us a frame counter, so
+// FrameClock guesses them from the time between calls. With the gate enabled, the tracking
+// pipeline only runs once per frame from each of the hooks that lead to it (the map hook and
+// the regular camera hooks). The boundaries are a heuristic, so the gate is off by default.
+FrameClock g_FrameClock;
+bool g_bFrameGateEnabled = false;
 float g_fCockpitInertia = 0.35f, g_fCockpitSpeedInertia = 0.005f, g_fExtDistInertia = 0.0f;
 float g_fCockpitMaxInertia = 0.2f, g_fExtInertia = -16384.0f, g_fExtMaxInertia = 0.025f;
+// Time constants of the inertia model, in seconds. The defaults match the per-frame smoothing
+// the inertia used to have at 60fps, which is what the strengths above were tuned for.
+float g_fInertiaHeadingTimeConstant = 0.333f, g_fInertiaAccelTimeConstant = 0.167f, g_fInertiaSpeedTimeConstant = 0.333f;
+// If > 0, the inertia model advances in fixed steps of this many seconds
+float g_fInertiaFixedStep = 0.0f;
+enum CockpitInertiaModel {
+	INERTIA_MODEL_TRAILING, // The displacement is the difference between the heading and a trailing copy of it
+	INERTIA_MODEL_SPRING,   // The displacement comes from g_HeadModel
+};
+int g_iCockpitInertiaModel = INERTIA_MODEL_TRAILING;
+HeadModel g_HeadModel;
+// Longer gaps between two inertia updates mean the game was paused or a new mission was loaded
+constexpr double INERTIA_RESET_GAP = 2.0;
 short g_externalTilt = -1820; // -10 degrees
 // tilt = degrees * 32768 / 180
 
@@ -307,7 +421,7 @@ short g_externalTilt = -1820; // -10 degrees
 // In XWA, the Y+ axis points forward (towards the horizon) and Z+ points up.
 // To make this consistent with regular PixelShader coords, we need to swap these
 // coordinates using a rotation and reflection. The following matrix stores that
-// transformation and is only used in GetCurrentHeadingMatrix().
+// transformation; ComputeHeadingBasis() has it folded into its closed form.
 Matrix4 g_ReflRotX;
 
 void InitHeadingMatrix() {
@@ -330,7 +444,7 @@ void InitHeadingMatrix() {
 		0.0, 1.0, 0.0, 0.0,
 		0.0, 0.0, 0.0, 1.0
 	);
-	
+	InitAngleTable();
 }
 
 inline float clamp(float x, const float lowerlimit, const float upperlimit) {
@@ -349,110 +463,69 @@ inline float lerp(const float x, const float y, const float s) {
 	return x + s * (y - x);
 }
 
-void Matrix4toHmdMatrix34(const Matrix4& m4, vr::HmdMatrix34_t& mat) {
-	mat.m[0][0] = m4[0];  mat.m[1][0] = m4[1];  mat.m[2][0] = m4[2];
-	mat.m[0][1] = m4[4];  mat.m[1][1] = m4[5];  mat.m[2][1] = m4[6];
-	mat.m[0][2] = m4[8];  mat.m[1][2] = m4[9];  mat.m[2][2] = m4[10];
-	mat.m[0][3] = m4[12]; mat.m[1][3] = m4[13]; mat.m[2][3] = m4[14];
+// Returns the current ship's orientation, recomputed only when it changes
+const HeadingBasis &GetCurrentHeadingBasis(int playerIndex)
+{
+	static HeadingBasisCache cache;
+	const HeadingBasis &basis = cache.Get(playerIndex, PlayerDataTable[playerIndex].Camera.CraftYaw,
+		PlayerDataTable[playerIndex].Camera.CraftPitch, PlayerDataTable[playerIndex].Camera.CraftRoll);
+
+	// Store data for the next frame if we're not in hyperspace. ComputeInertia() works with
+	// the global-to-ship form.
+	if (!g_bInHyperspace || g_HyperspacePhaseFSM == HS_HYPER_EXIT_ST) {
+		g_LastRsBeforeHyperspace = basis.Rs;
+		g_LastFsBeforeHyperspace = basis.Fs;
+		g_prevHeadingMatrix = basis.toShip;
+		g_fLastSpeedBeforeHyperspace = (float)PlayerDataTable[playerIndex].currentSpeed;
+	}
+	return basis;
 }
 
 /*
- * Compute the current ship's orientation. Returns:
- * Rs: The "Right" vector in global coordinates
- * Us: The "Up" vector in global coordinates
- * Fs: The "Forward" vector in global coordinates
- * A viewMatrix that maps [Rs, Us, Fs] to the major [X, Y, Z] axes
+ * Compute the current ship's orientation. Returns Rs, Us, Fs (see HeadingBasis) and
+ * a viewMatrix that maps [Rs, Us, Fs] to the major [X, Y, Z] axes, or the other way
+ * around if invert is set.
  */
 Matrix4 GetCurrentHeadingMatrix(int playerIndex, Vector4 &Rs, Vector4 &Us, Vector4 &Fs, bool invert = false)
 {
-	const float DEG2RAD = 3.141593f / 180;
-	float yaw, pitch, roll;
-	Matrix4 rotMatrixFull, rotMatrixYaw, rotMatrixPitch, rotMatrixRoll;
-	Vector4 T, B, N;
-	// Compute the full rotation
-	yaw   = PlayerDataTable[playerIndex].Camera.CraftYaw   / 65536.0f * 360.0f;
-	pitch = PlayerDataTable[playerIndex].Camera.CraftPitch / 65536.0f * 360.0f;
-	roll  = PlayerDataTable[playerIndex].Camera.CraftRoll  / 65536.0f * 360.0f;
-
-	// yaw-pitch-roll gets reset to: ypr: 0.000, 90.000, 0.000 when entering hyperspace
-	/*if (!g_bInHyperspace)
-		log_debug("ypr: %0.3f, %0.3f, %0.3f", yaw, pitch, roll);
-	else
-		log_debug("[H] ypr: %0.3f, %0.3f, %0.3f", yaw, pitch, roll);*/
-
-	// To test how (x,y,z) is aligned with either the Y+ or Z+ axis, just multiply rotMatrixPitch * rotMatrixYaw * (x,y,z)
-	//Matrix4 rotMatrixFull, rotMatrixYaw, rotMatrixPitch, rotMatrixRoll;
-	rotMatrixFull.identity();
-	rotMatrixYaw.identity();   rotMatrixYaw.rotateY(-yaw);
-	rotMatrixPitch.identity(); rotMatrixPitch.rotateX(-pitch);
-	rotMatrixRoll.identity();  rotMatrixRoll.rotateY(roll);
-
-	// rotMatrixYaw aligns the orientation with the y-z plane (x --> 0)
-	// rotMatrixPitch * rotMatrixYaw aligns the orientation with y+ (x --> 0 && z --> 0)
-	// so the remaining rotation must be around the y axis (?)
-	// DEBUG, x = z, y = x, z = y;
-	// The yaw is indeed the y-axis rotation, it goes from -180 to 0 to 180.
-	// When pitch == 90, the craft is actually seeing the horizon
-	// When pitch == 0, the craft is looking towards the sun
-	// New approach: let's build a TBN system here to avoid the gimbal lock problem
-	float cosTheta, cosPhi, sinTheta, sinPhi;
-	cosTheta = cos(yaw * DEG2RAD), sinTheta = sin(yaw * DEG2RAD);
-	cosPhi = cos(pitch * DEG2RAD), sinPhi = sin(pitch * DEG2RAD);
-	N.z = cosTheta * sinPhi;
-	N.x = sinTheta * sinPhi;
-	N.y = cosPhi;
-	N.w = 0;
-
-	// This transform chain will always transform (N.x,N.y,N.z) into (0, 1, 0)
-	// To make an orthonormal basis, we need x+ and z+
-	N = rotMatrixPitch * rotMatrixYaw * N;
-	//log_debug("[DBG] N(DEBUG): %0.3f, %0.3f, %0.3f", N.x, N.y, N.z); // --> displays (0,1,0)
-	B.x = 0; B.y = 0; B.z = -1; B.w = 0;
-	T.x = 1; T.y = 0; T.z = 0; T.w = 0;
-	B = rotMatrixRoll * B;
-	T = rotMatrixRoll * T;
-	// Our new basis is T,B,N; but we need to invert the yaw/pitch rotation we applied
-	rotMatrixFull = rotMatrixPitch * rotMatrixYaw;
-	rotMatrixFull.invert();
-	T = rotMatrixFull * T;
-	B = rotMatrixFull * B;
-	N = rotMatrixFull * N;
-	// Our TBN basis is now in absolute coordinates
-	Fs = g_ReflRotX * N;
-	Us = g_ReflRotX * B;
-	Rs = g_ReflRotX * T;
-	Fs.w = 0; Rs.w = 0; Us.w = 0;
-	// This transform chain gets us the orientation of the craft in XWA's coord system:
-	// [1,0,0] is right, [0,1,0] is forward, [0,0,1] is up
-
-	Matrix4 viewMatrix;
-	if (!invert) { // Transform current ship's heading to Global Coordinates (Major Axes)
-		viewMatrix = Matrix4(
-			Rs.x, Us.x, Fs.x, 0,
-			Rs.y, Us.y, Fs.y, 0,
-			Rs.z, Us.z, Fs.z, 0,
-			0, 0, 0, 1
-		);
-		// Rs, Us, Fs is an orthonormal basis
-	}
-	else { // Transform Global Coordinates to the Ship's Coordinate System
-		viewMatrix = Matrix4(
-			Rs.x, Rs.y, Rs.z, 0,
-			Us.x, Us.y, Us.z, 0,
-			Fs.x, Fs.y, Fs.z, 0,
-			0, 0, 0, 1
-		);
-		// Rs, Us, Fs is an orthonormal basis
-	}
+	const HeadingBasis &basis = GetCurrentHeadingBasis(playerIndex);
+	Rs = basis.Rs; Us = basis.Us; Fs = basis.Fs;
+	return invert ? basis.toShip : basis.toGlobal;
+}
 
-	// Store data for the next frame if we're not in hyperspace
-	if (!g_bInHyperspace || g_HyperspacePhaseFSM == HS_HYPER_EXIT_ST) {
-		g_LastRsBeforeHyperspace = Rs;
-		g_LastFsBeforeHyperspace = Fs;
-		g_prevHeadingMatrix = viewMatrix;
-		g_fLastSpeedBeforeHyperspace = (float)PlayerDataTable[playerIndex].currentSpeed;
+// Smooth version of clamping x to [-limit, limit]: linear around 0, approaching the limit
+// asymptotically instead of hitting it.
+inline float SoftLimit(float x, float limit) {
+	if (limit <= 0.0f)
+		return 0.0f;
+	const float r = x / limit;
+	return x / sqrtf(1.0f + r * r);
+}
+
+/*
+ * Cockpit inertia from g_HeadModel. The ship's angular velocity is taken from the change in
+ * its heading since the previous frame (prevRs, prevFs), expressed in the ship's frame by H.
+ * dt is 0 for repeated calls in the same frame: they only read the model.
+ */
+void ComputeHeadModelInertia(const Matrix4 &H, const Vector4 &Rs, const Vector4 &Fs, const Vector4 &prevRs, const Vector4 &prevFs,
+	float fCurSpeed, float fPrevSpeed, float dt, float *XDisp, float *YDisp, float *ZDisp, float *AccelDisp)
+{
+	if (dt > 0.0f) {
+		Matrix4 HT = H;
+		HT.transpose();
+		Vector4 diffX = Vector4(1, 0, 0, 0) - HT * prevRs;
+		Vector4 diffZ = Vector4(0, 0, 1, 0) - HT * prevFs;
+		const float headVelocity[HEAD_AXIS_COUNT] = {
+			diffZ.x / dt, diffZ.y / dt, diffX.y / dt, fCurSpeed
+		};
+		g_HeadModel.Update(headVelocity, dt);
 	}
-	return viewMatrix;
+
+	const float MaxAngularInertia = g_fCockpitMaxInertia * 60.0f;
+	*XDisp = SoftLimit(g_fCockpitInertia * g_HeadModel.GetDisplacement(HEAD_AXIS_YAW), g_fCockpitMaxInertia);
+	*YDisp = SoftLimit(g_fCockpitInertia * g_HeadModel.GetDisplacement(HEAD_AXIS_PITCH), g_fCockpitMaxInertia);
+	*ZDisp = SoftLimit(g_fCockpitInertia * 60.0f * g_HeadModel.GetDisplacement(HEAD_AXIS_ROLL), MaxAngularInertia);
+	*AccelDisp = SoftLimit(-g_fCockpitSpeedInertia * g_HeadModel.GetDisplacement(HEAD_AXIS_SURGE), g_fCockpitMaxInertia);
 }
 
 /*
@@ -465,10 +538,16 @@ Matrix4 GetCurrentHeadingMatrix(int playerIndex, Vector4 &Rs, Vector4 &Us, Vecto
  */
 void ComputeInertia(const Matrix4 &H, Vector4 Rs, Vector4 Fs, float fRawCurSpeed, int playerIndex, float *XDisp, float *YDisp, float *ZDisp, float *AccelDisp) {
 	static bool bFirstFrame = true;
-	static float fCurSpeed = 0.0f;
-	static float fLastSpeed = 0.0f;
-	static time_t prevT = 0;
-	time_t curT = time(NULL);
+	static LagFilter<float> curSpeed, lastSpeed;
+	// The heading from the previous frame, for the angular velocity that drives g_HeadModel
+	static Vector4 rawPrevRs, rawPrevFs;
+	static float fPrevSpeed = 0.0f;
+	static LONGLONG prevT = 0;
+	// When, and in which frame, g_HeadModel was last stepped
+	static LONGLONG headModelT = 0;
+	static unsigned int headModelFrameId = 0;
+	const LONGLONG curT = GetQPCTime();
+	const double dt = prevT != 0 ? QPCToSeconds(curT - prevT) : 0.0;
 	bool InertiaEnabled = g_bCockpitInertiaEnabled || g_bExtInertiaEnabled;
 #if DEBUG_INERTIA == 1
 	Inertia inertia;
@@ -477,11 +556,15 @@ void ComputeInertia(const Matrix4 &H, Vector4 Rs, Vector4 Fs, float fRawCurSpeed
 	// Smooth the speed. The speed is stored as an integer by the game so it will
 	// have discreet jumps that will be noticed as jerkiness in the cockpit.
 	// Let's smooth the speed before we use it to compute inertia:
-	fCurSpeed = 0.05f * fRawCurSpeed + 0.95f * fCurSpeed;
+	curSpeed.timeConstant = g_fInertiaSpeedTimeConstant;
+	lastSpeed.timeConstant = g_fInertiaAccelTimeConstant;
+	g_prevRs.timeConstant = g_prevFs.timeConstant = g_fInertiaHeadingTimeConstant;
+	curSpeed.fixedStep = lastSpeed.fixedStep = g_prevRs.fixedStep = g_prevFs.fixedStep = g_fInertiaFixedStep;
+	const float fCurSpeed = curSpeed.Update(fRawCurSpeed, (float)dt);
 
 	// Reset the first frame if the time between successive queries is too big: this
 	// implies the game was either paused or a new mission was loaded
-	bFirstFrame = curT - prevT > 2; // Reset if +2s have elapsed
+	bFirstFrame = prevT == 0 || dt > INERTIA_RESET_GAP;
 	// Skip the very first frame: there's no inertia to compute yet
 	if (bFirstFrame || !InertiaEnabled || g_bHyperspaceTunnelLastFrame || g_bHyperspaceLastFrame)
 	{
@@ -489,13 +572,48 @@ void ComputeInertia(const Matrix4 &H, Vector4 Rs, Vector4 Fs, float fRawCurSpeed
 		*XDisp = *YDisp = *ZDisp = *AccelDisp = 0.0f;
 		//log_debug("Resetting X/Y/ZDisp");
 		// Update the previous heading vectors
-		g_prevRs = Rs;
-		g_prevFs = Fs;
+		g_prevRs.Reset(Rs);
+		g_prevFs.Reset(Fs);
+		rawPrevRs = Rs;
+		rawPrevFs = Fs;
+		fPrevSpeed = fCurSpeed;
+		const float headVelocity[HEAD_AXIS_COUNT] = { 0.0f, 0.0f, 0.0f, fCurSpeed };
+		g_HeadModel.Reset(headVelocity);
+		headModelT = prevT = curT;
+		headModelFrameId = g_FrameClock.GetFrameId();
+		lastSpeed.Reset(fCurSpeed);
+		return;
+	}
+
+	if (g_iCockpitInertiaModel == INERTIA_MODEL_SPRING) {
+		// The gate may let several calls per frame through. The heading hasn't changed between
+		// them, so stepping the model on each would feed it a zero angular velocity every now
+		// and then, and the camera would jolt. Only the first call of a frame steps it, with
+		// the velocity over the whole time since the last frame.
+		const unsigned int frameId = g_FrameClock.GetFrameId();
+		const bool bNewFrame = frameId != headModelFrameId;
+		const float headModelDt = bNewFrame ? (float)QPCToSeconds(curT - headModelT) : 0.0f;
+		ComputeHeadModelInertia(H, Rs, Fs, rawPrevRs, rawPrevFs, fCurSpeed, fPrevSpeed, headModelDt, XDisp, YDisp, ZDisp, AccelDisp);
+		if (bNewFrame) {
+			rawPrevRs = Rs;
+			rawPrevFs = Fs;
+			fPrevSpeed = fCurSpeed;
+			headModelT = curT;
+			headModelFrameId = frameId;
+		}
 		prevT = curT;
-		fLastSpeed = fCurSpeed;
+		if (g_HyperspacePhaseFSM == HS_HYPER_EXIT_ST || g_bHyperspaceLastFrame)
+			*AccelDisp = 0.0f;
 		return;
 	}
 
+	// Update the previous heading smoothly, otherwise the cockpit may shake a bit. The
+	// difference between the current heading and the trailing one is the inertia.
+	g_prevRs.Update(Rs, (float)dt);
+	g_prevFs.Update(Fs, (float)dt);
+	const float fLastSpeed = lastSpeed.Update(fCurSpeed, (float)dt);
+	prevT = curT;
+
 	Matrix4 HT = H;
 	HT.transpose();
 	// Multiplying the current Rs, Us, Fs with H will yield the major axes:
@@ -505,9 +623,9 @@ void ComputeInertia(const Matrix4 &H, Vector4 Rs, Vector4 Fs, float fRawCurSpeed
 	//log_debug("[DBG] X: [%0.3f, %0.3f, %0.3f], Y: [%0.3f, %0.3f, %0.3f], Z: [%0.3f, %0.3f, %0.3f]",
 	//	X.x, X.y, X.z, Y.x, Y.y, Y.z, Z.x, Z.y, Z.z);
 
-	Vector4 X = HT * g_prevRs; // --> returns something close to [1, 0, 0]
+	Vector4 X = HT * g_prevRs.Get(); // --> returns something close to [1, 0, 0]
 	//Vector4 Y = HT * g_prevUs; // --> returns something close to [0, 1, 0]
-	Vector4 Z = HT * g_prevFs; // --> returns something close to [0, 0, 1]
+	Vector4 Z = HT * g_prevFs.Get(); // --> returns something close to [0, 0, 1]
 	//log_debug("[DBG] X: [%0.3f, %0.3f, %0.3f], Y: [%0.3f, %0.3f, %0.3f], Z: [%0.3f, %0.3f, %0.3f]",
 	//	X.x, X.y, X.z, Y.x, Y.y, Y.z, Z.x, Z.y, Z.z);
 	Vector4 curRs(1, 0, 0, 0), curFs(0, 0, 1, 0);
@@ -533,16 +651,10 @@ void ComputeInertia(const Matrix4 &H, Vector4 Rs, Vector4 Fs, float fRawCurSpeed
 	g_InertiaData.push_back(inertia);
 #endif
 
-	// Update the previous heading smoothly, otherwise the cockpit may shake a bit
-	g_prevRs = 0.05f * Rs + 0.95f * g_prevRs;
-	g_prevFs = 0.05f * Fs + 0.95f * g_prevFs;
-	fLastSpeed = 0.1f * fCurSpeed + 0.9f * fLastSpeed;
-	prevT = curT;
-
 	if (g_HyperspacePhaseFSM == HS_HYPER_EXIT_ST || g_bHyperspaceLastFrame) 
 	{
 		*AccelDisp = 0.0f;
-		fLastSpeed = fCurSpeed;
+		lastSpeed.Reset(fCurSpeed);
 	}
 
 	//if (g_HyperspacePhaseFSM == HS_HYPER_ENTER_ST || g_HyperspacePhaseFSM == HS_INIT_ST)
@@ -550,35 +662,17 @@ void ComputeInertia(const Matrix4 &H, Vector4 Rs, Vector4 Fs, float fRawCurSpeed
 	//	log_debug("[%d] X/YDisp: %0.3f, %0.3f",  g_iHyperspaceFrame, *XDisp, *YDisp);
 }
 
+SmoothInertiaCurve g_SmoothInertiaCurve;
+
 /*
- * Takes a [yaw,pitch] "linear" inertia vector and returns a smooth transition between 0 at
- * the origin and 1 near the edges.
+ * Takes count [yaw,pitch] "linear" inertia vectors and returns a smooth transition between 0 at
+ * the origin and g_fExtMaxInertia near the edges. A zero vector stays zero.
  */
-void SmoothInertia(float *inout_yawInertia, float *inout_pitchInertia) 
+void SmoothInertia(float *inout_yawInertia, float *inout_pitchInertia, int count = 1)
 {
-	float yawInertia = *inout_yawInertia;
-	float pitchInertia = *inout_pitchInertia;
-
-	// First, compute the length of the inertia vector:
-	float x, L = sqrt(yawInertia * yawInertia + pitchInertia * pitchInertia);
-	// Normalize the [yawInertia, pitchInertia] vector, our vector is now unitary and lies
-	// in a circle around the origin
-	yawInertia /= L; pitchInertia /= L;
-	// Normalize the range of L between 0 and +1. We'll clamp it to 1 using smoothstep below
-	x = L / g_fExtMaxInertia;
-	// Here, I'm dividing the smoothstep graph and taking the middle point to the right
-	// so that we get a curve that starts linear and then tapers off towards 1. Formally,
-	// I should multiply x by 0.5 below, but using 0.45 makes a nicer curve. See the following
-	// link to visualize the curve we're using:
-	// https://www.iquilezles.org/apps/graphtoy/?f1(x)=2.0%20*%20clamp(smoothstep(0,%201,%20x%20*%200.45%20+%200.5)%20-%200.5,%200.0,%201.0)
-	L = g_fExtMaxInertia * 2.0f * clamp(smoothstep(0.0f, 1.0f, x * 0.45f + 0.5f) - 0.5f, 0.0, 1.0f);
-	// The length of the vector now goes from 0 to g_fExtMaxInertia smoothly and tapers off
-	// when approaching g_fExtMaxInertia. Our [yawInertia, pitchInertia] vector is still unitary
-	// so we multiply it by the smooth L to extend it back to the right range:
-	yawInertia *= L; pitchInertia *= L;
-
-	*inout_yawInertia = yawInertia;
-	*inout_pitchInertia = pitchInertia;
+	// Rebaked whenever g_fExtMaxInertia changes, which covers every config load
+	g_SmoothInertiaCurve.SetMaxInertia(g_fExtMaxInertia);
+	g_SmoothInertiaCurve.Apply(inout_yawInertia, inout_pitchInertia, count);
 }
 
 /*
@@ -663,7 +757,8 @@ float g_fPosXMultiplier = 1.666f, g_fPosYMultiplier = 1.666f, g_fPosZMultiplier
 float g_fMinPositionX = -2.50f, g_fMaxPositionX = 2.50f;
 float g_fMinPositionY = -2.50f, g_fMaxPositionY = 2.50f;
 float g_fMinPositionZ = -2.50f, g_fMaxPositionZ = 2.50f;
-HeadPos g_HeadPosAnim = { 0 };
+// Keyboard lean: g_HeadPosAnim eases towards g_HeadPosLeanTarget, which is moved by the arrow keys
+HeadPos g_HeadPosAnim = { 0 }, g_HeadPosLeanTarget = { 0 }, g_HeadPosLeanVel = { 0 };
 bool g_bLeftKeyDown = false, g_bRightKeyDown = false, g_bUpKeyDown = false, g_bDownKeyDown = false;
 bool g_bUpKeyDownShift = false, g_bDownKeyDownShift = false, g_bStickyArrowKeys = true, g_bLimitCockpitLean = true;
 bool g_bInvertCockpitLeanY = false;
@@ -672,9 +767,11 @@ bool g_bFlipYZAxes = false;
 // if true then the arrow keys will modify the cockpit camera's yaw/pitch
 // if false, then the arrow keys will perform lean right/left up/down
 bool g_bToggleKeyboardCaps = false;
-const float ANIM_INCR = 0.01f;
+// Units per second. These used to be per-frame steps of 0.01 and 0.02 at 60fps.
+float g_fLeanSpeed = 0.6f, g_fLeanResetSpeed = 1.2f;
+// Seconds it takes the head to catch up with the lean target, roughly
+float g_fLeanEaseTime = 0.1f;
 float MAX_LEAN_X = 25.0f, MAX_LEAN_Y = 25.0f, MAX_LEAN_Z = 25.0f;
-const float RESET_ANIM_INCR = 2.0f * ANIM_INCR;
 // The MAX_LEAN values will be clamped by the limits from vrparams.cfg
 
 float g_fYawInertiaMultiplier   = 100.0f;
@@ -682,74 +779,6 @@ float g_fPitchInertiaMultiplier = 100.0f;
 float g_fRollInertiaMultiplier  = 1.0f;
 float g_fAccelInertiaMultiplier = 100.0f;
 
-void animTickX(Vector3 *headPos) {
-	if (g_bRightKeyDown)
-		g_HeadPosAnim.x -= ANIM_INCR;
-	else if (g_bLeftKeyDown)
-		g_HeadPosAnim.x += ANIM_INCR;
-	else if (!g_bRightKeyDown && !g_bLeftKeyDown && !g_bStickyArrowKeys) {
-		if (g_HeadPosAnim.x < 0.0)
-			g_HeadPosAnim.x += RESET_ANIM_INCR;
-		if (g_HeadPosAnim.x > 0.0)
-			g_HeadPosAnim.x -= RESET_ANIM_INCR;
-	}
-
-	// Range clamping
-	if (g_bLimitCockpitLean) {
-		if (g_HeadPosAnim.x >  MAX_LEAN_X)  g_HeadPosAnim.x =  MAX_LEAN_X;
-		if (g_HeadPosAnim.x < -MAX_LEAN_X)  g_HeadPosAnim.x = -MAX_LEAN_X;
-	}
-
-	//headPos->x = centeredSigmoid(g_HeadPosAnim.x) * MAX_LEAN_X;
-	headPos->x = g_HeadPosAnim.x;
-}
-
-void animTickY(Vector3 *headPos) {
-	float sign = g_bInvertCockpitLeanY ? -1.0f : 1.0f;
-	if (g_bDownKeyDown)
-		g_HeadPosAnim.y +=  sign * ANIM_INCR;
-	else if (g_bUpKeyDown)
-		g_HeadPosAnim.y += -sign * ANIM_INCR;
-	else if (!g_bDownKeyDown && !g_bUpKeyDown && !g_bStickyArrowKeys) {
-		if (g_HeadPosAnim.y < 0.0)
-			g_HeadPosAnim.y += RESET_ANIM_INCR;
-		if (g_HeadPosAnim.y > 0.0)
-			g_HeadPosAnim.y -= RESET_ANIM_INCR;
-	}
-
-	// Range clamping
-	if (g_bLimitCockpitLean) {
-		if (g_HeadPosAnim.y >  MAX_LEAN_Y)  g_HeadPosAnim.y =  MAX_LEAN_Y;
-		if (g_HeadPosAnim.y < -MAX_LEAN_Y)  g_HeadPosAnim.y = -MAX_LEAN_Y;
-	}
-
-	//headPos->y = centeredSigmoid(g_HeadPosAnim.y) * MAX_LEAN_Y;
-	headPos->y = g_HeadPosAnim.y;
-}
-
-void animTickZ(Vector3 *headPos) {
-	if (g_bDownKeyDownShift)
-		g_HeadPosAnim.z -= ANIM_INCR;
-	else if (g_bUpKeyDownShift)
-		g_HeadPosAnim.z += ANIM_INCR;
-	else if (!g_bDownKeyDownShift && !g_bUpKeyDownShift && !g_bStickyArrowKeys) {
-		if (g_HeadPosAnim.z < 0.0)
-			g_HeadPosAnim.z += RESET_ANIM_INCR;
-		if (g_HeadPosAnim.z > 0.0 /* 0.0001 */)
-			g_HeadPosAnim.z -= RESET_ANIM_INCR;
-	}
-
-	// Range clamping
-	if (g_bLimitCockpitLean) {
-		if (g_HeadPosAnim.z >  MAX_LEAN_Z)  g_HeadPosAnim.z =  MAX_LEAN_Z;
-		if (g_HeadPosAnim.z < -MAX_LEAN_Z)  g_HeadPosAnim.z = -MAX_LEAN_Z;
-	}
-
-	//headPos->z = centeredSigmoid(g_HeadPosAnim.z) * MAX_LEAN_Z;
-	headPos->z = g_HeadPosAnim.z;
-	headPos->z = -headPos->z; // The z-axis is inverted in XWA w.r.t. the original view-centric definition
-}
-
 void DumpDebugInfo(int playerIndex) {
 	static int counter = 0;
 	FILE *filePD = NULL, *fileCI = NULL;
@@ -946,6 +975,183 @@ void DumpDebugInfo(int playerIndex) {
 	*/
 }
 
+/*
+ * Device adapters for the tracker sampler. These can run either on the sampler thread or
+ * directly in UpdateTrackingData() when the sampler is disabled.
+ */
+bool ReadFreePIESample(TrackerSample *sample)
+{
+	// A slot that hasn't changed since the last read keeps the timestamp of that read, so
+	// the filter and predictor don't see a stationary head in between two FreePIE updates.
+	static unsigned int lastGeneration = 0;
+	static TrackerSample lastSample;
+
+	// The sampler thread reads at its own pace, it can't use the per-frame cache
+	if (IsTrackerSamplerRunning())
+		InvalidateFreePIECache();
+	if (!ReadFreePIE(g_iFreePIESlot)) {
+		lastSample.valid = false;
+		return false;
+	}
+	const unsigned int generation = GetFreePIESlotGeneration(g_iFreePIESlot);
+	if (lastSample.valid && generation == lastGeneration) {
+		*sample = lastSample;
+		return true;
+	}
+	sample->yaw   = g_FreePIEData.yaw;
+	sample->pitch = g_FreePIEData.pitch;
+	sample->roll  = g_FreePIEData.roll;
+	sample->x     = g_FreePIEData.x;
+	sample->y     = g_FreePIEData.y;
+	sample->z     = g_FreePIEData.z;
+	lastGeneration = generation;
+	lastSample = *sample;
+	lastSample.valid = true;
+	return true;
+}
+
+bool ReadTrackIRSample(TrackerSample *sample)
+{
+	// NPClient returns the same frame until a new one arrives (120 Hz on a TrackIR 5), so at
+	// high frame rates most reads are repeats. A repeated frame keeps the timestamp of its
+	// first read; that's how the filter, interpolator and predictor know it's not new data.
+	static unsigned short lastSignature = 0;
+	static TrackerSample lastSample;
+
+	// TrackIR may still be loading (or may have been unloaded with Alt+T)
+	if (!g_bTrackIRLoaded)
+		return false;
+	unsigned short signature;
+	sample->roll = 0.0f;
+	if (!ReadTrackIRData(&sample->yaw, &sample->pitch, &sample->x, &sample->y, &sample->z, &signature)) {
+		lastSample.valid = false;
+		return false;
+	}
+	if (lastSample.valid && signature == lastSignature) {
+		*sample = lastSample;
+		return true;
+	}
+	lastSignature = signature;
+	lastSample = *sample;
+	lastSample.valid = true;
+	return true;
+}
+
+bool ReadSteamVRSample(TrackerSample *sample)
+{
+	float yaw, pitch, roll;
+	Quaternion rotation;
+	if (!GetSteamVRPositionalData(&yaw, &pitch, &roll, &sample->x, &sample->y, &sample->z, &rotation))
+		return false;
+	// Use the same angles as FreePIE, so that Update6DOFTracker() rebuilds this rotation
+	rotation.toYawPitchRoll(&yaw, &pitch, &roll);
+	sample->yaw   = -yaw;
+	sample->pitch = -pitch;
+	sample->roll  =  roll;
+	return true;
+}
+
+/*
+ * Sources of the Fusion tracker. The samples of every source are converted to the FreePIE
+ * conventions (degrees, meters) before they're fused, which is what Update6DOFTracker() expects.
+ */
+typedef struct FusionSourceStruct {
+	TrackerReadFun ReadSample;
+	float yawSign, pitchSign, rollSign;
+	float scaleX, scaleY, scaleZ;
+} FusionSource;
+
+// Indexed by TrackerType
+const FusionSource g_FusionSources[] = {
+	{ NULL,                 1.0f, 1.0f, 1.0f,  1.0f,    1.0f,    1.0f    }, // TRACKER_NONE
+	{ ReadFreePIESample,    1.0f, 1.0f, 1.0f,  1.0f,    1.0f,    1.0f    }, // TRACKER_FREEPIE
+	{ ReadSteamVRSample,    1.0f, 1.0f, 1.0f,  1.0f,    1.0f,    1.0f    }, // TRACKER_STEAMVR
+	{ ReadTrackIRSample,   -1.0f, 1.0f, 0.0f, -0.0002f, 0.0002f, 0.0002f }, // TRACKER_TRACKIR
+	{ ReadOpenTrackSample,  1.0f, 1.0f, 1.0f,  0.01f,   0.01f,   0.01f   }, // TRACKER_OPENTRACK
+	{ NULL,                 1.0f, 1.0f, 1.0f,  1.0f,    1.0f,    1.0f    }, // TRACKER_FUSION
+};
+
+static bool ReadFusionSource(TrackerType source, LONGLONG now, TrackerSample *sample)
+{
+	const FusionSource &src = g_FusionSources[source];
+	if (src.ReadSample == NULL)
+		return false;
+	sample->timestamp = now;
+	sample->valid = src.ReadSample(sample);
+	if (!sample->valid)
+		return false;
+	sample->yaw   *= src.yawSign;
+	sample->pitch *= src.pitchSign;
+	sample->roll  *= src.rollSign;
+	sample->x *= src.scaleX;
+	sample->y *= src.scaleY;
+	sample->z *= src.scaleZ;
+	return true;
+}
+
+bool ReadFusedSample(TrackerSample *sample)
+{
+	const LONGLONG now = sample->timestamp;
+	TrackerSample rot, pos;
+	if (ReadFusionSource(g_FusionRotationSource, now, &rot))
+		g_PoseFusion.rotation.Add(rot);
+	if (g_FusionPositionSource == g_FusionRotationSource)
+		g_PoseFusion.position.Add(rot);
+	else if (ReadFusionSource(g_FusionPositionSource, now, &pos))
+		g_PoseFusion.position.Add(pos);
+	return g_PoseFusion.Fuse(now, sample);
+}
+
+/*
+ * Returns the newest sample for the current tracker. If the sampler thread is running, this
+ * only copies the last sample it published; otherwise, the device is read right here.
+ * The sample is smoothed first (if the filter is enabled), resampled at the current frame
+ * time (TrackIR interpolation) and then, when pose prediction is enabled, extrapolated to the
+ * expected display time: FreePIE and TrackIR don't do any prediction on their side.
+ * Filtering before predicting keeps the jitter out of the velocity estimate.
+ */
+bool ReadTrackerSample(TrackerReadFun readFun, TrackerSample *sample)
+{
+	if (IsTrackerReplayLoaded()) {
+		sample->valid = ReadTrackerReplaySample(sample);
+	}
+	else if (IsTrackerSamplerRunning()) {
+		// The sampler thread records its own samples
+		if (!GetLatestTrackerSample(sample))
+			sample->valid = false;
+	}
+	else {
+		sample->timestamp = GetQPCTime();
+		// The device may still be coming up in the background
+		sample->valid = false;
+		if (BeginTrackerDeviceRead()) {
+			sample->valid = readFun(sample);
+			EndTrackerDeviceRead();
+		}
+		RecordTrackerSample(*sample);
+	}
+
+	// Fill short losses before anything else, so the later stages see a continuous signal
+	if (g_bPoseDropoutEnabled)
+		g_PoseDropout.Apply(GetQPCTime(), sample);
+
+	if (g_bPoseFilterEnabled)
+		g_PoseFilter.Apply(sample);
+
+	if (g_bPoseInterpolationEnabled) {
+		g_PoseInterpolator.AddSample(*sample);
+		if (sample->valid)
+			g_PoseInterpolator.Sample(GetQPCTime(), sample);
+	}
+
+	if (g_bPosePredictionEnabled) {
+		g_PosePredictor.AddSample(*sample);
+		if (sample->valid)
+			g_PosePredictor.Predict(GetQPCTime(), sample);
+	}
+	return sample->valid;
+}
+
 void ProcessKeyboard(int playerIndex, __int16 keycodePressed) {
 	static bool bLastIKeyState = false, bLastJKeyState = false, bLastXKeyState = false, bLastTKeyState = false, bLastUKeyState = false;
 	static bool bCurIKeyState = false, bCurJKeyState = false, bCurXKeyState = false, bCurTKeyState = false, bCurUKeyState = false;
@@ -984,7 +1190,21 @@ void ProcessKeyboard(int playerIndex, __int16 keycodePressed) {
 	if (g_bCtrl && bLastJKeyState && !bCurJKeyState)
 	{
 		log_debug("*********** RELOADING CockpitLookHook.cfg ***********");
+		// The sampler thread reads the fusion state and settings that LoadParams() resets
+		const TrackerDeviceConfig oldDevice = GetRequestedTrackerDevice();
+		PauseTrackerSampler();
+		// YawVR only connects at startup, keep whatever state it's in
+		const bool bYawVREnabled = YawVR::bEnabled;
 		LoadParams();
+		YawVR::bEnabled = bYawVREnabled;
+		// Switch devices in the background if the tracker (or its settings) changed
+		bool bSameDevice = true;
+		if (!g_bTrackerReplay) {
+			const TrackerDeviceConfig newDevice = GetTrackerDeviceConfig();
+			bSameDevice = newDevice == oldDevice;
+			RequestTrackerDevice(newDevice);
+		}
+		ResumeTrackerSampler(bSameDevice);
 	}
 
 	if (g_TrackerType == TRACKER_STEAMVR && (bLastPeriodKeyState && !bCurPeriodKeyState)) {
@@ -997,18 +1217,18 @@ void ProcessKeyboard(int playerIndex, __int16 keycodePressed) {
 	}
 
 	// Alt+T: Reload TrackIR
-	if (g_TrackerType == TRACKER_TRACKIR)
+	if (g_TrackerType == TRACKER_TRACKIR && !g_bTrackerReplay)
 	{
 		if (g_bAlt && bLastTKeyState && !bCurTKeyState) {
-			if (g_bTrackIRLoaded) {
+			// The device manager does the actual (un)loading, off the game thread
+			if (GetRequestedTrackerDevice().device == TRACKER_TRACKIR) {
 				log_debug("Unloading TrackIR");
-				ShutdownTrackIR();
+				RequestTrackerDevice(TrackerDeviceConfig());
 			}
 			else {
 				log_debug("Reloading TrackIR");
-				InitTrackIR();
+				RequestTrackerDevice(GetTrackerDeviceConfig());
 			}
-			g_bTrackIRLoaded = !g_bTrackIRLoaded;
 		}
 	}
 
@@ -1059,21 +1279,416 @@ void ProcessKeyboard(int playerIndex, __int16 keycodePressed) {
 	//log_debug("keycode: 0x%X, ACS: %d,%d,%d", keycodePressed, *s_XwaIsAltKeyPressed, *s_XwaIsControlKeyPressed, *s_XwaIsShiftKeyPressed);
 }
 
+void ResetCockpitLean()
+{
+	g_HeadPosAnim = { 0 };
+	g_HeadPosLeanTarget = { 0 };
+	g_HeadPosLeanVel = { 0 };
+}
+
 /*
  * Update headPos using the keyboard
  */
 void ComputeCockpitLean(Vector3 *headPos)
 {
-	if (g_bResetHeadCenter) {
-		g_HeadPosAnim = { 0 };
+	// Longer frames than this (after a pause, for instance) don't move the lean any further
+	constexpr double MAX_LEAN_DT = 0.1;
+	static LONGLONG prevT = 0;
+	const LONGLONG curT = GetQPCTime();
+	double dt = prevT != 0 ? QPCToSeconds(curT - prevT) : 0.0;
+	if (dt > MAX_LEAN_DT) dt = MAX_LEAN_DT;
+	prevT = curT;
+
+	if (g_bResetHeadCenter)
+		ResetCockpitLean();
+
+	// Perform the lean left/right etc animations
+	const int ySign = g_bInvertCockpitLeanY ? -1 : 1;
+	const int dirX = g_bRightKeyDown ? -1 : g_bLeftKeyDown ? 1 : 0;
+	const int dirY = g_bDownKeyDown ? ySign : g_bUpKeyDown ? -ySign : 0;
+	const int dirZ = g_bDownKeyDownShift ? -1 : g_bUpKeyDownShift ? 1 : 0;
+	const LeanAnimSettings lean = { g_fLeanSpeed, g_fLeanResetSpeed, g_fLeanEaseTime, g_bStickyArrowKeys, g_bLimitCockpitLean };
+	LeanAnimTick(&g_HeadPosAnim.x, &g_HeadPosLeanVel.x, &g_HeadPosLeanTarget.x, dirX, MAX_LEAN_X, (float)dt, lean);
+	LeanAnimTick(&g_HeadPosAnim.y, &g_HeadPosLeanVel.y, &g_HeadPosLeanTarget.y, dirY, MAX_LEAN_Y, (float)dt, lean);
+	LeanAnimTick(&g_HeadPosAnim.z, &g_HeadPosLeanVel.z, &g_HeadPosLeanTarget.z, dirZ, MAX_LEAN_Z, (float)dt, lean);
+
+	headPos->x = g_HeadPosAnim.x;
+	headPos->y = g_HeadPosAnim.y;
+	headPos->z = -g_HeadPosAnim.z; // The z-axis is inverted in XWA w.r.t. the original view-centric definition
+}
+
+/*
+ * Applies the keyboard lean to g_headPosFromKeyboard. Used by the trackers that add the lean
+ * on top of the tracked position.
+ */
+void UpdateKeyboardLean()
+{
+	if (g_bKeyboardLean) {
+		ComputeCockpitLean(&g_headPosFromKeyboard);
+		g_headPosFromKeyboard = -g_headPosFromKeyboard;
 	}
+	else
+		g_headPosFromKeyboard.set(0, 0, 0);
+}
+
+/*
+ * Computes this frame's inertia. While in hyperspace, the heading from before the jump is used.
+ */
+void ComputeFrameInertia(int playerIndex, float *XDisp, float *YDisp, float *ZDisp, float *AccelDisp)
+{
+	if (g_bInHyperspace)
+		ComputeInertia(g_prevHeadingMatrix, g_LastRsBeforeHyperspace, g_LastFsBeforeHyperspace, g_fLastSpeedBeforeHyperspace, playerIndex,
+			XDisp, YDisp, ZDisp, AccelDisp);
+	else {
+		Vector4 Rs, Us, Fs;
+		Matrix4 HeadingMatrix = GetCurrentHeadingMatrix(playerIndex, Rs, Us, Fs, true);
+		ComputeInertia(HeadingMatrix, Rs, Fs, (float)PlayerDataTable[playerIndex].currentSpeed, playerIndex,
+			XDisp, YDisp, ZDisp, AccelDisp);
+	}
+}
+
+/*
+ * Per-frame output of a tracker. The shared post-processing in UpdateTrackingData() takes it
+ * from here.
+ */
+typedef struct TrackerFrameStruct {
+	// Raw angles and position, in device units. g_TrackerTransform converts them.
+	float yaw, pitch, roll;
+	Vector4 pos;
+	// Gunner turret rotation, applied in the middle of the position transform
+	Matrix4 turret;
+	bool bTurret;
+	// When the pose was sampled, if the tracker knows it. 0 means now.
+	LONGLONG timestamp;
+	// true if the offsets, position multipliers/limits and cockpit inertia must be applied
+	bool dataReady;
+	// false if the tracker is connected but off: the yaw/pitch must not be written then
+	bool enableTrackedYawPitch;
+	// Inertia computed for this frame. The external camera uses it later.
+	float yawInertia, pitchInertia, distInertia;
+} TrackerFrame;
+
+/*
+ * Applies the POV offset and the cockpit inertia to g_headPos.
+ */
+void ApplyCockpitInertia(int playerIndex, TrackerFrame *frame)
+{
+	if (!g_bCockpitInertiaEnabled && !g_bExtInertiaEnabled)
+		return;
+
+	float XDisp = 0.0f, YDisp = 0.0f, ZDisp = 0.0f, AccelDisp = 0.0f;
+	ComputeFrameInertia(playerIndex, &XDisp, &YDisp, &ZDisp, &AccelDisp);
+	// Apply the current POVOffset
+	g_headPos.x += g_SharedData->POVOffsetX;
+	g_headPos.y += g_SharedData->POVOffsetY;
+	g_headPos.z += g_SharedData->POVOffsetZ;
+	// Apply inertia:
+	if (g_bCockpitInertiaEnabled) {
+		g_headPos.x += XDisp;
+		g_headPos.y += YDisp;
+		g_headPos.z += AccelDisp;
+		g_rollInertia = ZDisp;
+	}
+
+	frame->yawInertia = XDisp; frame->pitchInertia = YDisp; frame->distInertia = AccelDisp;
+}
+
+void UpdateNoTracker(int playerIndex, TrackerFrame *frame)
+{
+	Vector3 headPos;
+	static float fake_yaw = 0.0f, fake_pitch = 0.0f;
+
+	if (g_bResetHeadCenter) 
+	{
+		fake_yaw = fake_pitch = 0.0f;
+		g_headCenter[0] = 0.0f;
+		g_headCenter[1] = 0.0f;
+		g_headCenter[2] = 0.0f;
+		ResetCockpitLean();
+	}
+
+	if (!g_bToggleKeyboardCaps) {
+		ComputeCockpitLean(&headPos);
+		headPos = -headPos;
+		
+		g_headCenter.x = headPos.x;
+		g_headCenter.y = headPos.y;
+		g_headCenter.z = headPos.z;
+	} else {
+		if (g_bKeyboardLook) {
+			if (g_bLeftKeyDown)  fake_yaw -= 1.0f;
+			if (g_bRightKeyDown) fake_yaw += 1.0f;
+			if (g_bDownKeyDown)  fake_pitch -= 1.0f;
+			if (g_bUpKeyDown)	 fake_pitch += 1.0f;
+		}
+	}
+
+	if (g_bKeyboardLook) {
+		frame->yaw   = fake_yaw;
+		frame->pitch = fake_pitch;
+	}
+
+	if (g_bKeyboardLean)
+		g_headPos = g_headCenter;
+	else
+		g_headPos.set(0, 0, 0, 0);
+	frame->pos = g_headPos;
 	
-	// Perform the lean left/right etc animations
-	animTickX(headPos);
-	animTickY(headPos);
-	animTickZ(headPos);
+	// Mouse Look is enabled, apply the head's position right here
+	if (*mouseLook && !*inMissionFilmState && !*viewingFilmState) {
+		ApplyCockpitInertia(playerIndex, frame);
+		frame->dataReady = false;
+	} 
+	else if (!*mouseLook) {
+		// If mouse look is disabled, then change the orientation and position of the camera
+		// using the regular path -- but only if the internal keyboard override is set! Otherwise
+		// we'll break the Joystick POV hat/Keypad look!
+		if (g_bKeyboardLook)
+			frame->dataReady = true;
+		else
+			// mouseLook is off and keyboardlook is disabled, apply cockpit inertia here.
+			ApplyCockpitInertia(playerIndex, frame);
+	}
+
+	// Debug: Write the fake yaw/pitch and cockpit lean to FreePIE to fake a headset
+	if (g_FreePIEOutputSlot > -1) {
+		g_FreePIEData.yaw   = fake_yaw;
+		g_FreePIEData.pitch = fake_pitch;
+		g_FreePIEData.roll  = 0.0f;
+		g_FreePIEData.x =  g_headPos.x;
+		g_FreePIEData.y =  g_headPos.y;
+		g_FreePIEData.z = -g_headPos.z;
+		WriteFreePIE(g_FreePIEOutputSlot);
+	}
+}
+
+/*
+ * Shared by the trackers that report a full 6DOF pose in degrees and some unit of length.
+ * The units of the position are handled by g_TrackerTransform.
+ */
+void Update6DOFTracker(int playerIndex, TrackerFrame *frame, TrackerReadFun readFun)
+{
+	TrackerSample sample;
+	if (!ReadTrackerSample(readFun, &sample))
+		return;
+
+	frame->pos.set(sample.x, sample.y, sample.z, 1.0f);
+	frame->timestamp = sample.timestamp;
+	if (g_bResetHeadCenter) {
+		g_headRotationHome.y = sample.yaw;
+		g_headRotationHome.x = sample.pitch;
+		g_headRotationHome.z = sample.roll;
+		g_TrackerTransform.SetCenter(frame->pos);
+		g_PoseDropout.SetHome(sample);
+	}
+	const float yaw   = sample.yaw   - g_headRotationHome.y;
+	const float pitch = sample.pitch - g_headRotationHome.x;
+	const float roll  = sample.roll  - g_headRotationHome.z;
+	frame->yaw   = yaw;
+	frame->pitch = pitch;
+	frame->roll  = roll;
+
+	// The rotation is built once, as a quaternion, and stays one until DoRotationPitchHook()
+	// writes it to the camera. Roll goes last in the chain, so you can roll your head no
+	// matter where you're looking at. The multipliers are applied to the rotation vector
+	// rather than to the Euler angles, unless there are response curves: those work on the
+	// angles, and the rotation must match the angles UpdateTrackingData() exports.
+	Quaternion rotation;
+	if (g_bYawPitchFromMouseOverride) {
+		// If FreePIE could not be read, then get the yaw/pitch from the mouse:
+		frame->yaw   =  (float)PlayerDataTable[playerIndex].MousePositionX / 32768.0f * 180.0f;
+		frame->pitch = -(float)PlayerDataTable[playerIndex].MousePositionY / 32768.0f * 180.0f;
+		// CompileTrackerTransform() leaves the yaw/pitch unscaled and uncurved in this case
+		float curvedYaw = frame->yaw, curvedPitch = frame->pitch, curvedRoll = roll;
+		g_TrackerTransform.ApplyCurves(&curvedYaw, &curvedPitch, &curvedRoll);
+		rotation = Quaternion::FromYawPitchRoll(-curvedYaw, -curvedPitch, curvedRoll);
+	}
+	else if (g_TrackerTransform.HasCurves()) {
+		float curvedYaw = yaw, curvedPitch = pitch, curvedRoll = roll;
+		g_TrackerTransform.ApplyCurves(&curvedYaw, &curvedPitch, &curvedRoll);
+		rotation = Quaternion::FromYawPitchRoll(-curvedYaw, -curvedPitch, curvedRoll);
+	}
+	else {
+		rotation = Quaternion::FromYawPitchRoll(-yaw, -pitch, roll);
+		if (g_fYawMultiplier != 1.0f || g_fPitchMultiplier != 1.0f || g_fRollMultiplier != 1.0f)
+			rotation = rotation.scaled(g_fPitchMultiplier, g_fYawMultiplier, g_fRollMultiplier);
+	}
+	g_headRotation = g_headOffsetRotation.isIdentity() ? rotation : g_headOffsetRotation * rotation;
+	frame->dataReady = true;
+}
+
+void UpdateFreePIETracker(int playerIndex, TrackerFrame *frame)
+{
+	Update6DOFTracker(playerIndex, frame, ReadFreePIESample);
+}
+
+void UpdateOpenTrackTracker(int playerIndex, TrackerFrame *frame)
+{
+	Update6DOFTracker(playerIndex, frame, ReadOpenTrackSample);
+}
+
+void UpdateFusionTracker(int playerIndex, TrackerFrame *frame)
+{
+	Update6DOFTracker(playerIndex, frame, ReadFusedSample);
+}
+
+void UpdateSteamVRTracker(int playerIndex, TrackerFrame *frame)
+{
+	float yaw = 0, pitch = 0, roll = 0, x = 0, y = 0, z = 0;
+	bool bFreePIERead = false;
+
+	// SteamVR is brought up by the device manager; until then, there's no data
+	frame->dataReady = false;
+	if (BeginTrackerDeviceRead()) {
+		frame->dataReady = GetSteamVRPositionalData(&yaw, &pitch, &roll, &x, &y, &z, &g_headRotation);
+
+		// HACK ALERT: I'm reading the positional tracking data from FreePIE when
+		// running SteamVR because setting up the PSMoveServiceSteamVRBridge is kind
+		// of... tricky; and I'm not going to bother right now since PSMoveService
+		// already works very well for me.
+		// Read the positional data from FreePIE if the right flag is set
+		if (g_bSteamVRPosFromFreePIE) {
+			bFreePIERead = ReadFreePIE(g_iFreePIESlot);
+			x = g_FreePIEData.x;
+			y = g_FreePIEData.y;
+			z = g_FreePIEData.z;
+		}
+		EndTrackerDeviceRead();
+	}
+
+	if (IsTrackerCaptureActive()) {
+		// Replaying SteamVR isn't supported, but the capture is still useful to look at
+		TrackerSample sample;
+		sample.timestamp = GetQPCTime();
+		sample.yaw = yaw; sample.pitch = pitch; sample.roll = roll;
+		sample.x = x; sample.y = y; sample.z = z;
+		sample.valid = frame->dataReady;
+		RecordTrackerSample(sample);
+	}
+
+	// SteamVR keeps the last rotation when the pose is lost; this makes it coast and then
+	// blend back in instead. The rotation goes through the same angles FreePIE uses.
+	if (g_bPoseDropoutEnabled) {
+		TrackerSample sample;
+		sample.timestamp = GetQPCTime();
+		g_headRotation.toYawPitchRoll(&sample.yaw, &sample.pitch, &sample.roll);
+		sample.x = x; sample.y = y; sample.z = z;
+		sample.valid = frame->dataReady;
+		if (g_PoseDropout.Apply(sample.timestamp, &sample)) {
+			g_headRotation = Quaternion::FromYawPitchRoll(sample.yaw, sample.pitch, sample.roll);
+			// The reported angles follow the coasted rotation, in SteamVR's radians
+			GetSteamVREulerAngles(g_headRotation, &yaw, &pitch, &roll);
+			// The position from FreePIE is still good
+			if (!g_bSteamVRPosFromFreePIE) {
+				x = sample.x; y = sample.y; z = sample.z;
+			}
+			frame->dataReady = true;
+		}
+	}
+
+	// SteamVR already smooths its rotation, so only the position goes through
+	// the filter (this also covers the position coming from FreePIE).
+	if (g_bPoseFilterEnabled) {
+		TrackerSample sample;
+		sample.timestamp = GetQPCTime();
+		sample.x = x; sample.y = y; sample.z = z;
+		sample.valid = g_bSteamVRPosFromFreePIE ? bFreePIERead : frame->dataReady;
+		g_PoseFilter.Apply(&sample);
+		if (sample.valid) {
+			x = sample.x; y = sample.y; z = sample.z;
+		}
+	}
+
+	// The angles are in radians, g_TrackerTransform takes care of that
+	frame->yaw   = yaw;
+	frame->pitch = pitch;
+	frame->roll  = roll;
+	frame->pos.set(x, y, z, 1.0f);
+	if (g_bResetHeadCenter) {
+		g_TrackerTransform.SetCenter(frame->pos);
+		TrackerSample home;
+		home.x = x; home.y = y; home.z = z;
+		g_PoseDropout.SetHome(home);
+	}
+
+	if (PlayerDataTable[*localPlayerIndex].gunnerTurretActive) {
+		GetGunnerTurretMatrix(&frame->turret);
+		frame->bTurret = true;
+	}
+}
+
+void UpdateTrackIRTracker(int playerIndex, TrackerFrame *frame)
+{
+	/*
+	 * TrackIR is a bit special. If TrackIR is installed; but turned off, then
+	 * ReadTrackIRData will return false; but if we want to apply cockpit inertia
+	 * then we need to set dataReady = true. However, setting dataReady = true will
+	 * also write the yaw/pitch, which will disable the POV/Keypad when TrackIR is
+	 * off. So, we need another flag (enableTrackedYawPitch) to prevent writing to
+	 * yaw/pitch; but allow writing to cockpitX/Y/ZReference.
+	 * If TrackIR is on, we allow writing to yaw/pitch and cockpitX/Y/ZReference.
+	 * This will disable the POV hat; but you probably don't need it if you're using
+	 * your head to look around.
+	 */
+	if (g_bGlobalDebug) log_debug("[TrackIR] Reading TrackIR data");
+	TrackerSample sample;
+	if (ReadTrackerSample(ReadTrackIRSample, &sample)) {
+		if (g_bGlobalDebug) log_debug("[TrackIR] Data read, (%0.3f, %0.3f), (%0.3f, %0.3f, %0.3f)",
+			sample.yaw, sample.pitch, sample.x, sample.y, sample.z);
+		// The signs, scale and axes are handled by g_TrackerTransform
+		frame->yaw   = sample.yaw;
+		frame->pitch = sample.pitch;
+		frame->roll  = 0;
+		frame->pos.set(sample.x, sample.y, sample.z, 1.0f);
+		frame->timestamp = sample.timestamp;
+
+		if (g_bResetHeadCenter) {
+			g_TrackerTransform.SetCenter(frame->pos);
+			// TrackIR centers its own rotation, only the position has a home here
+			TrackerSample home;
+			home.x = sample.x; home.y = sample.y; home.z = sample.z;
+			g_PoseDropout.SetHome(home);
+		}
+		frame->enableTrackedYawPitch = true;
+	}
+	else {
+		if (g_bGlobalDebug) log_debug("[TrackIR] Data read failed. Centering the head");
+		frame->pos = g_TrackerTransform.GetCenter();
+		frame->enableTrackedYawPitch = false;
+	}
+	frame->dataReady = true;
 }
 
+/*
+ * Everything UpdateTrackingData() needs to know about a tracker. The entry for the current
+ * tracker is looked up once, in LoadParams(), so the per-frame path doesn't have to switch
+ * on the tracker type.
+ */
+typedef void (*TrackerUpdateFun)(int playerIndex, TrackerFrame *frame);
+typedef struct TrackerInterfaceStruct {
+	// Reads the device (including recentering, when requested) and fills a TrackerFrame
+	TrackerUpdateFun Update;
+	// Raw device read used by the sampler thread, NULL if this tracker can't be sampled
+	TrackerReadFun ReadSample;
+	// Add the keyboard lean to the tracked position
+	bool bKeyboardLean;
+	// Write the head's yaw/pitch to the mouse position instead of keeping the reticle fixed
+	bool bMousePositionFromHead;
+	// Apply g_headRotation directly to the camera matrix in DoRotationPitchHook()
+	bool bInjectRotation;
+} TrackerInterface;
+
+// Indexed by TrackerType
+const TrackerInterface g_Trackers[] = {
+	{ UpdateNoTracker,        NULL,                false, false, false }, // TRACKER_NONE
+	{ UpdateFreePIETracker,   ReadFreePIESample,   true,  false, true  }, // TRACKER_FREEPIE
+	{ UpdateSteamVRTracker,   NULL,                true,  false, true  }, // TRACKER_STEAMVR
+	{ UpdateTrackIRTracker,   ReadTrackIRSample,   true,  true,  false }, // TRACKER_TRACKIR
+	{ UpdateOpenTrackTracker, ReadOpenTrackSample, true,  false, true  }, // TRACKER_OPENTRACK
+	{ UpdateFusionTracker,    ReadFusedSample,     true,  false, true  }, // TRACKER_FUSION
+};
+const TrackerInterface *g_pTracker = &g_Trackers[TRACKER_NONE];
+
 /*******************************************************************/
 
 /*
@@ -1092,13 +1707,62 @@ Params[-15] = EBP
 */
 
 //int CockpitLookHook(int* params)
+/*
+ * Adds the head's pose for this frame to the shared pose history, in the same units as the
+ * rest of the shared CockpitLook data.
+ */
+void PublishTrackingFrame(const TrackerFrame &frame)
+{
+	SharedHeadPose pose;
+	pose.timestamp = GetQPCTime();
+	pose.sampleTimestamp = frame.timestamp != 0 ? frame.timestamp : pose.timestamp;
+	pose.frameId = g_FrameClock.GetFrameId();
+	pose.source = g_TrackerType;
+	pose.Yaw   = g_headYaw;
+	pose.Pitch = g_headPitch;
+	pose.Roll  = g_headRoll;
+	pose.X = g_fXWAUnitsToMetersScale * g_headPos.x;
+	pose.Y = g_fXWAUnitsToMetersScale * g_headPos.y;
+	pose.Z = g_fXWAUnitsToMetersScale * g_headPos.z;
+	pose.qx = g_headRotation.x;
+	pose.qy = g_headRotation.y;
+	pose.qz = g_headRotation.z;
+	pose.qw = g_headRotation.w;
+	PublishHeadPose(pose);
+}
+
+/*
+ * Sends the noise measured by the pose filter to the telemetry and, every now and then,
+ * to the log along with the cutoffs it picked.
+ */
+void ReportPoseNoise()
+{
+	static LONGLONG lastLogTime = 0;
+	if (!g_bPoseFilterEnabled)
+		return;
+
+	g_PlayerTelemetry.yawNoise   = g_PoseFilter.GetNoise(POSE_AXIS_YAW);
+	g_PlayerTelemetry.pitchNoise = g_PoseFilter.GetNoise(POSE_AXIS_PITCH);
+	g_PlayerTelemetry.rollNoise  = g_PoseFilter.GetNoise(POSE_AXIS_ROLL);
+	g_PlayerTelemetry.posNoise   = max(g_PoseFilter.GetNoise(POSE_AXIS_X),
+		max(g_PoseFilter.GetNoise(POSE_AXIS_Y), g_PoseFilter.GetNoise(POSE_AXIS_Z)));
+
+	const LONGLONG now = GetQPCTime();
+	if (lastLogTime != 0 && QPCToSeconds(now - lastLogTime) < POSE_NOISE_LOG_INTERVAL)
+		return;
+	lastLogTime = now;
+	log_debug("[Filter] Noise ypr: %0.4f, %0.4f, %0.4f, xyz: %0.5f, %0.5f, %0.5f",
+		g_PoseFilter.GetNoise(POSE_AXIS_YAW), g_PoseFilter.GetNoise(POSE_AXIS_PITCH), g_PoseFilter.GetNoise(POSE_AXIS_ROLL),
+		g_PoseFilter.GetNoise(POSE_AXIS_X), g_PoseFilter.GetNoise(POSE_AXIS_Y), g_PoseFilter.GetNoise(POSE_AXIS_Z));
+	log_debug("[Filter] Cutoffs ypr: %0.2f, %0.2f, %0.2f, xyz: %0.2f, %0.2f, %0.2f",
+		g_PoseFilter.GetCutoff(POSE_AXIS_YAW), g_PoseFilter.GetCutoff(POSE_AXIS_PITCH), g_PoseFilter.GetCutoff(POSE_AXIS_ROLL),
+		g_PoseFilter.GetCutoff(POSE_AXIS_X), g_PoseFilter.GetCutoff(POSE_AXIS_Y), g_PoseFilter.GetCutoff(POSE_AXIS_Z));
+}
+
 int UpdateTrackingData()
 {
 	//int playerIndex = params[-10]; // Using -10 instead of -6, prevents this hook from crashing in Multiplayer
 	const int playerIndex = * (int *)0x8C1CC8;
-	float yaw = 0.0f, pitch = 0.0f, roll = 0.0f;
-	float yawSign = 1.0f, pitchSign = 1.0f;
-	bool dataReady = false, enableTrackedYawPitch = true;
 	const bool bExternalCamera = PlayerDataTable[playerIndex].Camera.ExternalCamera;
 	static bool bLastExternalCamera = bExternalCamera;
 	static short lastCameraYaw = 0, lastCameraPitch = 0; // These are the pre-inertia values from the last frame
@@ -1114,18 +1778,36 @@ int UpdateTrackingData()
 
 	//log_debug("UpdateTrackingData() executed");
 
-	// For some reason, TrackIR won't load if the game is run from the launcher. So, let's
-	// try to reload TrackIR here.
-	if (g_TrackerType == TRACKER_TRACKIR) {
-		static int TrackIRRetries = 3;
-		if (TrackIRRetries > 0 && !g_bTrackIRLoaded) {
-			log_debug("TrackIR wasn't loaded, retrying...");
-			g_bTrackIRLoaded = InitTrackIR();
-			TrackIRRetries--;
-		}
+	// Nothing to do until cockpitlook.cfg has been loaded in the background
+	if (!IsConfigLoaded())
+		return 0;
+
+	// Several camera hooks lead here. Reading the tracker, stepping the inertia and sending the
+	// telemetry more than once per frame would speed all of them up, so with the gate enabled,
+	// later calls in the same frame leave the camera as the first one set it. The map hook and
+	// the regular hooks are gated separately: the external camera work below only happens
+	// outside of the map hook, and must not be skipped because the map hook came first.
+	static bool bRegularCallThisFrame = false, bMapCallThisFrame = false;
+	const bool bNewFrame = g_FrameClock.BeginCall(GetQPCTime());
+	if (bNewFrame)
+		bRegularCallThisFrame = bMapCallThisFrame = false;
+	if (g_SharedData != nullptr) {
+		g_SharedData->frameId = g_FrameClock.GetFrameId();
+		g_SharedData->trackingCallsThisFrame = g_FrameClock.GetCallsThisFrame();
+		g_SharedData->repeatedFrames = g_FrameClock.GetRepeatedFrames();
 	}
+	bool &bCalledThisFrame = g_bInMapCameraUpdate ? bMapCallThisFrame : bRegularCallThisFrame;
+	if (!bNewFrame) {
+		const unsigned int repeated = g_FrameClock.GetRepeatedFrames();
+		if (g_FrameClock.GetCallsThisFrame() == 2 && (repeated <= 5 || repeated % 1000 == 0))
+			log_debug("[Frame] UpdateTrackingData() called more than once in frame %u (%u frames so far)%s",
+				g_FrameClock.GetFrameId(), repeated, g_bFrameGateEnabled ? "" : ", not gated");
+		if (g_bFrameGateEnabled && bCalledThisFrame)
+			return 0;
+	}
+	bCalledThisFrame = true;
 
-	if (g_bUDPEnabled) SendXWADataOverUDP();
+	if (g_bUDPEnabled && IsTelemetryReady()) SendXWADataOverUDP();
 	// TODO: fix shared memory telemetry. Currently it won't work unless UDP is also enabled
 
 	// Restore the position of the external camera if external inertia is enabled.
@@ -1158,6 +1840,10 @@ int UpdateTrackingData()
 		}
 	}
 
+	// Every FreePIE consumer in this frame shares a single read
+	if (!IsTrackerSamplerRunning())
+		InvalidateFreePIECache();
+
 	//XwaDIKeyboardUpdateShiftControlAltKeysPressedState();
 	__int16 keycodePressed = *keyPressedAfterLocaleAfterMapping;	
 	ProcessKeyboard(playerIndex, keycodePressed);
@@ -1179,399 +1865,50 @@ int UpdateTrackingData()
 		//__int16 keycodePressed = *keyPressedAfterLocaleAfterMapping;
 
 		// Read tracking data.
-		switch (g_TrackerType) 
-		{
-			case TRACKER_NONE:
-			{
-				Vector3 headPos;
-				static float fake_yaw = 0.0f, fake_pitch = 0.0f;
-
-				if (g_bResetHeadCenter) 
-				{
-					fake_yaw = fake_pitch = 0.0f;
-					g_headCenter[0] = 0.0f;
-					g_headCenter[1] = 0.0f;
-					g_headCenter[2] = 0.0f;
-					g_HeadPosAnim = { 0 };
-				}
-
-				if (!g_bToggleKeyboardCaps) {
-					ComputeCockpitLean(&headPos);
-					headPos = -headPos;
-					
-					//Vector4 pos(headPos.x, headPos.y, headPos.z, 1.0f);
-					//g_headPos = (pos - g_headCenter);
-					g_headCenter.x = headPos.x;
-					g_headCenter.y = headPos.y;
-					g_headCenter.z = headPos.z;
-				} else {
-					if (g_bKeyboardLook) {
-						if (g_bLeftKeyDown)  fake_yaw -= 1.0f;
-						if (g_bRightKeyDown) fake_yaw += 1.0f;
-						if (g_bDownKeyDown)  fake_pitch -= 1.0f;
-						if (g_bUpKeyDown)	 fake_pitch += 1.0f;
-					}
-				}
-
-				if (g_bKeyboardLook) {
-					yaw   = fake_yaw;
-					pitch = fake_pitch;
-				}
-
-				if (g_bKeyboardLean)
-					g_headPos = g_headCenter;
-				else
-					g_headPos.set(0, 0, 0, 0);
-				
-				// Mouse Look is enabled, apply the head's position right here
-				if (*mouseLook && !*inMissionFilmState && !*viewingFilmState) {
-					Vector4 Rs, Us, Fs;
-					Matrix4 HeadingMatrix = GetCurrentHeadingMatrix(playerIndex, Rs, Us, Fs, true);
-					if (g_bCockpitInertiaEnabled || g_bExtInertiaEnabled) {
-						float XDisp = 0.0f, YDisp = 0.0f, ZDisp = 0.0f, AccelDisp = 0.0f;
-						if (g_bInHyperspace)
-							ComputeInertia(g_prevHeadingMatrix, g_LastRsBeforeHyperspace, g_LastFsBeforeHyperspace, g_fLastSpeedBeforeHyperspace, playerIndex,
-								&XDisp, &YDisp, &ZDisp, &AccelDisp);
-						else {
-							//log_debug("Fs: %0.3f, %0.3f, %0.3f", Fs.x, Fs.y, Fs.z);
-							ComputeInertia(HeadingMatrix, Rs, Fs, (float)PlayerDataTable[playerIndex].currentSpeed, playerIndex,
-								&XDisp, &YDisp, &ZDisp, &AccelDisp);
-						}
-						// Apply the current POVOffset
-						g_headPos.x += g_SharedData->POVOffsetX;
-						g_headPos.y += g_SharedData->POVOffsetY;
-						g_headPos.z += g_SharedData->POVOffsetZ;
-						// Apply inertia:
-						if (g_bCockpitInertiaEnabled) {
-							g_headPos.x += XDisp;
-							g_headPos.y += YDisp;
-							g_headPos.z += AccelDisp;
-							g_rollInertia = ZDisp;
-						}
-
-						yawInertia = XDisp; pitchInertia = YDisp; distInertia = AccelDisp;
-					}
-
-					//if (g_bInHyperspace)
-					//	g_headPos = g_prevHeadingMatrix * g_headPos;
-					//else
-					//	g_headPos = HeadingMatrix * g_headPos;
-					// TRACKER_NONE path, when mouse look is enabled
-					//PlayerDataTable[playerIndex].Camera.ShakeX = (int)(g_fXWAUnitsToMetersScale * g_headPos.x);
-					//PlayerDataTable[playerIndex].Camera.ShakeY = (int)(g_fXWAUnitsToMetersScale * g_headPos.y);
-					//PlayerDataTable[playerIndex].Camera.ShakeZ = (int)(g_fXWAUnitsToMetersScale * g_headPos.z);
-					dataReady = false;
-				} 
-				else if (!*mouseLook) {
-					// If mouse look is disabled, then change the orientation and position of the camera
-					// using the regular path -- but only if the internal keyboard override is set! Otherwise
-					// we'll break the Joystick POV hat/Keypad look!
-					if (g_bKeyboardLook)
-						dataReady = true;
-					else {
-						// mouseLook is off and keyboardlook is disabled, apply cockpit inertia here.
-						// I'm sure this section and the above can be refactored...
-						Vector4 Rs, Us, Fs;
-						Matrix4 HeadingMatrix = GetCurrentHeadingMatrix(playerIndex, Rs, Us, Fs, true);
-						if (g_bCockpitInertiaEnabled || g_bExtInertiaEnabled) {
-							float XDisp = 0.0f, YDisp = 0.0f, ZDisp = 0.0f, AccelDisp = 0.0f;
-							if (g_bInHyperspace)
-								ComputeInertia(g_prevHeadingMatrix, g_LastRsBeforeHyperspace, g_LastFsBeforeHyperspace, g_fLastSpeedBeforeHyperspace, playerIndex,
-									&XDisp, &YDisp, &ZDisp, &AccelDisp);
-							else {
-								//log_debug("Fs: %0.3f, %0.3f, %0.3f", Fs.x, Fs.y, Fs.z);
-								ComputeInertia(HeadingMatrix, Rs, Fs, (float)PlayerDataTable[playerIndex].currentSpeed, playerIndex,
-									&XDisp, &YDisp, &ZDisp, &AccelDisp);
-							}
-							// Apply the current POVOffset
-							g_headPos.x += g_SharedData->POVOffsetX;
-							g_headPos.y += g_SharedData->POVOffsetY;
-							g_headPos.z += g_SharedData->POVOffsetZ;
-							// Apply inertia:
-							if (g_bCockpitInertiaEnabled) {
-								g_headPos.x += XDisp;
-								g_headPos.y += YDisp;
-								g_headPos.z += AccelDisp;
-								g_rollInertia = ZDisp;
-							}
-							
-							yawInertia = XDisp; pitchInertia = YDisp; distInertia = AccelDisp;
-						}
-
-						//if (g_bInHyperspace)
-						//	g_headPos = g_prevHeadingMatrix * g_headPos;
-						//else
-						//	g_headPos = HeadingMatrix * g_headPos;
-						//// TRACKER_NONE path, when mouse look is disabled
-						//PlayerDataTable[playerIndex].Camera.ShakeX = (int)(g_fXWAUnitsToMetersScale * g_headPos.x);
-						//PlayerDataTable[playerIndex].Camera.ShakeY = (int)(g_fXWAUnitsToMetersScale * g_headPos.y);
-						//PlayerDataTable[playerIndex].Camera.ShakeZ = (int)(g_fXWAUnitsToMetersScale * g_headPos.z);
-					}
-				}
-
-				// Debug: Write the fake yaw/pitch and cockpit lean to FreePIE to fake a headset
-				if (g_FreePIEOutputSlot > -1) {
-					g_FreePIEData.yaw   = fake_yaw;
-					g_FreePIEData.pitch = fake_pitch;
-						g_FreePIEData.roll  = 0.0f;
-					g_FreePIEData.x =  g_headPos.x;
-					g_FreePIEData.y =  g_headPos.y;
-					g_FreePIEData.z = -g_headPos.z;
-					WriteFreePIE(g_FreePIEOutputSlot);
-				}
-			}
-			break;
-
-			case TRACKER_FREEPIE:
-			{
-				//Vector3 headPosFromKeyboard(0,0,0);
-				//if (!g_bToggleKeyboardCaps) {
-				if (g_bKeyboardLean) {
-					ComputeCockpitLean(&g_headPosFromKeyboard);
-					g_headPosFromKeyboard = -g_headPosFromKeyboard;
-				}
-				else
-					g_headPosFromKeyboard.set(0, 0, 0);
-
-				// The Z-axis should now be inverted because of XWA's coord system
-				pitchSign = -1.0f;
-				if (ReadFreePIE(g_iFreePIESlot)) {
-					if (g_bResetHeadCenter) {
-						g_headRotationHome.y = g_FreePIEData.yaw;
-						g_headRotationHome.x = g_FreePIEData.pitch;
-						g_headRotationHome.z = g_FreePIEData.roll;
-						g_headCenter.x =  g_FreePIEData.x;
-						g_headCenter.y =  g_FreePIEData.y;
-						g_headCenter.z = -g_FreePIEData.z;
-					}
-					yaw    = (g_FreePIEData.yaw   - g_headRotationHome.y) * g_fYawMultiplier;
-					pitch  = (g_FreePIEData.pitch - g_headRotationHome.x) * g_fPitchMultiplier;
-					roll   = (g_FreePIEData.roll  - g_headRotationHome.z) * g_fRollMultiplier;
-
-					if (g_bYawPitchFromMouseOverride) {
-						// If FreePIE could not be read, then get the yaw/pitch from the mouse:
-						yaw   =  (float)PlayerDataTable[playerIndex].MousePositionX / 32768.0f * 180.0f;
-						pitch = -(float)PlayerDataTable[playerIndex].MousePositionY / 32768.0f * 180.0f;
-					}
-
-					Vector4 pos(g_FreePIEData.x, g_FreePIEData.y, -g_FreePIEData.z, 1.0f);
-					g_headPos = (pos - g_headCenter);
-					
-					// Old code:
-					//yaw   = g_FreePIEData.yaw   * g_fYawMultiplier;
-					//pitch = g_FreePIEData.pitch * g_fPitchMultiplier;
-					dataReady = true;
-				}
-			}
-			break;
-
-			case TRACKER_STEAMVR: 
-			{
-				float x, y, z;
-				static float fake_yaw = 0.0f, fake_pitch = 0.0f, fake_roll = 0.0f;
-				static float fake_pos_x = 0.0f, fake_pos_y = 0.0f, fake_pos_z = 0.0f;
-
-				if (g_bKeyboardLean) {
-					ComputeCockpitLean(&g_headPosFromKeyboard);
-					g_headPosFromKeyboard = -g_headPosFromKeyboard;
-				}
-				else
-					g_headPosFromKeyboard.set(0, 0, 0);
-
-				dataReady = GetSteamVRPositionalData(&yaw, &pitch, &roll, &x, &y, &z, &g_headRotation);
-				// We need to invert the Z-axis because of XWA's coordinate system.
-				z = -z;
-
-				// HACK ALERT: I'm reading the positional tracking data from FreePIE when
-				// running SteamVR because setting up the PSMoveServiceSteamVRBridge is kind
-				// of... tricky; and I'm not going to bother right now since PSMoveService
-				// already works very well for me.
-				// Read the positional data from FreePIE if the right flag is set
-				if (g_bSteamVRPosFromFreePIE) {
-					ReadFreePIE(g_iFreePIESlot);
-					x =  g_FreePIEData.x;
-					y =  g_FreePIEData.y;
-					z = -g_FreePIEData.z;
-				}
-
-				yaw      *= RAD_TO_DEG * g_fYawMultiplier;
-				pitch    *= RAD_TO_DEG * g_fPitchMultiplier;
-				roll     *= RAD_TO_DEG * g_fRollMultiplier;
-				yawSign   = -1.0f;
-				if (g_bResetHeadCenter) {
-					g_headCenter[0] = x;
-					g_headCenter[1] = y;
-					g_headCenter[2] = z;
-					fake_yaw = fake_pitch = fake_roll = 0.0f;
-					fake_pos_x = fake_pos_y = fake_pos_z = 0.0f;
-				}
-				Vector4 pos(x, y, z, 0.0f);
-				g_headPos = (pos - g_headCenter);
-
-				if (PlayerDataTable[*localPlayerIndex].gunnerTurretActive) {
-					Matrix4 ViewMatrix;
-					GetGunnerTurretMatrix(&ViewMatrix);
-					g_headPos = ViewMatrix * g_headPos;
-				}
-			}
-			break;
-
-			case TRACKER_TRACKIR:
-			{
-				float x, y, z;
-				// These numbers were determined empirically by ual002:
-				const float scale_x = -0.0002f;
-				const float scale_y =  0.0002f;
-				const float scale_z = -0.0002f;
-				
-				if (g_bGlobalDebug) log_debug("[TrackIR] Case start");
-				if (g_bKeyboardLean) {
-					ComputeCockpitLean(&g_headPosFromKeyboard);
-					g_headPosFromKeyboard = -g_headPosFromKeyboard;
-				}
-
-				/*
-				 * TrackIR is a bit special. If TrackIR is installed; but turned off, then
-				 * ReadTrackIRData will return false; but if we want to apply cockpit inertia
-				 * then we need to set dataReady = true. However, setting dataReady = true will
-				 * also write the yaw/pitch, which will disable the POV/Keypad when TrackIR is
-				 * off. So, we need another flag (enableTrackedYawPitch) to prevent writing to
-				 * yaw/pitch; but allow writing to cockpitX/Y/ZReference.
-				 * If TrackIR is on, we allow writing to yaw/pitch and cockpitX/Y/ZReference.
-				 * This will disable the POV hat; but you probably don't need it if you're using
-				 * your head to look around.
-				 */
-				if (g_bGlobalDebug) log_debug("[TrackIR] Reading TrackIR data");
-				if (ReadTrackIRData(&yaw, &pitch, &x, &y, &z)) {
-					if (g_bGlobalDebug) log_debug("[TrackIR] Data read, (%0.3f, %0.3f), (%0.3f, %0.3f, %0.3f)",
-						yaw, pitch, x, y, z);
-					x		 *=  scale_x;
-					y		 *=  scale_y;
-					z		 *=  scale_z;
-					yaw		 *=  g_fYawMultiplier;
-					pitch	 *=  g_fPitchMultiplier;
-					yawSign   = -1.0f;
-					pitchSign =  1.0f;
-					pitch    *= pitchSign;
-					yaw      *= yawSign;
-					roll	      = 0;
-
-					if (g_bFlipYZAxes) {
-						float temp = y; y = z; z = temp;
-					}
-
-					if (g_bResetHeadCenter) {
-						g_headCenter[0] = x;
-						g_headCenter[1] = y;
-						g_headCenter[2] = z;
-					}
-					Vector4 pos(x, y, z, 1.0f);
-					g_headPos = (pos - g_headCenter);
-					enableTrackedYawPitch = true;
-				}
+		TrackerFrame frame = { 0 };
+		frame.enableTrackedYawPitch = true;
+		if (g_pTracker->bKeyboardLean)
+			UpdateKeyboardLean();
+		g_pTracker->Update(playerIndex, &frame);
+
+		// The tracker's conventions, multipliers and offsets are applied here, regardless of the tracker.
+		if (frame.dataReady) {
+			g_TrackerTransform.ApplyRotation(&frame.yaw, &frame.pitch, &frame.roll);
+
+			// I think the following two lines will reset the yaw/pitch when using they keypad/POV hat to
+			// look around
+			if (frame.enableTrackedYawPitch) {
+				if (!g_pTracker->bMousePositionFromHead)
+					// The following line will keep the reticle fixed on the screen:
+					PlayerDataTable[playerIndex].MousePositionX = PlayerDataTable[playerIndex].MousePositionY = 0;
 				else {
-					if (g_bGlobalDebug) log_debug("[TrackIR] Data read failed. g_headPos <- (0,0,0,0)");
-					g_headPos.set(0, 0, 0, 0);
-					enableTrackedYawPitch = false;
-				}
-				dataReady = true;
-				
-			}
-			break;
-		}
-
-		// The offset is applied after the tracking data is read, regardless of the tracker.
-		if (dataReady) {
-			yaw   += g_fYawOffset;
-			pitch += g_fPitchOffset;
-			roll  += g_fRollOffset;
-			while (yaw   < 0.0f) yaw   += 360.0f;
-			while (pitch < 0.0f) pitch += 360.0f;
-			while (roll  < 0.0f) roll  += 360.0f;
-
-			//if (!bExternalCamera) {
-				// I think the following two lines will reset the yaw/pitch when using they keypad/POV hat to
-				// look around
-				if (enableTrackedYawPitch) {
-					//PlayerDataTable[playerIndex].MousePositionX = (short)(yawSign   * yaw   / 360.0f * 65535.0f);
-					//PlayerDataTable[playerIndex].MousePositionY = (short)(pitchSign * pitch / 360.0f * 65535.0f);
-					if (g_TrackerType != TRACKER_TRACKIR)
-						// The following line will keep the reticle fixed on the screen:
-						PlayerDataTable[playerIndex].MousePositionX = PlayerDataTable[playerIndex].MousePositionY = 0;
-					else {
-						// For TrackIR, it's easier if we restore the old mouse look behavior
-						PlayerDataTable[playerIndex].MousePositionX =  (int)(32768.0f * yaw   / 180.0f);
-						PlayerDataTable[playerIndex].MousePositionY = -(int)(32768.0f * pitch / 180.0f);
-					}
-
-					// Save rotation values to use later in another hooked function
-					g_headYaw   = yaw;
-					g_headPitch = pitch;
-					g_headRoll  = roll;
+					// For TrackIR, it's easier if we restore the old mouse look behavior
+					PlayerDataTable[playerIndex].MousePositionX =  (int)(32768.0f * frame.yaw   / 180.0f);
+					PlayerDataTable[playerIndex].MousePositionY = -(int)(32768.0f * frame.pitch / 180.0f);
 				}
 
-				g_headPos[0] = g_headPos[0] * g_fPosXMultiplier + g_headPosFromKeyboard[0];
-				g_headPos[1] = g_headPos[1] * g_fPosYMultiplier + g_headPosFromKeyboard[1];
-				g_headPos[2] = g_headPos[2] * g_fPosZMultiplier + g_headPosFromKeyboard[2];
-
-				// Limits clamping
-				if (g_headPos[0] < g_fMinPositionX) g_headPos[0] = g_fMinPositionX;
-				if (g_headPos[1] < g_fMinPositionY) g_headPos[1] = g_fMinPositionY;
-				if (g_headPos[2] < g_fMinPositionZ) g_headPos[2] = g_fMinPositionZ;
-
-				if (g_headPos[0] > g_fMaxPositionX) g_headPos[0] = g_fMaxPositionX;
-				if (g_headPos[1] > g_fMaxPositionY) g_headPos[1] = g_fMaxPositionY;
-				if (g_headPos[2] > g_fMaxPositionZ) g_headPos[2] = g_fMaxPositionZ;
-
-				// For some reason it looks like we don't need to compensate for yaw/pitch
-				// here (as opposed to doing it in ddraw), applying the translation directly seems 
-				// to work fine... Maybe because the frame's perspective is computed after this 
-				// point (i.e. we're at the beginning of the frame), whereas in ddraw we're at the
-				// end of the frame (?)
-
-				Vector4 Rs, Us, Fs;
-				Matrix4 HeadingMatrix = GetCurrentHeadingMatrix(playerIndex, Rs, Us, Fs, true);
-				if (g_bCockpitInertiaEnabled || g_bExtInertiaEnabled) {
-					float XDisp = 0.0f, YDisp = 0.0f, ZDisp = 0.0f, AccelDisp = 0.0f;
-					if (g_bInHyperspace)
-						ComputeInertia(g_prevHeadingMatrix, g_LastRsBeforeHyperspace, g_LastFsBeforeHyperspace, g_fLastSpeedBeforeHyperspace, playerIndex,
-							&XDisp, &YDisp, &ZDisp, &AccelDisp);
-					else
-						ComputeInertia(HeadingMatrix, Rs, Fs, (float)PlayerDataTable[playerIndex].currentSpeed, playerIndex,
-							&XDisp, &YDisp, &ZDisp, &AccelDisp);
-					// Apply the current POVOffset
-					g_headPos.x += g_SharedData->POVOffsetX;
-					g_headPos.y += g_SharedData->POVOffsetY;
-					g_headPos.z += g_SharedData->POVOffsetZ;
-					// Apply inertia:
-					if (g_bCockpitInertiaEnabled) {
-						g_headPos.x += XDisp;
-						g_headPos.y += YDisp;
-						g_headPos.z += AccelDisp;
-						g_rollInertia = ZDisp;
-					}
-
-					yawInertia = XDisp; pitchInertia = YDisp; distInertia = AccelDisp;
-				}
-
-				//if (g_bInHyperspace)
-				//	g_headPos = g_prevHeadingMatrix * g_headPos;
-				//else
-					// It is not necessary to apply the headingmatrix transformation when applying the positional offset
-					// in CockpitPositionTransform instead of Shake. 
-					//g_headPos = HeadingMatrix * g_headPos;
-
-				// MOVED TO PlayerCameraUpdateHook() to avoid using Camera.Shake
-				// Regular path: write the X,Y,Z position from g_headPos (when tracking is on).
-				//PlayerDataTable[playerIndex].Camera.ShakeX = (int)(g_fXWAUnitsToMetersScale * g_headPos.x);
-				//PlayerDataTable[playerIndex].Camera.ShakeY = (int)(g_fXWAUnitsToMetersScale * g_headPos.y);
-				//PlayerDataTable[playerIndex].Camera.ShakeZ = (int)(g_fXWAUnitsToMetersScale * g_headPos.z);
-
-			/*} else {
-				PlayerDataTable[playerIndex].Camera.Yaw   = (short)(yawSign   * yaw   / 360.0f * 65535.0f);
-				PlayerDataTable[playerIndex].Camera.Pitch = (short)(pitchSign * pitch / 360.0f * 65535.0f);
-			}*/
+				// Save rotation values to use later in another hooked function
+				g_headYaw   = frame.yaw;
+				g_headPitch = frame.pitch;
+				g_headRoll  = frame.roll;
+			}
+
+			// Device units to XWA's axes, multipliers, keyboard lean and limits in one step
+			g_headPos = g_TrackerTransform.ApplyPosition(frame.pos, g_headPosFromKeyboard,
+				frame.bTurret ? &frame.turret : NULL);
+
+			// For some reason it looks like we don't need to compensate for yaw/pitch
+			// here (as opposed to doing it in ddraw), applying the translation directly seems 
+			// to work fine... Maybe because the frame's perspective is computed after this 
+			// point (i.e. we're at the beginning of the frame), whereas in ddraw we're at the
+			// end of the frame (?)
+			// It is not necessary to apply the headingmatrix transformation when applying the positional offset
+			// in CockpitPositionTransform instead of Shake. 
+			ApplyCockpitInertia(playerIndex, &frame);
+			PublishTrackingFrame(frame);
+			ReportPoseNoise();
 		}
+		yawInertia = frame.yawInertia; pitchInertia = frame.pitchInertia; distInertia = frame.distInertia;
 
 		int moveDelta = (g_iNumPadSpeed != -1) ? g_iNumPadSpeed : *(int *)0x005AA000 >> 1;
 		if (g_bTestJoystick && XwaGetConnectedJoysticksCount() == 0)
@@ -1753,17 +2090,8 @@ int UpdateTrackingData()
 		// Apply External View Inertia when the cockpit is not displayed
 		if (bExternalCamera && *numberOfPlayersInGame == 1) 
 		{
-			float XDisp = 0.0f, YDisp = 0.0f, ZDisp = 0.0f, AccelDisp = 0.0f;
-			if (g_bInHyperspace)
-				ComputeInertia(g_prevHeadingMatrix, g_LastRsBeforeHyperspace, g_LastFsBeforeHyperspace, g_fLastSpeedBeforeHyperspace, playerIndex,
-					&XDisp, &YDisp, &ZDisp, &AccelDisp);
-			else {
-				Vector4 Rs, Us, Fs;
-				Matrix4 HeadingMatrix = GetCurrentHeadingMatrix(playerIndex, Rs, Us, Fs, true);
-				ComputeInertia(HeadingMatrix, Rs, Fs, (float)PlayerDataTable[playerIndex].currentSpeed, playerIndex,
-					&XDisp, &YDisp, &ZDisp, &AccelDisp);
-			}
-			yawInertia = XDisp; pitchInertia = YDisp; distInertia = AccelDisp;
+			float ZDisp = 0.0f;
+			ComputeFrameInertia(playerIndex, &yawInertia, &pitchInertia, &ZDisp, &distInertia);
 
 			SmoothInertia(&yawInertia, &pitchInertia);
 			// Apply the inertia
@@ -1896,6 +2224,76 @@ int UpdateTrackingData()
 }
 
 /* Load the cockpitlook.cfg file */
+/*
+ * Compiles the conventions of the current tracker into g_TrackerTransform: how its axes and
+ * units map to XWA's, plus the user's multipliers, offsets and limits.
+ */
+void CompileTrackerTransform()
+{
+	static TrackerType lastTrackerType = TRACKER_NONE;
+	TrackerTransform &transform = g_TrackerTransform;
+
+	float sx = 1.0f, sy = 1.0f, sz = 1.0f;
+	float yawScale = g_fYawMultiplier, pitchScale = g_fPitchMultiplier, rollScale = g_fRollMultiplier;
+	bool bFlipYZ = false;
+	switch (g_TrackerType) {
+	case TRACKER_NONE:
+		// UpdateNoTracker() already works in XWA's axes, and the angles aren't scaled
+		yawScale = pitchScale = rollScale = 1.0f;
+		break;
+	case TRACKER_FREEPIE:
+	case TRACKER_FUSION:
+		// The Z-axis is inverted because of XWA's coord system
+		sz = -1.0f;
+		break;
+	case TRACKER_OPENTRACK:
+		// OpenTrack sends centimeters
+		sx = sy = 0.01f; sz = -0.01f;
+		break;
+	case TRACKER_STEAMVR:
+		sz = -1.0f;
+		yawScale *= RAD_TO_DEG; pitchScale *= RAD_TO_DEG; rollScale *= RAD_TO_DEG;
+		break;
+	case TRACKER_TRACKIR:
+		// These numbers were determined empirically by ual002:
+		sx = -0.0002f; sy = 0.0002f; sz = -0.0002f;
+		yawScale = -yawScale;
+		rollScale = 0.0f;
+		bFlipYZ = g_bFlipYZAxes;
+		break;
+	}
+	// The yaw/pitch come from the mouse as they are
+	const bool bMouseYawPitch = g_bYawPitchFromMouseOverride && (g_TrackerType == TRACKER_FREEPIE ||
+		g_TrackerType == TRACKER_OPENTRACK || g_TrackerType == TRACKER_FUSION);
+	if (bMouseYawPitch)
+		yawScale = pitchScale = 1.0f;
+
+	// Columns of the matrix: where each device axis goes
+	if (bFlipYZ)
+		transform.deviceToXWA.set(sx, 0, 0, 0,  0, 0, sy, 0,  0, sz, 0, 0,  0, 0, 0, 1);
+	else
+		transform.deviceToXWA.set(sx, 0, 0, 0,  0, sy, 0, 0,  0, 0, sz, 0,  0, 0, 0, 1);
+	transform.posMultiplier.set(g_fPosXMultiplier, g_fPosYMultiplier, g_fPosZMultiplier);
+	transform.minPos.set(g_fMinPositionX, g_fMinPositionY, g_fMinPositionZ);
+	transform.maxPos.set(g_fMaxPositionX, g_fMaxPositionY, g_fMaxPositionZ);
+	transform.rotScale.set(yawScale, pitchScale, rollScale);
+	transform.rotOffset.set(g_fYawOffset, g_fPitchOffset, g_fRollOffset);
+	// The curves shape head tracking, not the keyboard or the mouse. They don't apply to
+	// SteamVR either: the headset's rotation goes to the camera as it is, because a view that
+	// doesn't follow the head one to one in a headset is sickening.
+	const bool bCurves = g_TrackerType != TRACKER_NONE && g_TrackerType != TRACKER_STEAMVR;
+	transform.yawCurve   = (bCurves && !bMouseYawPitch) ? g_YawCurve   : ResponseCurve();
+	transform.pitchCurve = (bCurves && !bMouseYawPitch) ? g_PitchCurve : ResponseCurve();
+	transform.rollCurve  = bCurves ? g_RollCurve : ResponseCurve();
+
+	// A center in another tracker's units is meaningless
+	if (g_TrackerType != lastTrackerType)
+		transform.SetCenter(Vector4(0, 0, 0, 1));
+	else
+		transform.Compile();
+	lastTrackerType = g_TrackerType;
+}
+
 void LoadParams() {
 	FILE *file;
 	int error = 0;
@@ -1914,6 +2312,7 @@ void LoadParams() {
 
 	// Reset to defaults
 	g_iNumPadSpeed = -1;
+	g_YawCurve.Clear(); g_PitchCurve.Clear(); g_RollCurve.Clear();
 
 	char buf[160], param[80], svalue[80];
 	float fValue;
@@ -1927,6 +2326,7 @@ void LoadParams() {
 		if (sscanf_s(buf, "%s = %s", param, 80, svalue, 80) > 0) {
 			fValue = (float )atof(svalue);
 			if (_stricmp(param, TRACKER_TYPE) == 0) {
+				g_bTrackerReplay = false;
 				if (_stricmp(svalue, TRACKER_TYPE_FREEPIE) == 0) {
 					log_debug("Using FreePIE for tracking");
 					g_TrackerType = TRACKER_FREEPIE;
@@ -1939,10 +2339,23 @@ void LoadParams() {
 					log_debug("Using TrackIR for tracking");
 					g_TrackerType = TRACKER_TRACKIR;
 				}
+				else if (_stricmp(svalue, TRACKER_TYPE_OPENTRACK) == 0) {
+					log_debug("Using OpenTrack (UDP) for tracking");
+					g_TrackerType = TRACKER_OPENTRACK;
+				}
+				else if (_stricmp(svalue, TRACKER_TYPE_FUSION) == 0) {
+					log_debug("Using two fused trackers for tracking");
+					g_TrackerType = TRACKER_FUSION;
+				}
 				else if (_stricmp(svalue, TRACKER_TYPE_NONE) == 0) {
 					log_debug("Tracking disabled");
 					g_TrackerType = TRACKER_NONE;
 				}
+				else if (_stricmp(svalue, TRACKER_TYPE_REPLAY) == 0) {
+					log_debug("Replaying a tracker capture");
+					// The actual tracker type comes from the capture, once it's loaded
+					g_bTrackerReplay = true;
+				}
 			}
 			else if (_stricmp(param, YAW_MULTIPLIER) == 0) {
 				g_fYawMultiplier = fValue;
@@ -1968,10 +2381,26 @@ void LoadParams() {
 				g_fRollOffset = fValue;
 				log_debug("Roll offset: %0.3f", g_fRollOffset);
 			}
+			else if (_stricmp(param, YAW_CURVE) == 0) {
+				if (g_YawCurve.Parse(svalue))
+					log_debug("Yaw curve: %s", svalue);
+			}
+			else if (_stricmp(param, PITCH_CURVE) == 0) {
+				if (g_PitchCurve.Parse(svalue))
+					log_debug("Pitch curve: %s", svalue);
+			}
+			else if (_stricmp(param, ROLL_CURVE) == 0) {
+				if (g_RollCurve.Parse(svalue))
+					log_debug("Roll curve: %s", svalue);
+			}
 			else if (_stricmp(param, FREEPIE_SLOT) == 0) {
 				g_iFreePIESlot = (int )fValue;
 				log_debug("FreePIE slot: %d", g_iFreePIESlot);
 			}
+			else if (_stricmp(param, OPENTRACK_PORT) == 0) {
+				g_iOpenTrackPort = (int )fValue;
+				log_debug("OpenTrack port: %d", g_iOpenTrackPort);
+			}
 			else if (_stricmp(param, "force_steamvr_shutdown") == 0) {
 				g_bForceSteamVRShutdown = (bool)fValue;
 			}
@@ -2011,12 +2440,57 @@ void LoadParams() {
 			else if (_stricmp(param, "steamvr_pos_from_freepie") == 0) {
 				g_bSteamVRPosFromFreePIE = (bool)fValue;
 			}
+			else if (_stricmp(param, "steamvr_nonblocking_pose") == 0) {
+				g_bSteamVRNonBlockingPose = (bool)fValue;
+				log_debug("SteamVR non-blocking pose: %d", g_bSteamVRNonBlockingPose);
+			}
 			else if (_stricmp(param, "xwa_units_to_meters_scale") == 0) {
 				g_fXWAUnitsToMetersScale = fValue;
 			}
 			else if (_stricmp(param, "flip_yz_axes") == 0) {
 				g_bFlipYZAxes = (bool)fValue;
 			}
+			else if (_stricmp(param, "fusion_rotation_source") == 0 || _stricmp(param, "fusion_position_source") == 0) {
+				TrackerType source = TRACKER_NONE;
+				if (_stricmp(svalue, TRACKER_TYPE_FREEPIE) == 0)
+					source = TRACKER_FREEPIE;
+				else if (_stricmp(svalue, TRACKER_TYPE_STEAMVR) == 0)
+					source = TRACKER_STEAMVR;
+				else if (_stricmp(svalue, TRACKER_TYPE_TRACKIR) == 0)
+					source = TRACKER_TRACKIR;
+				else if (_stricmp(svalue, TRACKER_TYPE_OPENTRACK) == 0)
+					source = TRACKER_OPENTRACK;
+				else
+					log_debug("Unknown fusion source: %s", svalue);
+				if (_stricmp(param, "fusion_rotation_source") == 0)
+					g_FusionRotationSource = source;
+				else
+					g_FusionPositionSource = source;
+				log_debug("%s: %s", param, svalue);
+			}
+			else if (_stricmp(param, "fusion_max_stale") == 0) {
+				g_PoseFusion.maxStale = fValue;
+				log_debug("Fusion source timeout: %0.3fs", g_PoseFusion.maxStale);
+			}
+			else if (_stricmp(param, "tracker_sampler_thread") == 0) {
+				g_bTrackerSamplerEnabled = (bool)fValue;
+				log_debug("Tracker sampler thread: %d", g_bTrackerSamplerEnabled);
+			}
+			else if (_stricmp(param, "tracker_sampler_rate") == 0) {
+				g_iTrackerSamplerRate = (int)fValue;
+				log_debug("Tracker sampler rate: %d", g_iTrackerSamplerRate);
+			}
+			else if (_stricmp(param, "frame_gate_enabled") == 0) {
+				g_bFrameGateEnabled = (bool)fValue;
+				log_debug("Once-per-frame tracking update: %d", g_bFrameGateEnabled);
+			}
+			else if (_stricmp(param, "frame_gate_min_interval") == 0) {
+				g_FrameClock.minFrameInterval = fValue;
+			}
+			else if (_stricmp(param, "device_init_retries") == 0) {
+				g_iDeviceInitRetries = (int)fValue;
+				log_debug("Device init retries: %d", g_iDeviceInitRetries);
+			}
 			else if (_stricmp(param, "debug_mode") == 0) {
 				g_bGlobalDebug = (bool)fValue;
 			}
@@ -2046,6 +2520,15 @@ void LoadParams() {
 			else if (_stricmp(param, "invert_cockpit_lean_y") == 0) {
 				g_bInvertCockpitLeanY = (bool)fValue;
 			}
+			else if (_stricmp(param, "cockpit_lean_speed") == 0) {
+				g_fLeanSpeed = fValue;
+			}
+			else if (_stricmp(param, "cockpit_lean_reset_speed") == 0) {
+				g_fLeanResetSpeed = fValue;
+			}
+			else if (_stricmp(param, "cockpit_lean_ease_time") == 0) {
+				g_fLeanEaseTime = fValue;
+			}
 			else if (_stricmp(param, "cockpit_inertia_enabled") == 0) {
 				g_bCockpitInertiaEnabled = (bool)fValue;
 			}
@@ -2058,6 +2541,35 @@ void LoadParams() {
 			else if (_stricmp(param, "cockpit_speed_inertia") == 0) {
 				g_fCockpitSpeedInertia = fValue;
 			}
+			else if (_stricmp(param, "inertia_heading_time_constant") == 0) {
+				g_fInertiaHeadingTimeConstant = fValue;
+			}
+			else if (_stricmp(param, "inertia_accel_time_constant") == 0) {
+				g_fInertiaAccelTimeConstant = fValue;
+			}
+			else if (_stricmp(param, "inertia_speed_time_constant") == 0) {
+				g_fInertiaSpeedTimeConstant = fValue;
+			}
+			else if (_stricmp(param, "cockpit_inertia_model") == 0) {
+				g_iCockpitInertiaModel = (int)fValue;
+				log_debug("Cockpit inertia model: %s", g_iCockpitInertiaModel == INERTIA_MODEL_SPRING ? "spring" : "trailing heading");
+			}
+			else if (_stricmp(param, "head_stiffness") == 0) {
+				g_HeadModel.stiffness = fValue;
+			}
+			else if (_stricmp(param, "head_damping_ratio") == 0) {
+				g_HeadModel.dampingRatio = fValue;
+			}
+			else if (_stricmp(param, "head_model_rate") == 0) {
+				g_HeadModel.rate = fValue;
+			}
+			else if (_stricmp(param, "head_inertia_gain") == 0) {
+				g_HeadModel.gain = fValue;
+			}
+			else if (_stricmp(param, "inertia_fixed_step") == 0) {
+				g_fInertiaFixedStep = fValue;
+				log_debug("Inertia fixed step: %0.4fs", g_fInertiaFixedStep);
+			}
 			else if (_stricmp(param, "external_inertia_enabled") == 0) {
 				g_bExtInertiaEnabled = (bool)fValue;
 			}
@@ -2093,12 +2605,147 @@ void LoadParams() {
 				g_bTestJoystick = (bool)fValue;
 			}
 
-			/*
+			else if (_stricmp(param, "pose_prediction_enabled") == 0) {
+				g_bPosePredictionEnabled = (bool)fValue;
+				log_debug("Pose prediction enabled: %d", g_bPosePredictionEnabled);
+			}
 			else if (_stricmp(param, "predicted_seconds_to_photons") == 0) {
 				g_fPredictedSecondsToPhotons = fValue;
 				log_debug("predicted_seconds_to_photons set to: %0.6f", g_fPredictedSecondsToPhotons);
 			}
-			*/
+			else if (_stricmp(param, "freepie_prediction_max_angle") == 0) {
+				g_PredictionLimits[TRACKER_FREEPIE].maxAngle = fValue;
+			}
+			else if (_stricmp(param, "freepie_prediction_max_position") == 0) {
+				g_PredictionLimits[TRACKER_FREEPIE].maxPos = fValue;
+			}
+			else if (_stricmp(param, "trackir_prediction_max_angle") == 0) {
+				g_PredictionLimits[TRACKER_TRACKIR].maxAngle = fValue;
+			}
+			else if (_stricmp(param, "trackir_prediction_max_position") == 0) {
+				g_PredictionLimits[TRACKER_TRACKIR].maxPos = fValue;
+			}
+			else if (_stricmp(param, "opentrack_prediction_max_angle") == 0) {
+				g_PredictionLimits[TRACKER_OPENTRACK].maxAngle = fValue;
+			}
+			else if (_stricmp(param, "opentrack_prediction_max_position") == 0) {
+				g_PredictionLimits[TRACKER_OPENTRACK].maxPos = fValue;
+			}
+			else if (_stricmp(param, "fusion_prediction_max_angle") == 0) {
+				g_PredictionLimits[TRACKER_FUSION].maxAngle = fValue;
+			}
+			else if (_stricmp(param, "fusion_prediction_max_position") == 0) {
+				g_PredictionLimits[TRACKER_FUSION].maxPos = fValue;
+			}
+
+			else if (_stricmp(param, "trackir_interpolation") == 0) {
+				g_bTrackIRInterpolation = (bool)fValue;
+			}
+			else if (_stricmp(param, "trackir_interpolation_delay") == 0) {
+				g_fTrackIRInterpolationDelay = fValue;
+			}
+
+			else if (_stricmp(param, "tracker_capture_enabled") == 0) {
+				g_bTrackerCaptureEnabled = (bool)fValue;
+			}
+			else if (_stricmp(param, "tracker_capture_file") == 0) {
+				_snprintf_s(g_sTrackerCaptureFile, MAX_PATH, "%s", svalue);
+			}
+			else if (_stricmp(param, "tracker_replay_file") == 0) {
+				_snprintf_s(g_sTrackerReplayFile, MAX_PATH, "%s", svalue);
+			}
+			else if (_stricmp(param, "tracker_replay_realtime") == 0) {
+				g_bTrackerReplayRealTime = (bool)fValue;
+			}
+			else if (_stricmp(param, "tracker_replay_loop") == 0) {
+				g_bTrackerReplayLoop = (bool)fValue;
+			}
+
+			else if (_stricmp(param, "filter_enabled") == 0) {
+				g_bPoseFilterEnabled = (bool)fValue;
+				log_debug("Pose filter enabled: %d", g_bPoseFilterEnabled);
+			}
+			else if (_stricmp(param, "filter_rotation_min_cutoff") == 0) {
+				g_PoseFilter.rotMinCutoff = fValue;
+			}
+			else if (_stricmp(param, "filter_rotation_beta") == 0) {
+				g_PoseFilter.rotBeta = fValue;
+			}
+			else if (_stricmp(param, "filter_d_cutoff") == 0) {
+				g_PoseFilter.dCutoff = fValue;
+			}
+			else if (_stricmp(param, "filter_auto_cutoff") == 0) {
+				g_PoseFilter.autoCutoff = (bool)fValue;
+				log_debug("Automatic filter cutoff: %d", g_PoseFilter.autoCutoff);
+			}
+			else if (_stricmp(param, "filter_rotation_noise_target") == 0) {
+				g_PoseFilter.rotNoiseTarget = fValue;
+			}
+			else if (_stricmp(param, "filter_auto_min_cutoff") == 0) {
+				g_PoseFilter.minAutoCutoff = fValue;
+			}
+			else if (_stricmp(param, "filter_auto_max_cutoff") == 0) {
+				g_PoseFilter.maxAutoCutoff = fValue;
+			}
+			else if (_stricmp(param, "freepie_filter_position_min_cutoff") == 0) {
+				g_FilterParams[TRACKER_FREEPIE].posMinCutoff = fValue;
+			}
+			else if (_stricmp(param, "freepie_filter_position_beta") == 0) {
+				g_FilterParams[TRACKER_FREEPIE].posBeta = fValue;
+			}
+			else if (_stricmp(param, "freepie_filter_position_noise_target") == 0) {
+				g_FilterParams[TRACKER_FREEPIE].posNoiseTarget = fValue;
+			}
+			else if (_stricmp(param, "steamvr_filter_position_min_cutoff") == 0) {
+				g_FilterParams[TRACKER_STEAMVR].posMinCutoff = fValue;
+			}
+			else if (_stricmp(param, "steamvr_filter_position_beta") == 0) {
+				g_FilterParams[TRACKER_STEAMVR].posBeta = fValue;
+			}
+			else if (_stricmp(param, "steamvr_filter_position_noise_target") == 0) {
+				g_FilterParams[TRACKER_STEAMVR].posNoiseTarget = fValue;
+			}
+			else if (_stricmp(param, "trackir_filter_position_min_cutoff") == 0) {
+				g_FilterParams[TRACKER_TRACKIR].posMinCutoff = fValue;
+			}
+			else if (_stricmp(param, "trackir_filter_position_beta") == 0) {
+				g_FilterParams[TRACKER_TRACKIR].posBeta = fValue;
+			}
+			else if (_stricmp(param, "trackir_filter_position_noise_target") == 0) {
+				g_FilterParams[TRACKER_TRACKIR].posNoiseTarget = fValue;
+			}
+			else if (_stricmp(param, "opentrack_filter_position_min_cutoff") == 0) {
+				g_FilterParams[TRACKER_OPENTRACK].posMinCutoff = fValue;
+			}
+			else if (_stricmp(param, "opentrack_filter_position_beta") == 0) {
+				g_FilterParams[TRACKER_OPENTRACK].posBeta = fValue;
+			}
+			else if (_stricmp(param, "opentrack_filter_position_noise_target") == 0) {
+				g_FilterParams[TRACKER_OPENTRACK].posNoiseTarget = fValue;
+			}
+			else if (_stricmp(param, "fusion_filter_position_min_cutoff") == 0) {
+				g_FilterParams[TRACKER_FUSION].posMinCutoff = fValue;
+			}
+			else if (_stricmp(param, "fusion_filter_position_beta") == 0) {
+				g_FilterParams[TRACKER_FUSION].posBeta = fValue;
+			}
+			else if (_stricmp(param, "fusion_filter_position_noise_target") == 0) {
+				g_FilterParams[TRACKER_FUSION].posNoiseTarget = fValue;
+			}
+
+			else if (_stricmp(param, "dropout_enabled") == 0) {
+				g_bPoseDropoutEnabled = (bool)fValue;
+				log_debug("Dropout handling enabled: %d", g_bPoseDropoutEnabled);
+			}
+			else if (_stricmp(param, "dropout_extrapolation_time") == 0) {
+				g_PoseDropout.extrapolationTime = fValue;
+			}
+			else if (_stricmp(param, "dropout_decay_time") == 0) {
+				g_PoseDropout.decayTime = fValue;
+			}
+			else if (_stricmp(param, "dropout_blend_time") == 0) {
+				g_PoseDropout.blendTime = fValue;
+			}
 
 			// UDP settings
 			if (_stricmp(param, "UDP_telemetry_enabled") == 0) {
@@ -2214,6 +2861,47 @@ void LoadParams() {
 		}
 	} // while ... read file
 	fclose(file);
+
+	if (g_bTrackerReplay) {
+		const int source = LoadTrackerReplay(g_sTrackerReplayFile);
+		// Only the trackers that go through the sampler path record replayable samples
+		const int numTrackers = sizeof(g_Trackers) / sizeof(g_Trackers[0]);
+		if (source >= 0 && source < numTrackers && g_Trackers[source].ReadSample != NULL) {
+			g_TrackerType = (TrackerType)source;
+		}
+		else {
+			if (source != -1)
+				log_debug("[Replay] Captures from tracker type %d can't be replayed", source);
+			UnloadTrackerReplay();
+			g_TrackerType = TRACKER_NONE;
+		}
+	}
+	else
+		UnloadTrackerReplay();
+
+	g_pTracker = &g_Trackers[g_TrackerType];
+	CompileTrackerTransform();
+	// The offsets are pre-composed into a single rotation that's applied after the tracked one
+	g_headOffsetRotation = Quaternion::FromYawPitchRoll(-g_fYawOffset, -g_fPitchOffset, g_fRollOffset);
+
+	// The tracker may have changed, so the prediction history is no longer valid
+	g_PosePredictor.Reset();
+	g_PosePredictor.horizon  = g_fPredictedSecondsToPhotons;
+	g_PosePredictor.maxAngle = g_PredictionLimits[g_TrackerType].maxAngle;
+	g_PosePredictor.maxPos   = g_PredictionLimits[g_TrackerType].maxPos;
+
+	g_PoseInterpolator.Reset();
+	g_PoseInterpolator.delay = g_fTrackIRInterpolationDelay;
+	g_bPoseInterpolationEnabled = g_bTrackIRInterpolation && g_TrackerType == TRACKER_TRACKIR;
+
+	g_PoseFusion.Reset();
+	g_PoseDropout.Reset();
+	g_PoseDropout.SetHome(TrackerSample());
+
+	g_PoseFilter.Reset();
+	g_PoseFilter.posMinCutoff = g_FilterParams[g_TrackerType].posMinCutoff;
+	g_PoseFilter.posBeta      = g_FilterParams[g_TrackerType].posBeta;
+	g_PoseFilter.posNoiseTarget = g_FilterParams[g_TrackerType].posNoiseTarget;
 }
 
 void InitKeyboard()
@@ -2273,8 +2961,10 @@ int MapCameraUpdateHook(int* params)
 {
 	if (!g_bEnableExternalInertiaInMap)
 		g_bInsideMapCameraUpdateHook = true;
+	g_bInMapCameraUpdate = true;
 	UpdateTrackingData();
 	g_bInsideMapCameraUpdateHook = false;
+	g_bInMapCameraUpdate = false;
 	int (*MapCameraUpdate)(int, int) = (int(*)(int a1, int a2)) 0x49EE90;
 	return MapCameraUpdate(params[0], params[1]);
 
@@ -2336,24 +3026,10 @@ int DoRotationPitchHook(int* params)
 	// g_SharedData->bIsReticleSetup is set to 1 by SetupReticleHook().
 	// Bypass the check when in the hangar, as there is no reticle so the flag is still 0.
 
-	if ((g_TrackerType == TRACKER_FREEPIE || g_TrackerType == TRACKER_STEAMVR) &&
-		(g_SharedData->bIsReticleSetup || *g_playerInHangar))
+	if (g_pTracker->bInjectRotation && (g_SharedData->bIsReticleSetup || *g_playerInHangar))
 	{
-		if (g_TrackerType == TRACKER_FREEPIE) {
-			// We need to build the rotation matrix from yaw,pitch,roll
-			Matrix4 rX, rY, rZ;
-			// TrackIR may need +g_headPitch and +g_headYaw
-			rX.rotateX(-g_headPitch);
-			rY.rotateY(-g_headYaw);
-			rZ.rotateZ(g_headRoll);
-			// The following transform rule applies roll at the end of the chain. This
-			// make it possible to roll your head no matter where you're looking at. This
-			// matches the old behavior where roll was applied as a hack to the backbuffer
-			Matrix4 rotMatrix = rY * rX * rZ;
-			vr::HmdMatrix34_t poseMatrix;
-			Matrix4toHmdMatrix34(rotMatrix, poseMatrix);
-			g_headRotation = HmdMatrix34toMatrix3(poseMatrix);
-		}
+		// This is the only place where the head's rotation is turned into a matrix
+		const Matrix3 headRotation = g_headRotation.toMatrix3();
 
 		// First construct the rotation matrix from current XWA globals
 		// We follow the same convention as SteamVR (+y is up, +x is to the right, -z is forward)
@@ -2371,9 +3047,9 @@ int DoRotationPitchHook(int* params)
 			R[8], R[9], R[10]);
 		// Apply the rotation matrix from headtracking
 		//headTransNoRollInertia = xwaCameraTransform * g_headRotation;
-		xwaCameraTransform = xwaCameraTransform * RZ * g_headRotation;
+		xwaCameraTransform = xwaCameraTransform * RZ * headRotation;
 #else
-		xwaCameraTransform *= g_headRotation;
+		xwaCameraTransform *= headRotation;
 #endif
 
 		// Rewrite the composed rotation matrix (original+headtracking) into XWA globals
@@ -2421,7 +3097,7 @@ int DoRotationPitchHook(int* params)
 */
 int DoRotationYawHook(int* params)
 {
-	if ((g_TrackerType == TRACKER_FREEPIE || g_TrackerType == TRACKER_STEAMVR) && (g_SharedData->bIsReticleSetup || *g_playerInHangar)) {
+	if (g_pTracker->bInjectRotation && (g_SharedData->bIsReticleSetup || *g_playerInHangar)) {
 		// Since we applied the full rotation matrix in DoRotationPitchHook(), we don't need to do anything here.
 		return 0;
 	}
@@ -2467,81 +3143,267 @@ int WarheadEffectHook(int* params)
 	return WarheadEffect();
 }
 
+/*
+ * The device settings of the current config, for the device manager. Only the settings the
+ * tracker actually uses are filled in, so changing anything else doesn't restart it.
+ */
+TrackerDeviceConfig GetTrackerDeviceConfig()
+{
+	TrackerDeviceConfig config;
+	config.device = g_TrackerType;
+	if (g_TrackerType == TRACKER_FUSION) {
+		config.rotationSource = g_FusionRotationSource;
+		config.positionSource = g_FusionPositionSource;
+	}
+	const bool bSteamVR = g_TrackerType == TRACKER_STEAMVR ||
+		config.rotationSource == TRACKER_STEAMVR || config.positionSource == TRACKER_STEAMVR;
+	config.bSteamVRPosFromFreePIE = bSteamVR && g_bSteamVRPosFromFreePIE;
+	if (g_TrackerType == TRACKER_FREEPIE || config.bSteamVRPosFromFreePIE ||
+		config.rotationSource == TRACKER_FREEPIE || config.positionSource == TRACKER_FREEPIE)
+		config.freePIESlot = g_iFreePIESlot;
+	config.bFreePIEOutput = g_TrackerType == TRACKER_NONE && g_FreePIEOutputSlot != -1;
+	config.bSampler = g_bTrackerSamplerEnabled;
+	return config;
+}
+
+// Runs on the device manager thread, so it only looks at the config it's given
+bool InitTrackerDevice(const TrackerDeviceConfig &config, TrackerType trackerType)
+{
+	bool bResult = true;
+	switch (trackerType)
+	{
+	case TRACKER_FREEPIE:
+		bResult = InitFreePIE();
+		AddFreePIEReadSlot(config.freePIESlot);
+		break;
+	case TRACKER_STEAMVR:
+		bResult = InitSteamVR();
+		if (bResult && config.bSteamVRPosFromFreePIE) {
+			InitFreePIE();
+			AddFreePIEReadSlot(config.freePIESlot);
+		}
+		break;
+	case TRACKER_TRACKIR:
+		g_bTrackIRLoaded = bResult = InitTrackIR();
+		break;
+	case TRACKER_OPENTRACK:
+		bResult = InitOpenTrack();
+		break;
+	case TRACKER_FUSION:
+		// Fusion works off the rotation alone when the position source is missing, and
+		// retrying would initialize the rotation source twice
+		bResult = InitTrackerDevice(config, (TrackerType)config.rotationSource);
+		if (bResult && config.positionSource != config.rotationSource &&
+			!InitTrackerDevice(config, (TrackerType)config.positionSource))
+			log_debug("The Fusion position source could not be initialized");
+		break;
+	}
+	return bResult;
+}
+
+/*
+ * Shuts down a device the way it was brought up: the config may have been reloaded since.
+ * bUnloading is only set when the DLL is being unloaded.
+ */
+void ShutdownTrackerDevice(const TrackerDeviceConfig &config, TrackerType trackerType, bool bUnloading)
+{
+	switch (trackerType) {
+	case TRACKER_FREEPIE:
+		ShutdownFreePIE();
+		break;
+	case TRACKER_STEAMVR:
+		// We can't shutdown SteamVR twice: we either shut it down here, or in ddraw.dll.
+		// It looks like the right order is to shut it down here.
+
+		// For some reason, sometimes xwingalliance.exe just stays running in the background
+		// after exiting. It seems to get hung when shutting down SteamVR. This block will
+		// forcefully exit the game if "force_steamvr_shutdown" is set in CockpitLook.cfg.
+		// That's only for when the game is exiting: switching trackers mid-mission must not.
+		if (bUnloading && g_bForceSteamVRShutdown) {
+			if (config.bSteamVRPosFromFreePIE)
+				ShutdownFreePIE();
+			ExitProcess(0);
+		}
+		ShutdownSteamVR();
+		if (config.bSteamVRPosFromFreePIE)
+			ShutdownFreePIE();
+		break;
+	case TRACKER_TRACKIR:
+		g_bTrackIRLoaded = false;
+		ShutdownTrackIR();
+		break;
+	case TRACKER_OPENTRACK:
+		ShutdownOpenTrack();
+		break;
+	case TRACKER_FUSION:
+		// SteamVR may exit the process, so it goes last
+		if (config.rotationSource == TRACKER_STEAMVR) {
+			if (config.positionSource != TRACKER_STEAMVR)
+				ShutdownTrackerDevice(config, (TrackerType)config.positionSource, bUnloading);
+			ShutdownTrackerDevice(config, TRACKER_STEAMVR, bUnloading);
+		}
+		else {
+			if (config.positionSource != config.rotationSource)
+				ShutdownTrackerDevice(config, (TrackerType)config.positionSource, bUnloading);
+			ShutdownTrackerDevice(config, (TrackerType)config.rotationSource, bUnloading);
+		}
+		break;
+	case TRACKER_NONE:
+		if (config.bFreePIEOutput)
+			ShutdownFreePIE();
+		break;
+	}
+}
+
+/*
+ * Device manager callbacks. The sampler thread reads the device, so it's started once the
+ * device is up and stopped before the device goes away.
+ */
+bool BringUpTrackerDevice(const TrackerDeviceConfig &config)
+{
+	if (!InitTrackerDevice(config, (TrackerType)config.device))
+		return false;
+
+	// Move the device reads off the game thread
+	if (config.bSampler) {
+		// SteamVR has to be read from the game thread
+		const bool bFusionWithSteamVR = config.device == TRACKER_FUSION &&
+			(config.rotationSource == TRACKER_STEAMVR || config.positionSource == TRACKER_STEAMVR);
+		const TrackerReadFun readFun = g_Trackers[config.device].ReadSample;
+		if (readFun != NULL && !bFusionWithSteamVR)
+			StartTrackerSampler(readFun);
+		else
+			log_debug("The tracker sampler thread isn't supported for this tracker");
+	}
+	return true;
+}
+
+void TearDownTrackerDevice(const TrackerDeviceConfig &config, bool bUnloading)
+{
+	StopTrackerSampler();
+	ShutdownTrackerDevice(config, (TrackerType)config.device, bUnloading);
+}
+
+/*
+ * Startup tasks, run in the background by RunStartupTasks(). Everything needs the config;
+ * after that, the telemetry, YawVR and the tracker come up in parallel.
+ */
+// Indices in g_StartupTasks
+enum StartupTaskId {
+	STARTUP_CONFIG,
+	STARTUP_UDP,
+	STARTUP_YAWVR,
+	STARTUP_TRACKER,
+	STARTUP_TASK_COUNT
+};
+// YawVR::bEnabled as read from the config; the flag itself is only set once YawVR is connected
+bool g_bYawVRRequested = false;
+
+bool StartupLoadConfig()
+{
+	LoadParams();
+	log_debug("Parameters loaded");
+	g_bYawVRRequested = YawVR::bEnabled;
+	YawVR::bEnabled = false;
+	return true;
+}
+
+bool StartupUDP()
+{
+	// UDP Telemetry Initialization
+	if (!g_bUDPEnabled)
+		return true;
+	return InitializeUDP() && InitializeUDPSocket();
+}
+
+bool StartupYawVR()
+{
+	if (!g_bYawVRRequested)
+		return true;
+	// Only enable it once it's connected, so the hooks don't talk to it before that
+	if (!YawVR::Initialize())
+		return false;
+	YawVR::bEnabled = true;
+	return true;
+}
+
+bool StartupTracker()
+{
+	if (g_bTrackerCaptureEnabled && !g_bTrackerReplay)
+		StartTrackerCapture(g_sTrackerCaptureFile, g_TrackerType);
+
+	// There's no device to bring up when replaying a capture. Otherwise, the device
+	// manager initializes it (and starts the sampler) in the background.
+	if (g_bTrackerReplay)
+		return true;
+	if (!StartDeviceManager(BringUpTrackerDevice, TearDownTrackerDevice))
+		return false;
+	RequestTrackerDevice(GetTrackerDeviceConfig());
+	return true;
+}
+
+static const StartupTask g_StartupTasks[] = {
+	{ "Config",    StartupLoadConfig, 0 },
+	{ "Telemetry", StartupUDP,        1 << STARTUP_CONFIG },
+	{ "YawVR",     StartupYawVR,      1 << STARTUP_CONFIG },
+	{ "Tracker",   StartupTracker,    1 << STARTUP_CONFIG },
+};
+static_assert(sizeof(g_StartupTasks) / sizeof(g_StartupTasks[0]) == STARTUP_TASK_COUNT,
+	"g_StartupTasks must have one entry per StartupTaskId, in the same order");
+
+bool IsConfigLoaded()
+{
+	return IsStartupTaskReady(STARTUP_CONFIG);
+}
+
+bool IsTelemetryReady()
+{
+	return IsStartupTaskReady(STARTUP_UDP);
+}
+
+// What's left of a wait that ends at deadline (a GetQPCTime() value), rounded up
+static unsigned int MillisecondsUntil(LONGLONG deadline)
+{
+	const LONGLONG now = GetQPCTime();
+	return deadline > now ? (unsigned int)(1000.0 * QPCToSeconds(deadline - now)) + 1 : 0;
+}
+
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD uReason, LPVOID lpReserved)
 {
+	LONGLONG attachStart, detachDeadline;
 	switch (uReason)
 	{
 	case DLL_PROCESS_ATTACH:
+		attachStart = GetQPCTime();
 		log_debug("Cockpit Hook Loaded");
 		g_hWnd = GetForegroundWindow();
-		// Load cockpitlook.cfg here and enable FreePIE, SteamVR or TrackIR
-		LoadParams();
-		log_debug("Parameters loaded");
 		InitKeyboard();
 		InitHeadingMatrix();
-		// UDP Telemetry Initialization
-		if (g_bUDPEnabled) {
-			InitializeUDP();
-			InitializeUDPSocket();
-		}
-
-		if (YawVR::bEnabled) YawVR::Initialize();
-
+		// The hooks use the shared memory unconditionally, and mapping it is quick
 		InitSharedMem();
-
-		switch (g_TrackerType)
-		{
-		case TRACKER_FREEPIE:
-			InitFreePIE();
-			break;
-		case TRACKER_STEAMVR:
-			InitSteamVR();
-			if (g_bSteamVRPosFromFreePIE)
-				InitFreePIE();
-			break;
-		case TRACKER_TRACKIR:
-			g_bTrackIRLoaded = InitTrackIR();
-			break;
-		}
+		// cockpitlook.cfg, the telemetry, YawVR and the tracker are brought up in the background
+		RunStartupTasks(g_StartupTasks, sizeof(g_StartupTasks) / sizeof(g_StartupTasks[0]));
+		log_debug("[Startup] DllMain attach took %0.3fms", 1000.0 * QPCToSeconds(GetQPCTime() - attachStart));
 		break;
 	case DLL_THREAD_ATTACH:
 	case DLL_THREAD_DETACH:
 		break;
 	case DLL_PROCESS_DETACH:
 		log_debug("Unloading Cockpitlook hook");
-		if (g_bUDPEnabled) CloseUDP();
+		if (g_bUDPEnabled && IsTelemetryReady()) CloseUDP();
 		if (YawVR::bEnabled) YawVR::Shutdown();
+		// We hold the loader lock here, so on FreeLibrary our threads can't finish exiting: all
+		// of them are told to stop first and then share a single second of waiting. At process
+		// exit (lpReserved != NULL) they're already gone and there's nothing to wait for.
+		SignalDeviceManagerStop();
+		SignalTrackerSamplerStop();
+		detachDeadline = GetQPCTime() + (lpReserved != NULL ? 0 : GetQPCFrequency());
+		StopTrackerSampler(MillisecondsUntil(detachDeadline));
+		StopTrackerCapture();
 #if DEBUG_INERTIA == 1
 		WriteInertiaData();
 #endif
-		switch (g_TrackerType) {
-		case TRACKER_FREEPIE:
-			ShutdownFreePIE();
-			break;
-		case TRACKER_STEAMVR:
-			// We can't shutdown SteamVR twice: we either shut it down here, or in ddraw.dll.
-			// It looks like the right order is to shut it down here.
-
-			// For some reason, sometimes xwingalliance.exe just stays running in the background
-			// after exiting. It seems to get hung when shutting down SteamVR. This block will
-			// forcefully exit the game if "force_steamvr_shutdown" is set in CockpitLook.cfg
-			if (g_bForceSteamVRShutdown) {
-				if (g_bSteamVRPosFromFreePIE)
-					ShutdownFreePIE();
-				ExitProcess(0);
-			}
-			ShutdownSteamVR();
-			if (g_bSteamVRPosFromFreePIE)
-				ShutdownFreePIE();
-			break;
-		case TRACKER_TRACKIR:
-			ShutdownTrackIR();
-			break;
-		case TRACKER_NONE:
-			if (g_FreePIEOutputSlot != -1)
-				ShutdownFreePIE();
-			break;
-		}
+		StopDeviceManager(MillisecondsUntil(detachDeadline));
 		log_debug("Exiting Cockpitlook hook");
 		break;
 	}
@@ -9,6 +9,8 @@ extern const char* TRACKER_TYPE; // Defines which tracker to use
 extern const char* TRACKER_TYPE_FREEPIE; // Use FreePIE as the tracker
 extern const char* TRACKER_TYPE_STEAMVR; // Use SteamVR as the tracker
 extern const char* TRACKER_TYPE_TRACKIR; // Use TrackIR (or OpenTrack) as the tracker
+extern const char* TRACKER_TYPE_OPENTRACK; // Receive OpenTrack's "UDP over network" output
+extern const char* TRACKER_TYPE_FUSION; // Rotation and position from two different trackers
 extern const char* TRACKER_TYPE_NONE;
 extern const char* DISABLE_HANGAR_RANDOM_CAMERA;
 extern const char* YAW_MULTIPLIER;
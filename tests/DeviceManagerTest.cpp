@@ -0,0 +1,254 @@
+/*
+ * The device manager driven by fake device backends: bring-up, retries, switching devices,
+ * shutting down with the config the device was brought up with, reads that never block, and
+ * stopping a stuck manager and sampler together the way DllMain does, in a single wait.
+ */
+#include <atomic>
+#include <vector>
+#include "Test.h"
+#include "DeviceManager.h"
+#include "Threading.h"
+#include "TrackerSampler.h"
+
+enum FakeDevice { FAKE_A = 1, FAKE_B = 2, FAKE_FAILING = 3, FAKE_SLOW = 4 };
+
+struct FakeCall {
+	bool bInit;
+	TrackerDeviceConfig config;
+	bool bUnloading;
+};
+
+static Mutex g_CallsLock;
+static std::vector<FakeCall> g_Calls;
+static std::atomic<int> g_iFailuresLeft(0);
+static std::atomic<bool> g_bReleaseSlowInit(false);
+
+static void RecordCall(bool bInit, const TrackerDeviceConfig &config, bool bUnloading)
+{
+	g_CallsLock.Lock();
+	g_Calls.push_back({ bInit, config, bUnloading });
+	g_CallsLock.Unlock();
+}
+
+static std::vector<FakeCall> TakeCalls()
+{
+	g_CallsLock.Lock();
+	std::vector<FakeCall> calls;
+	calls.swap(g_Calls);
+	g_CallsLock.Unlock();
+	return calls;
+}
+
+static bool FakeInit(const TrackerDeviceConfig &config)
+{
+	RecordCall(true, config, false);
+	if (config.device == FAKE_FAILING && g_iFailuresLeft > 0) {
+		g_iFailuresLeft--;
+		return false;
+	}
+	if (config.device == FAKE_SLOW)
+		while (!g_bReleaseSlowInit)
+			SleepMs(1);
+	return true;
+}
+
+static void FakeShutdown(const TrackerDeviceConfig &config, bool bUnloading)
+{
+	RecordCall(false, config, bUnloading);
+}
+
+static TrackerDeviceConfig MakeConfig(int device, int rotationSource = NO_TRACKER_DEVICE, int positionSource = NO_TRACKER_DEVICE)
+{
+	TrackerDeviceConfig config;
+	config.device = device;
+	config.rotationSource = rotationSource;
+	config.positionSource = positionSource;
+	return config;
+}
+
+// Waits for the manager to reach a state, up to timeoutMs
+static bool WaitForState(TrackerDeviceState state, unsigned int timeoutMs)
+{
+	const LONGLONG start = GetQPCTime();
+	while (GetTrackerDeviceState() != state) {
+		if (QPCToSeconds(GetQPCTime() - start) * 1000.0 > timeoutMs)
+			return false;
+		SleepMs(1);
+	}
+	return true;
+}
+
+static void TestBringUpAndSwitch()
+{
+	RequestTrackerDevice(MakeConfig(FAKE_A));
+	CHECK(WaitForState(DEVICE_STATE_READY, 1000));
+	CHECK(BeginTrackerDeviceRead());
+	EndTrackerDeviceRead();
+
+	RequestTrackerDevice(MakeConfig(FAKE_B));
+	SleepMs(50);
+	CHECK(WaitForState(DEVICE_STATE_READY, 1000));
+	std::vector<FakeCall> calls = TakeCalls();
+	CHECK(calls.size() == 3);
+	if (calls.size() == 3) {
+		CHECK(calls[0].bInit && calls[0].config.device == FAKE_A);
+		CHECK(!calls[1].bInit && calls[1].config.device == FAKE_A && !calls[1].bUnloading);
+		CHECK(calls[2].bInit && calls[2].config.device == FAKE_B);
+	}
+
+	// Requesting the same config again doesn't restart the device
+	RequestTrackerDevice(MakeConfig(FAKE_B));
+	SleepMs(50);
+	CHECK(TakeCalls().empty());
+}
+
+static void TestShutdownUsesTheBringUpConfig()
+{
+	// A reload that only changes the device's settings restarts it, and the old device is
+	// shut down with the settings it was started with
+	RequestTrackerDevice(MakeConfig(FAKE_A, 1, 3));
+	CHECK(WaitForState(DEVICE_STATE_READY, 1000));
+	SleepMs(20);
+	TakeCalls();
+
+	RequestTrackerDevice(MakeConfig(FAKE_A, 1, 4));
+	SleepMs(50);
+	CHECK(WaitForState(DEVICE_STATE_READY, 1000));
+	std::vector<FakeCall> calls = TakeCalls();
+	CHECK(calls.size() == 2);
+	if (calls.size() == 2) {
+		CHECK(!calls[0].bInit && calls[0].config.positionSource == 3 && !calls[0].bUnloading);
+		CHECK(calls[1].bInit && calls[1].config.positionSource == 4);
+	}
+	CHECK(GetRequestedTrackerDevice().positionSource == 4);
+}
+
+static void TestRetriesThenGivesUp()
+{
+	g_iDeviceInitRetries = 1;
+	g_iFailuresLeft = 1;
+	RequestTrackerDevice(MakeConfig(FAKE_FAILING));
+	CHECK(WaitForState(DEVICE_STATE_FAILED, 1000));
+	CHECK(!BeginTrackerDeviceRead());
+	// The first retry comes after 500ms, and it works this time
+	CHECK(WaitForState(DEVICE_STATE_READY, 2000));
+	std::vector<FakeCall> calls = TakeCalls();
+	// Shutdown of the previous device, then the two inits
+	CHECK(calls.size() == 3);
+
+	// Giving up: retried once, then nothing until a new request
+	g_iFailuresLeft = 100;
+	RequestTrackerDevice(MakeConfig(NO_TRACKER_DEVICE));
+	SleepMs(50);
+	RequestTrackerDevice(MakeConfig(FAKE_FAILING));
+	SleepMs(1200);
+	CHECK(GetTrackerDeviceState() == DEVICE_STATE_FAILED);
+	int inits = 0;
+	for (const FakeCall &call : TakeCalls())
+		if (call.bInit)
+			inits++;
+	CHECK(inits == 2);
+	g_iFailuresLeft = 0;
+	g_iDeviceInitRetries = 5;
+}
+
+static void TestReadsNeverBlock()
+{
+	// While a device is being brought up, readers get a "no" right away
+	g_bReleaseSlowInit = false;
+	RequestTrackerDevice(MakeConfig(FAKE_SLOW));
+	CHECK(WaitForState(DEVICE_STATE_STARTING, 1000));
+	double maxMs = 0.0;
+	int successes = 0;
+	for (int i = 0; i < 100000; i++) {
+		const LONGLONG t0 = GetQPCTime();
+		if (BeginTrackerDeviceRead()) {
+			successes++;
+			EndTrackerDeviceRead();
+		}
+		const double ms = 1000.0 * QPCToSeconds(GetQPCTime() - t0);
+		if (ms > maxMs)
+			maxMs = ms;
+	}
+	printf("Slowest read attempt during bring-up: %0.3fms\n", maxMs);
+	CHECK(successes == 0);
+	CHECK(maxMs < 20.0);
+	g_bReleaseSlowInit = true;
+	CHECK(WaitForState(DEVICE_STATE_READY, 1000));
+	CHECK(BeginTrackerDeviceRead());
+	EndTrackerDeviceRead();
+	TakeCalls();
+}
+
+static void TestStopUnloads()
+{
+	RequestTrackerDevice(MakeConfig(FAKE_B));
+	CHECK(WaitForState(DEVICE_STATE_READY, 1000));
+	SleepMs(20);
+	TakeCalls();
+	StopDeviceManager();
+	std::vector<FakeCall> calls = TakeCalls();
+	CHECK(calls.size() == 1);
+	if (calls.size() == 1)
+		CHECK(!calls[0].bInit && calls[0].config.device == FAKE_B && calls[0].bUnloading);
+	CHECK(GetTrackerDeviceState() == DEVICE_STATE_DOWN);
+}
+
+// A tracker read stuck in the "driver" for 1.5s
+static bool StuckTrackerRead(TrackerSample *sample)
+{
+	SleepMs(1500);
+	return false;
+}
+
+static unsigned int MillisecondsUntil(LONGLONG deadline)
+{
+	const LONGLONG now = GetQPCTime();
+	return deadline > now ? (unsigned int)(1000.0 * QPCToSeconds(deadline - now)) + 1 : 0;
+}
+
+static void TestStopStuckThreadsInOneWait()
+{
+	// Neither thread can exit within the second DllMain allows: the sampler is stuck in a
+	// read, and the manager in a device's init
+	CHECK(StartDeviceManager(FakeInit, FakeShutdown));
+	g_bReleaseSlowInit = false;
+	RequestTrackerDevice(MakeConfig(FAKE_SLOW));
+	CHECK(WaitForState(DEVICE_STATE_STARTING, 1000));
+	CHECK(StartTrackerSampler(StuckTrackerRead));
+	SleepMs(20);
+
+	// Both are told to stop first, then share the one second, instead of a second each
+	const LONGLONG t0 = GetQPCTime();
+	SignalDeviceManagerStop();
+	SignalTrackerSamplerStop();
+	const LONGLONG deadline = t0 + GetQPCFrequency();
+	StopTrackerSampler(MillisecondsUntil(deadline));
+	StopDeviceManager(MillisecondsUntil(deadline));
+	const double stopSeconds = QPCToSeconds(GetQPCTime() - t0);
+	printf("Stopping a stuck sampler and device manager took %0.3fs\n", stopSeconds);
+	CHECK(stopSeconds > 0.9);
+	CHECK(stopSeconds < 1.3);
+	CHECK(!IsTrackerSamplerRunning());
+	// The device that was still coming up is left alone
+	std::vector<FakeCall> calls = TakeCalls();
+	CHECK(calls.size() == 1);
+	if (calls.size() == 1)
+		CHECK(calls[0].bInit && calls[0].config.device == FAKE_SLOW);
+
+	// Let the stray threads finish before the process exits
+	g_bReleaseSlowInit = true;
+	SleepMs(1000);
+}
+
+int main()
+{
+	CHECK(StartDeviceManager(FakeInit, FakeShutdown));
+	TestBringUpAndSwitch();
+	TestShutdownUsesTheBringUpConfig();
+	TestRetriesThenGivesUp();
+	TestReadsNeverBlock();
+	TestStopUnloads();
+	TestStopStuckThreadsInOneWait();
+	return TestResult();
+}
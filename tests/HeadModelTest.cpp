@@ -0,0 +1,171 @@
+/*
+ * The spring-damper head model behind the cockpit inertia: stable at any frame time and
+ * stiffness, close to frame-rate independent, and smooth when the hook is called several
+ * times per frame, as long as only the first call of each frame steps it (see
+ * ComputeInertia()). Plus the cost of an update.
+ */
+#include "Test.h"
+#include "HeadModel.h"
+#include "FrameClock.h"
+
+// Yaw rate step at t = 0.1s, peak and final displacement after 'seconds'
+static bool RunStep(HeadModel &model, double dt, double seconds, float *peak, float *final)
+{
+	float v[HEAD_AXIS_COUNT] = { 0 };
+	model.Reset(v);
+	bool bFinite = true;
+	*peak = 0.0f;
+	for (double t = 0.0; t < seconds; ) {
+		t += dt;
+		v[HEAD_AXIS_YAW] = t > 0.1 ? 1.0f : 0.0f;
+		model.Update(v, (float)dt);
+		const float p = model.GetDisplacement(HEAD_AXIS_YAW);
+		if (!isfinite(p) || fabsf(p) > 10.0f)
+			bFinite = false;
+		if (fabsf(p) > *peak)
+			*peak = fabsf(p);
+	}
+	*final = model.GetDisplacement(HEAD_AXIS_YAW);
+	return bFinite;
+}
+
+static void TestStability()
+{
+	// From a hook called twice in a row to a long stall
+	const double dts[] = { 1e-5, 1.0 / 240, 1.0 / 60, 1.0 / 30, 0.25, 1.9 };
+	for (double dt : dts) {
+		HeadModel model;
+		float peak, final;
+		CHECK(RunStep(model, dt, dt < 1e-4 ? 0.5 : 4.0, &peak, &final));
+		printf("dt=%-9g peak=%0.4f final=%0.5f\n", dt, peak, final);
+	}
+
+	// Stiffness way beyond what the internal rate can integrate
+	const float stiffnesses[] = { 1e4f, 1e7f };
+	for (float k : stiffnesses) {
+		HeadModel model;
+		model.stiffness = k;
+		float v[HEAD_AXIS_COUNT] = { 0 };
+		model.Reset(v);
+		bool bFinite = true;
+		for (int i = 0; i < 1000; i++) {
+			v[HEAD_AXIS_YAW] = (float)((i / 10) % 2);
+			model.Update(v, 0.05f);
+			const float p = model.GetDisplacement(HEAD_AXIS_YAW);
+			if (!isfinite(p) || fabsf(p) > 10.0f)
+				bFinite = false;
+		}
+		CHECK(bFinite);
+	}
+}
+
+static void TestSettlesAndIsFrameRateIndependent()
+{
+	// The head swings when the ship starts turning and settles while it keeps turning
+	float peak60, final60;
+	HeadModel model;
+	CHECK(RunStep(model, 1.0 / 60, 4.0, &peak60, &final60));
+	CHECK(peak60 > 0.01f);
+	CHECK(fabsf(final60) < 0.01f * peak60);
+
+	const double fps[] = { 30.0, 144.0, 240.0 };
+	for (double f : fps) {
+		float peak, final;
+		CHECK(RunStep(model, 1.0 / f, 4.0, &peak, &final));
+		CHECK_NEAR(peak, peak60, 0.05 * peak60);
+	}
+}
+
+/*
+ * The ship turns back and forth. Every frame reaches the hook one to three times, a few
+ * microseconds apart. Stepping the model on every call sees a zero velocity on the repeated
+ * calls (the heading hasn't changed); stepping it on the first call of each frame, with the
+ * velocity over the whole frame, matches a game that calls it once per frame.
+ */
+static void TestRepeatedCallsInAFrame()
+{
+	const LONGLONG frameTicks = (LONGLONG)((1.0 / 60) / QPCToSeconds(1));
+	const LONGLONG repeatTicks = (LONGLONG)(20e-6 / QPCToSeconds(1));
+	const float frame = (float)QPCToSeconds(frameTicks);
+	TestRandom random(23);
+
+	HeadModel once, perFrame, perCall;
+	float v[HEAD_AXIS_COUNT] = { 0 };
+	once.Reset(v);
+	perFrame.Reset(v);
+	perCall.Reset(v);
+	FrameClock clock;
+	unsigned int steppedFrame = clock.GetFrameId();
+	LONGLONG now = 1000000, steppedT = now, lastCallT = now;
+	double heading = 0.0, steppedHeading = 0.0, lastCallHeading = 0.0;
+	float perFrameError = 0.0f, perCallError = 0.0f;
+
+	for (int i = 0; i < 600; i++) {
+		now += frameTicks;
+		const float rate = sinf(i * 0.05f);
+		heading += rate * frame;
+		v[HEAD_AXIS_YAW] = rate;
+		once.Update(v, frame);
+		const float reference = once.GetDisplacement(HEAD_AXIS_YAW);
+
+		const int calls = 1 + (int)(random.Next() % 3);
+		for (int c = 0; c < calls; c++) {
+			const LONGLONG t = now + c * repeatTicks;
+			clock.BeginCall(t);
+
+			// Every call: the velocity since the previous call
+			const float callDt = (float)QPCToSeconds(t - lastCallT);
+			const float callV[HEAD_AXIS_COUNT] = { (float)((heading - lastCallHeading) / callDt), 0, 0, 0 };
+			perCall.Update(callV, callDt);
+			lastCallT = t;
+			lastCallHeading = heading;
+
+			// First call of each frame: the velocity since the last frame
+			if (clock.GetFrameId() != steppedFrame) {
+				const float frameDt = (float)QPCToSeconds(t - steppedT);
+				const float frameV[HEAD_AXIS_COUNT] = { (float)((heading - steppedHeading) / frameDt), 0, 0, 0 };
+				perFrame.Update(frameV, frameDt);
+				steppedFrame = clock.GetFrameId();
+				steppedT = t;
+				steppedHeading = heading;
+			}
+
+			const float pc = fabsf(perCall.GetDisplacement(HEAD_AXIS_YAW) - reference);
+			const float pf = fabsf(perFrame.GetDisplacement(HEAD_AXIS_YAW) - reference);
+			if (pc > perCallError) perCallError = pc;
+			if (pf > perFrameError) perFrameError = pf;
+		}
+	}
+	printf("Repeated calls: off by up to %0.4f stepping on every call, %0.6f once per frame\n",
+		perCallError, perFrameError);
+	// The scenario does hit the problem
+	CHECK(clock.GetRepeatedFrames() > 0);
+	CHECK(perCallError > 0.01f);
+	CHECK(perFrameError < 1e-3f);
+}
+
+static void Benchmark()
+{
+	const double fps[] = { 60.0, 144.0 };
+	for (double f : fps) {
+		HeadModel model;
+		float v[HEAD_AXIS_COUNT] = { 0 };
+		model.Reset(v);
+		const double ns = BenchmarkNs(1000000, [&](int i) {
+			v[HEAD_AXIS_YAW] = sinf(i * 0.01f);
+			v[HEAD_AXIS_SURGE] = i * 0.1f;
+			model.Update(v, (float)(1.0 / f));
+			g_fBenchmarkSink = model.GetDisplacement(HEAD_AXIS_YAW);
+		});
+		printf("HeadModel::Update() at %.0ffps: %0.1fns\n", f, ns);
+	}
+}
+
+int main()
+{
+	TestStability();
+	TestSettlesAndIsFrameRateIndependent();
+	TestRepeatedCallsInAFrame();
+	Benchmark();
+	return TestResult();
+}
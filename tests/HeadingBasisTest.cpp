@@ -0,0 +1,252 @@
+/*
+ * The heading basis against the matrix chain GetCurrentHeadingMatrix() used to run on every
+ * call, over the whole range of XWA's angles: same Rs/Us/Fs, same matrices in both
+ * directions. The sine table is checked on every one of the 65536 angles, and the cache hands
+ * back the right basis whenever the angles or the player change. Plus the cost of the matrix
+ * chain, of the closed form and of a cache hit.
+ */
+#include "Test.h"
+#include "AngleTable.h"
+#include "HeadingBasis.h"
+
+// The old GetCurrentHeadingMatrix(), minus the game state: the craft's angles go in, the
+// basis and the matrix in the requested direction come out
+static Matrix4 ReferenceHeadingMatrix(short craftYaw, short craftPitch, short craftRoll, Vector4 &Rs, Vector4 &Us, Vector4 &Fs, bool invert)
+{
+	Matrix4 g_ReflRotX;
+	g_ReflRotX.set(
+		1.0, 0.0, 0.0, 0.0,
+		0.0, 0.0, 1.0, 0.0,
+		0.0, 1.0, 0.0, 0.0,
+		0.0, 0.0, 0.0, 1.0
+	);
+
+	const float DEG2RAD = 3.141593f / 180;
+	float yaw, pitch, roll;
+	Matrix4 rotMatrixFull, rotMatrixYaw, rotMatrixPitch, rotMatrixRoll;
+	Vector4 T, B, N;
+	yaw   = craftYaw   / 65536.0f * 360.0f;
+	pitch = craftPitch / 65536.0f * 360.0f;
+	roll  = craftRoll  / 65536.0f * 360.0f;
+
+	rotMatrixFull.identity();
+	rotMatrixYaw.identity();   rotMatrixYaw.rotateY(-yaw);
+	rotMatrixPitch.identity(); rotMatrixPitch.rotateX(-pitch);
+	rotMatrixRoll.identity();  rotMatrixRoll.rotateY(roll);
+
+	float cosTheta, cosPhi, sinTheta, sinPhi;
+	cosTheta = cos(yaw * DEG2RAD), sinTheta = sin(yaw * DEG2RAD);
+	cosPhi = cos(pitch * DEG2RAD), sinPhi = sin(pitch * DEG2RAD);
+	N.z = cosTheta * sinPhi;
+	N.x = sinTheta * sinPhi;
+	N.y = cosPhi;
+	N.w = 0;
+
+	N = rotMatrixPitch * rotMatrixYaw * N;
+	B.x = 0; B.y = 0; B.z = -1; B.w = 0;
+	T.x = 1; T.y = 0; T.z = 0; T.w = 0;
+	B = rotMatrixRoll * B;
+	T = rotMatrixRoll * T;
+	rotMatrixFull = rotMatrixPitch * rotMatrixYaw;
+	rotMatrixFull.invert();
+	T = rotMatrixFull * T;
+	B = rotMatrixFull * B;
+	N = rotMatrixFull * N;
+	Fs = g_ReflRotX * N;
+	Us = g_ReflRotX * B;
+	Rs = g_ReflRotX * T;
+	Fs.w = 0; Rs.w = 0; Us.w = 0;
+
+	Matrix4 viewMatrix;
+	if (!invert) {
+		viewMatrix = Matrix4(
+			Rs.x, Us.x, Fs.x, 0,
+			Rs.y, Us.y, Fs.y, 0,
+			Rs.z, Us.z, Fs.z, 0,
+			0, 0, 0, 1
+		);
+	}
+	else {
+		viewMatrix = Matrix4(
+			Rs.x, Rs.y, Rs.z, 0,
+			Us.x, Us.y, Us.z, 0,
+			Fs.x, Fs.y, Fs.z, 0,
+			0, 0, 0, 1
+		);
+	}
+	return viewMatrix;
+}
+
+static float MaxDiff(const Vector4 &a, const Vector4 &b)
+{
+	return fmaxf(fmaxf(fabsf(a.x - b.x), fabsf(a.y - b.y)), fmaxf(fabsf(a.z - b.z), fabsf(a.w - b.w)));
+}
+
+static float MaxDiff(const Matrix4 &a, const Matrix4 &b)
+{
+	float d = 0.0f;
+	for (int i = 0; i < 16; i++)
+		d = fmaxf(d, fabsf(a[i] - b[i]));
+	return d;
+}
+
+// Largest difference between the basis and the reference for one set of angles
+static float CompareWithReference(short yaw, short pitch, short roll)
+{
+	HeadingBasis basis;
+	ComputeHeadingBasis(yaw, pitch, roll, &basis);
+	Vector4 Rs, Us, Fs;
+	const Matrix4 toGlobal = ReferenceHeadingMatrix(yaw, pitch, roll, Rs, Us, Fs, false);
+	const Matrix4 toShip = ReferenceHeadingMatrix(yaw, pitch, roll, Rs, Us, Fs, true);
+	float d = fmaxf(MaxDiff(basis.Rs, Rs), fmaxf(MaxDiff(basis.Us, Us), MaxDiff(basis.Fs, Fs)));
+	return fmaxf(d, fmaxf(MaxDiff(basis.toGlobal, toGlobal), MaxDiff(basis.toShip, toShip)));
+}
+
+static void TestAngleTable()
+{
+	const double UNIT2RAD = 3.14159265358979323846 / 32768.0;
+	double worst = 0.0;
+	int asymmetric = 0;
+	for (int a = 0; a < 65536; a++) {
+		const unsigned short angle = (unsigned short)a;
+		worst = fmax(worst, fabs(AngleSin(angle) - sin(a * UNIT2RAD)));
+		worst = fmax(worst, fabs(AngleCos(angle) - cos(a * UNIT2RAD)));
+		// The mirrored quadrants are exact mirrors
+		if (AngleSin((unsigned short)-a) != -AngleSin(angle) || AngleCos((unsigned short)-a) != AngleCos(angle))
+			asymmetric++;
+	}
+	printf("Largest error of the sine table: %g\n", worst);
+	CHECK(worst < 1e-7);
+	CHECK(asymmetric == 0);
+	// Exact on the axes
+	CHECK(AngleSin(0) == 0.0f && AngleCos(0) == 1.0f);
+	CHECK(AngleSin(16384) == 1.0f && AngleCos(16384) == 0.0f);
+	CHECK(AngleSin(32768) == 0.0f && AngleCos(32768) == -1.0f);
+	CHECK(AngleSin(49152) == -1.0f && AngleCos(49152) == 0.0f);
+}
+
+static void TestMatchesTheReference()
+{
+	// The quadrant boundaries, where the table lookups switch over, and their neighbours
+	const short special[] = { 0, 1, -1, 8192, 16383, 16384, 16385, -16384, 32767, -32768, -32767, 24576, -8192 };
+	float worst = 0.0f;
+	for (short yaw : special)
+		for (short pitch : special)
+			for (short roll : special)
+				worst = fmaxf(worst, CompareWithReference(yaw, pitch, roll));
+
+	// A grid over the whole range, and random angles
+	for (int yaw = -32768; yaw < 32768; yaw += 1021)
+		for (int pitch = -32768; pitch < 32768; pitch += 997)
+			for (int roll = -32768; roll < 32768; roll += 4099)
+				worst = fmaxf(worst, CompareWithReference((short)yaw, (short)pitch, (short)roll));
+	TestRandom random(20);
+	for (int i = 0; i < 200000; i++)
+		worst = fmaxf(worst, CompareWithReference((short)random.Next(), (short)random.Next(), (short)random.Next()));
+	printf("Largest difference with the reference: %g\n", worst);
+	CHECK(worst < 2e-6f);
+}
+
+static void TestOrthonormal()
+{
+	TestRandom random(21);
+	float worst = 0.0f;
+	for (int i = 0; i < 100000; i++) {
+		HeadingBasis basis;
+		ComputeHeadingBasis((short)random.Next(), (short)random.Next(), (short)random.Next(), &basis);
+		// toShip undoes toGlobal
+		Matrix4 identity;
+		worst = fmaxf(worst, MaxDiff(basis.toShip * basis.toGlobal, identity));
+		worst = fmaxf(worst, fabsf(basis.Rs.dot(basis.Us)));
+		worst = fmaxf(worst, fabsf(basis.Rs.dot(basis.Fs)));
+		worst = fmaxf(worst, fabsf(basis.Us.dot(basis.Fs)));
+	}
+	printf("Largest error of toShip * toGlobal and of the dot products: %g\n", worst);
+	CHECK(worst < 1e-5f);
+}
+
+static bool SameBasis(const HeadingBasis &a, const HeadingBasis &b)
+{
+	return MaxDiff(a.Rs, b.Rs) == 0.0f && MaxDiff(a.Us, b.Us) == 0.0f && MaxDiff(a.Fs, b.Fs) == 0.0f &&
+		a.toGlobal == b.toGlobal && a.toShip == b.toShip;
+}
+
+static void TestCache()
+{
+	HeadingBasisCache cache;
+	HeadingBasis expected;
+	TestRandom random(22);
+	short yaw = 100, pitch = 16384, roll = -5;
+	int player = 0;
+	int stale = 0;
+	for (int i = 0; i < 10000; i++) {
+		// Change one thing at a time, or nothing
+		switch (random.Next() % 5) {
+		case 0: yaw += (short)(random.Next() % 64); break;
+		case 1: pitch -= (short)(random.Next() % 64); break;
+		case 2: roll ^= (short)(1 << (random.Next() % 16)); break;
+		case 3: player = random.Next() % 4; break;
+		default: break;
+		}
+		ComputeHeadingBasis(yaw, pitch, roll, &expected);
+		if (!SameBasis(cache.Get(player, yaw, pitch, roll), expected))
+			stale++;
+	}
+	CHECK(stale == 0);
+
+	// The same angles keep handing back the same basis
+	const HeadingBasis *first = &cache.Get(1, 10, 20, 30);
+	CHECK(first == &cache.Get(1, 10, 20, 30));
+	cache.Invalidate();
+	ComputeHeadingBasis(10, 20, 30, &expected);
+	CHECK(SameBasis(cache.Get(1, 10, 20, 30), expected));
+}
+
+static void Benchmark()
+{
+	short angles[1024][3];
+	TestRandom random(2);
+	for (int i = 0; i < 1024; i++)
+		for (int j = 0; j < 3; j++)
+			angles[i][j] = (short)random.Next();
+
+	Vector4 Rs, Us, Fs;
+	const double referenceNs = BenchmarkNs(1000000, [&](int i) {
+		const short *a = angles[i & 1023];
+		g_fBenchmarkSink = ReferenceHeadingMatrix(a[0], a[1], a[2], Rs, Us, Fs, (i & 1) != 0)[5];
+	});
+	HeadingBasis basis;
+	const double computeNs = BenchmarkNs(1000000, [&](int i) {
+		const short *a = angles[i & 1023];
+		ComputeHeadingBasis(a[0], a[1], a[2], &basis);
+		g_fBenchmarkSink = basis.toShip[5];
+	});
+	// The game calls it a few times per frame with the same angles
+	HeadingBasisCache cache;
+	const double cachedNs = BenchmarkNs(10000000, [&](int i) {
+		const short *a = angles[(i >> 2) & 1023];
+		g_fBenchmarkSink = cache.Get(0, a[0], a[1], a[2]).toShip[5];
+	});
+	printf("Matrix chain: %0.1fns, ComputeHeadingBasis(): %0.1fns, HeadingBasisCache::Get() with 4 calls per orientation: %0.1fns\n",
+		referenceNs, computeNs, cachedNs);
+
+	const float UNIT2RAD = 3.14159265f / 32768.0f;
+	const double tableNs = BenchmarkNs(10000000, [&](int i) {
+		g_fBenchmarkSink = AngleSin((unsigned short)angles[i & 1023][0]);
+	});
+	const double sinNs = BenchmarkNs(10000000, [&](int i) {
+		g_fBenchmarkSink = sinf(angles[i & 1023][0] * UNIT2RAD);
+	});
+	printf("AngleSin(): %0.1fns, sinf(): %0.1fns\n", tableNs, sinNs);
+}
+
+int main()
+{
+	InitAngleTable();
+	TestAngleTable();
+	TestMatchesTheReference();
+	TestOrthonormal();
+	TestCache();
+	Benchmark();
+	return TestResult();
+}
@@ -0,0 +1,210 @@
+/*
+ * JitterEstimator and the automatic filter cutoff on synthetic tracker noise: the estimate
+ * finds the noise of a still or moving head, isn't thrown off by quick head turns, wrapping
+ * angles or gaps, and the cutoff it picks brings the noise down to the target. Plus how many
+ * samples the estimate needs to settle and its cost per sample.
+ */
+#include "Test.h"
+#include "PoseFilter.h"
+
+static LONGLONG SecondsToTicks(double seconds)
+{
+	return (LONGLONG)(seconds / QPCToSeconds(1));
+}
+
+// A slow head movement: a few degrees back and forth every couple of seconds
+static float SlowMotion(double t)
+{
+	return (float)(5.0 * sin(2.7 * t) + 2.0 * sin(0.9 * t + 1.0));
+}
+
+// Feeds seconds of samples at rate Hz, with Gaussian noise of sigma over signal(t)
+template<class Signal>
+static void Feed(JitterEstimator *estimator, TestRandom *random, double rate, double seconds, float sigma, bool isAngle, Signal signal)
+{
+	const int n = (int)(rate * seconds);
+	for (int i = 0; i < n; i++)
+		estimator->AddSample(signal(i / rate) + sigma * random->Gaussian(), (float)(1.0 / rate), isAngle);
+}
+
+static void TestStillAndMovingHead()
+{
+	const double rates[] = { 60.0, 120.0, 500.0 };
+	const float sigmas[] = { 0.01f, 0.05f, 0.2f };
+	for (double rate : rates)
+		for (float sigma : sigmas) {
+			TestRandom random(11);
+			JitterEstimator still;
+			Feed(&still, &random, rate, 10.0, sigma, false, [](double) { return 0.0f; });
+			CHECK_NEAR(still.GetNoise() / sigma, 1.0, 0.1);
+			CHECK_NEAR(still.GetSampleRate(), rate, 0.01 * rate);
+			CHECK(still.IsReady());
+
+			// Constant speed cancels out in the second difference
+			JitterEstimator ramp;
+			Feed(&ramp, &random, rate, 10.0, sigma, false, [](double t) { return (float)(30.0 * t); });
+			CHECK_NEAR(ramp.GetNoise() / sigma, 1.0, 0.1);
+
+			// A slow turn adds very little: its second difference is tiny at these rates
+			JitterEstimator moving;
+			Feed(&moving, &random, rate, 10.0, sigma, true, SlowMotion);
+			CHECK_NEAR(moving.GetNoise() / sigma, 1.0, 0.15);
+		}
+}
+
+static void TestQuickTurnsAreClipped()
+{
+	// A still head with a 30 degree snap every two seconds: each snap is two huge second
+	// differences, which are clipped at 3 sigma
+	TestRandom random(5);
+	const float sigma = 0.05f;
+	JitterEstimator estimator;
+	for (int i = 0; i < 120 * 20; i++) {
+		const float target = (i / 240) % 2 == 0 ? 0.0f : 30.0f;
+		estimator.AddSample(target + sigma * random.Gaussian(), 1.0f / 120.0f, true);
+	}
+	printf("Noise with quick turns: %0.4f (real %0.4f)\n", estimator.GetNoise(), sigma);
+	CHECK(estimator.GetNoise() < 1.5f * sigma);
+	CHECK(estimator.GetNoise() > 0.8f * sigma);
+}
+
+static void TestWrapAndGaps()
+{
+	// Noise around +/-180 degrees is still small noise
+	TestRandom random(9);
+	const float sigma = 0.05f;
+	JitterEstimator wrapping;
+	Feed(&wrapping, &random, 120.0, 10.0, sigma, true, [](double) { return 180.0f; });
+	CHECK_NEAR(wrapping.GetNoise() / sigma, 1.0, 0.1);
+
+	// A gap (dt = 0) starts the differences over instead of seeing a jump
+	JitterEstimator gaps;
+	for (int i = 0; i < 1200; i++) {
+		const float offset = (float)(i / 100) * 10.0f;
+		const float dt = i % 100 == 0 ? 0.0f : 1.0f / 120.0f;
+		gaps.AddSample(offset + sigma * random.Gaussian(), dt, false);
+	}
+	CHECK_NEAR(gaps.GetNoise() / sigma, 1.0, 0.15);
+
+	// Reset() forgets everything
+	gaps.Reset();
+	CHECK(!gaps.IsReady());
+	CHECK(gaps.GetNoise() == 0.0f);
+}
+
+// Standard deviation of the filter output on a still head, once the cutoff has settled
+static float OutputNoise(PoseFilter *filter, float sigma, double rate, unsigned int seed)
+{
+	TestRandom random(seed);
+	double sum = 0.0, sum2 = 0.0;
+	int n = 0;
+	const int samples = (int)(rate * 120.0);
+	for (int i = 0; i < samples; i++) {
+		TrackerSample s;
+		s.timestamp = SecondsToTicks(i / rate);
+		s.yaw = s.pitch = s.roll = sigma * random.Gaussian();
+		s.x = s.y = s.z = 0.0f;
+		s.valid = true;
+		filter->Apply(&s);
+		if (i >= samples / 2) {
+			sum += s.yaw;
+			sum2 += s.yaw * s.yaw;
+			n++;
+		}
+	}
+	const double mean = sum / n;
+	return (float)sqrt(sum2 / n - mean * mean);
+}
+
+static void TestAutoCutoffReachesTheTarget()
+{
+	const double rates[] = { 60.0, 120.0, 500.0 };
+	const float sigmas[] = { 0.05f, 0.1f, 0.3f };
+	for (double rate : rates) {
+		float lastCutoff = 1e9f;
+		for (float sigma : sigmas) {
+			PoseFilter filter;
+			filter.autoCutoff = true;
+			// Only the min cutoff, so the output noise can be compared with the target
+			filter.rotBeta = 0.0f;
+			filter.rotNoiseTarget = 0.02f;
+			filter.minAutoCutoff = 0.01f;
+			filter.maxAutoCutoff = 50.0f;
+			const float out = OutputNoise(&filter, sigma, rate, 21);
+			const float cutoff = filter.GetCutoff(POSE_AXIS_YAW);
+			printf("%3.0fHz, noise %0.2f: cutoff %0.3fHz, output noise %0.4f\n", rate, sigma, cutoff, out);
+			CHECK_NEAR(out / filter.rotNoiseTarget, 1.0, 0.2);
+			// More noise, lower cutoff
+			CHECK(cutoff < lastCutoff);
+			lastCutoff = cutoff;
+		}
+	}
+
+	// Quieter than the target: the cutoff goes all the way up
+	PoseFilter quiet;
+	quiet.autoCutoff = true;
+	OutputNoise(&quiet, 0.005f, 120.0, 4);
+	CHECK(quiet.GetCutoff(POSE_AXIS_YAW) == quiet.maxAutoCutoff);
+	// Very noisy: clamped to the minimum
+	PoseFilter noisy;
+	noisy.autoCutoff = true;
+	OutputNoise(&noisy, 5.0f, 120.0, 4);
+	CHECK(noisy.GetCutoff(POSE_AXIS_YAW) == noisy.minAutoCutoff);
+	// Off: the manual cutoff
+	PoseFilter manual;
+	OutputNoise(&manual, 0.3f, 120.0, 4);
+	CHECK(manual.GetCutoff(POSE_AXIS_YAW) == manual.rotMinCutoff);
+}
+
+// Samples until the estimate is first within 20% of the real noise. It keeps wandering by
+// about that much afterwards: it only averages timeConstant seconds of samples.
+static int SamplesToConverge(double rate, float sigma, unsigned int seed)
+{
+	TestRandom random(seed);
+	JitterEstimator estimator;
+	for (int i = 0; i < (int)(rate * 20.0); i++) {
+		estimator.AddSample(SlowMotion(i / rate) + sigma * random.Gaussian(), (float)(1.0 / rate), true);
+		if (estimator.IsReady() && fabsf(estimator.GetNoise() / sigma - 1.0f) < 0.2f)
+			return i + 1;
+	}
+	return -1;
+}
+
+static void Benchmark()
+{
+	const double rates[] = { 60.0, 120.0, 500.0 };
+	for (double rate : rates) {
+		// Median over a few seeds, the settling point depends a lot on the noise
+		int samples[9];
+		for (int seed = 0; seed < 9; seed++) {
+			samples[seed] = SamplesToConverge(rate, 0.05f, 100 + seed);
+			for (int j = seed; j > 0 && samples[j] < samples[j - 1]; j--) {
+				const int tmp = samples[j]; samples[j] = samples[j - 1]; samples[j - 1] = tmp;
+			}
+		}
+		printf("Noise estimate within 20%% at %3.0fHz: %d samples (%0.2fs), median of 9\n",
+			rate, samples[4], samples[4] / rate);
+		CHECK(samples[4] > 0);
+	}
+
+	JitterEstimator estimator;
+	TestRandom random(1);
+	float values[1024];
+	for (int i = 0; i < 1024; i++)
+		values[i] = SlowMotion(i / 120.0) + 0.05f * random.Gaussian();
+	const double ns = BenchmarkNs(10000000, [&](int i) {
+		estimator.AddSample(values[i & 1023], 1.0f / 120.0f, true);
+	});
+	g_fBenchmarkSink = estimator.GetNoise();
+	printf("JitterEstimator::AddSample(): %0.1fns\n", ns);
+}
+
+int main()
+{
+	TestStillAndMovingHead();
+	TestQuickTurnsAreClipped();
+	TestWrapAndGaps();
+	TestAutoCutoffReachesTheTarget();
+	Benchmark();
+	return TestResult();
+}
@@ -0,0 +1,177 @@
+/*
+ * The keyboard lean, driven by synthetic key timelines at 30, 60, 144 and 240 fps: the lean
+ * covers the same distance at every frame rate, never overshoots its target, comes back to
+ * exactly 0 without sticky lean, stays put with it, and respects the limit. Plus the cost of a
+ * tick, and the distance the old per-frame steps covered at each frame rate.
+ */
+#include "Test.h"
+#include "LeanAnim.h"
+
+const int FRAME_RATES[] = { 30, 60, 144, 240 };
+constexpr float MAX_LEAN = 25.0f;
+
+static LeanAnimSettings DefaultSettings()
+{
+	LeanAnimSettings settings;
+	settings.speed = 0.6f;
+	settings.resetSpeed = 1.2f;
+	settings.easeTime = 0.1f;
+	settings.bSticky = false;
+	settings.bLimit = true;
+	return settings;
+}
+
+// Right lean held from 0.2s to 1.2s, a short tap the other way from 1.5s to 1.6s
+static int KeyAt(double t)
+{
+	if (t >= 0.2 && t < 1.2) return 1;
+	if (t >= 1.5 && t < 1.6) return -1;
+	return 0;
+}
+
+struct LeanRun {
+	float posAtRelease;    // Position at 1.2s
+	float maxPos;
+	float minAfterRelease; // Lowest position between releasing the first key and the tap
+	float overshoot;       // Largest distance past the target in the direction it was moving
+	float final;           // Position at 4s
+	double backAtZero;     // Time the lean came back to 0 after the tap
+};
+
+// Plays the timeline at fps. The key state of a frame is the one at its middle.
+static LeanRun Play(int fps, const LeanAnimSettings &settings)
+{
+	LeanRun run = {};
+	run.minAfterRelease = 1e9f;
+	run.backAtZero = -1.0;
+	float pos = 0.0f, vel = 0.0f, target = 0.0f;
+	const double dt = 1.0 / fps;
+	for (int i = 1; i <= fps * 4; i++) {
+		const double t = i * dt;
+		const float prevPos = pos, prevTarget = target;
+		LeanAnimTick(&pos, &vel, &target, KeyAt(t - 0.5 * dt), MAX_LEAN, (float)dt, settings);
+		// Moving towards the target from either side never takes it past
+		if (prevPos < prevTarget && target >= prevTarget)
+			run.overshoot = fmaxf(run.overshoot, pos - target);
+		if (prevPos > prevTarget && target <= prevTarget)
+			run.overshoot = fmaxf(run.overshoot, target - pos);
+		if (fabs(t - 1.2) < 0.5 * dt)
+			run.posAtRelease = pos;
+		run.maxPos = fmaxf(run.maxPos, pos);
+		if (t > 1.2 && t < 1.5)
+			run.minAfterRelease = fminf(run.minAfterRelease, pos);
+		if (t > 1.6 && pos == 0.0f && run.backAtZero < 0.0)
+			run.backAtZero = t;
+	}
+	run.final = pos;
+	return run;
+}
+
+static void TestSameAtEveryFrameRate()
+{
+	const LeanAnimSettings settings = DefaultSettings();
+	const LeanRun reference = Play(60, settings);
+	for (int fps : FRAME_RATES) {
+		const LeanRun run = Play(fps, settings);
+		printf("%3dfps: %0.4f at the release, peak %0.4f, back at 0 after %0.3fs\n", fps,
+			run.posAtRelease, run.maxPos, run.backAtZero);
+		// One second at 0.6 units per second, minus what the easing still trails behind; each
+		// rate sees the key change at a slightly different time, up to half a frame apart
+		CHECK_NEAR(run.posAtRelease, reference.posAtRelease, 0.01f);
+		CHECK_NEAR(run.maxPos, reference.maxPos, 0.01f);
+		CHECK(run.posAtRelease > 0.5f && run.posAtRelease < 0.6f);
+		CHECK(run.overshoot == 0.0f);
+		// The way back doesn't cross 0 before the tap...
+		CHECK(run.minAfterRelease >= 0.0f);
+		// ... and after the tap it lands on 0 exactly, in about the same time
+		CHECK(run.final == 0.0f);
+		CHECK(run.backAtZero > 0.0);
+		CHECK_NEAR(run.backAtZero, reference.backAtZero, 0.05);
+	}
+}
+
+static void TestSticky()
+{
+	LeanAnimSettings settings = DefaultSettings();
+	settings.bSticky = true;
+	for (int fps : FRAME_RATES) {
+		const LeanRun run = Play(fps, settings);
+		// Stays where the keys left it: 1s forward, 0.1s back
+		CHECK_NEAR(run.final, 0.6f - 0.06f, 0.01f);
+		CHECK(run.overshoot == 0.0f);
+		CHECK(run.minAfterRelease >= run.posAtRelease);
+	}
+}
+
+static void TestLimit()
+{
+	LeanAnimSettings settings = DefaultSettings();
+	settings.bSticky = true;
+	float pos = 0.0f, vel = 0.0f, target = 0.0f;
+	for (int i = 0; i < 60 * 60; i++)
+		LeanAnimTick(&pos, &vel, &target, -1, 2.0f, 1.0f / 60.0f, settings);
+	CHECK(target == -2.0f);
+	CHECK(pos == -2.0f);
+
+	settings.bLimit = false;
+	for (int i = 0; i < 60 * 10; i++)
+		LeanAnimTick(&pos, &vel, &target, -1, 2.0f, 1.0f / 60.0f, settings);
+	CHECK(target < -7.0f);
+}
+
+static void TestUnevenFramesAndEdgeCases()
+{
+	// Frame times jumping between 3ms and 40ms: same lean at the release as at 240fps
+	const LeanAnimSettings settings = DefaultSettings();
+	const LeanRun reference = Play(240, settings);
+	TestRandom random(25);
+	float pos = 0.0f, vel = 0.0f, target = 0.0f;
+	double t = 0.0;
+	while (t < 1.2) {
+		const double dt = fmin(random.Uniform(0.003f, 0.040f), 1.2 - t);
+		t += dt;
+		LeanAnimTick(&pos, &vel, &target, KeyAt(t - 0.5 * dt), MAX_LEAN, (float)dt, settings);
+	}
+	CHECK_NEAR(pos, reference.posAtRelease, 0.02f);
+
+	// dt = 0 (the first frame) doesn't move anything
+	const float before = pos, targetBefore = target;
+	LeanAnimTick(&pos, &vel, &target, 1, MAX_LEAN, 0.0f, settings);
+	CHECK(pos == before && target == targetBefore);
+
+	// No easing: the position is the target
+	LeanAnimSettings instant = settings;
+	instant.easeTime = 0.0f;
+	pos = vel = target = 0.0f;
+	LeanAnimTick(&pos, &vel, &target, 1, MAX_LEAN, 0.5f, instant);
+	CHECK(pos == target);
+	CHECK_NEAR(pos, 0.3f, 1e-6f);
+}
+
+static void Benchmark()
+{
+	// The old animTickX() moved the lean 0.01 per frame while the key was held
+	for (int fps : FRAME_RATES) {
+		const float oldDistance = 0.01f * fps;
+		printf("%3dfps: one second of lean covered %0.2f with the old per-frame steps, %0.2f now\n",
+			fps, oldDistance, Play(fps, DefaultSettings()).posAtRelease);
+	}
+
+	const LeanAnimSettings settings = DefaultSettings();
+	float pos = 0.0f, vel = 0.0f, target = 0.0f;
+	const double ns = BenchmarkNs(10000000, [&](int i) {
+		LeanAnimTick(&pos, &vel, &target, (i >> 8) % 3 - 1, MAX_LEAN, 1.0f / 144.0f, settings);
+		g_fBenchmarkSink = pos;
+	});
+	printf("LeanAnimTick(): %0.1fns\n", ns);
+}
+
+int main()
+{
+	TestSameAtEveryFrameRate();
+	TestSticky();
+	TestLimit();
+	TestUnevenFramesAndEdgeCases();
+	Benchmark();
+	return TestResult();
+}
@@ -0,0 +1,75 @@
+/*
+ * The OpenTrack receiver fed through the loopback interface with SendOpenTrackPose(): what
+ * ReadOpenTrackSample() returns, and that a tracker that stops sending goes stale.
+ */
+#include "Test.h"
+#include "OpenTrack.h"
+#include "Threading.h"
+
+// Away from OpenTrack's default port, in case it's running
+constexpr int TEST_PORT = 24242;
+
+// Waits up to timeoutMs for a sample with the given yaw
+static bool WaitForYaw(float yaw, TrackerSample *sample, unsigned int timeoutMs)
+{
+	for (unsigned int ms = 0; ms < timeoutMs; ms++) {
+		if (ReadOpenTrackSample(sample) && sample->yaw == yaw)
+			return true;
+		SleepMs(1);
+	}
+	return false;
+}
+
+static void TestLoopback()
+{
+	const double pose[6] = { 1.5, -2.25, 3.0, 45.0, -10.5, 5.25 };
+	CHECK(SendOpenTrackPose("127.0.0.1", TEST_PORT, pose));
+	TrackerSample sample;
+	CHECK(WaitForYaw(45.0f, &sample, 1000));
+	CHECK(sample.valid);
+	CHECK(sample.x == 1.5f && sample.y == -2.25f && sample.z == 3.0f);
+	CHECK(sample.yaw == 45.0f && sample.pitch == -10.5f && sample.roll == 5.25f);
+
+	// The newest pose wins
+	const double next[6] = { 0.0, 0.0, 0.0, -90.0, 0.0, 0.0 };
+	CHECK(SendOpenTrackPose("127.0.0.1", TEST_PORT, next));
+	CHECK(WaitForYaw(-90.0f, &sample, 1000));
+	CHECK(sample.x == 0.0f && sample.pitch == 0.0f);
+}
+
+static void TestStaleness()
+{
+	const double pose[6] = { 0.0, 0.0, 0.0, 12.0, 0.0, 0.0 };
+	CHECK(SendOpenTrackPose("127.0.0.1", TEST_PORT, pose));
+	TrackerSample sample;
+	CHECK(WaitForYaw(12.0f, &sample, 1000));
+
+	// Still fresh a bit later, lost once nothing has arrived for OPENTRACK_TIMEOUT (0.5s)
+	SleepMs(200);
+	CHECK(ReadOpenTrackSample(&sample));
+	SleepMs(500);
+	CHECK(!ReadOpenTrackSample(&sample));
+
+	// ... and back as soon as the tracker sends again
+	CHECK(SendOpenTrackPose("127.0.0.1", TEST_PORT, pose));
+	CHECK(WaitForYaw(12.0f, &sample, 1000));
+}
+
+int main()
+{
+	g_iOpenTrackPort = TEST_PORT;
+	if (!InitOpenTrack()) {
+		printf("Could not listen on UDP port %d\n", TEST_PORT);
+		return 1;
+	}
+	// Nothing received yet
+	TrackerSample sample;
+	CHECK(!ReadOpenTrackSample(&sample));
+	TestLoopback();
+	TestStaleness();
+	ShutdownOpenTrack();
+	// The port can be taken again
+	CHECK(InitOpenTrack());
+	ShutdownOpenTrack();
+	return TestResult();
+}
@@ -0,0 +1,152 @@
+/*
+ * PoseFilter and its One-Euro filters: noise is smoothed, fast motion goes through with little
+ * lag, angles wrap around, and the output only depends on the samples, not on how often the
+ * game asks. Plus the cost per sample and the lag on a head turn.
+ */
+#include "Test.h"
+#include "PoseFilter.h"
+
+static LONGLONG SecondsToTicks(double seconds)
+{
+	return (LONGLONG)(seconds / QPCToSeconds(1));
+}
+
+static TrackerSample MakeSample(double t, float value)
+{
+	TrackerSample s;
+	s.timestamp = SecondsToTicks(t);
+	s.yaw = s.pitch = s.roll = value;
+	s.x = s.y = s.z = value;
+	s.valid = true;
+	return s;
+}
+
+static void TestSmoothsNoise()
+{
+	// A still head read at 120Hz with 0.1 units of noise
+	PoseFilter filter;
+	TestRandom random(3);
+	double rawSum = 0.0, outSum = 0.0;
+	int n = 0;
+	for (int i = 0; i < 1200; i++) {
+		TrackerSample s = MakeSample(i / 120.0, 0.0f);
+		s.yaw = s.x = 0.1f * random.Gaussian();
+		const float raw = s.yaw;
+		filter.Apply(&s);
+		if (i >= 120) {
+			rawSum += raw * raw;
+			outSum += s.yaw * s.yaw;
+			n++;
+		}
+	}
+	const double rawNoise = sqrt(rawSum / n), outNoise = sqrt(outSum / n);
+	printf("Still head: noise %0.4f in, %0.4f out\n", rawNoise, outNoise);
+	CHECK(outNoise < 0.3 * rawNoise);
+}
+
+// How far behind the filter is on a turn at 'speed' units per second, once it's settled
+static float LagOnRamp(float beta, float speed, double rate)
+{
+	OneEuroFilter filter;
+	float lag = 0.0f;
+	const float dt = (float)(1.0 / rate);
+	for (int i = 0; i < (int)rate; i++) {
+		const float x = speed * i * dt;
+		lag = x - filter.Filter(x, dt, 1.0f, beta, 1.0f, false);
+	}
+	return lag / speed;
+}
+
+static void TestFastMotionGoesThrough()
+{
+	// Without beta it's a plain 1Hz low-pass: 1/(2*pi*1Hz) = 159ms behind
+	const float plain = LagOnRamp(0.0f, 100.0f, 120.0);
+	const float adaptive = LagOnRamp(0.05f, 100.0f, 120.0);
+	printf("Lag at 100deg/s: %0.1fms without beta, %0.1fms with beta = 0.05\n", 1000.0f * plain, 1000.0f * adaptive);
+	CHECK_NEAR(plain, 0.159f, 0.01f);
+	CHECK(adaptive < 0.3f * plain);
+}
+
+static void TestAnglesWrap()
+{
+	// Turning through 180 mustn't sweep the filter around the circle
+	PoseFilter filter;
+	float worst = 0.0f;
+	for (int i = 0; i < 240; i++) {
+		float yaw = 170.0f + 0.1f * i;
+		if (yaw >= 180.0f) yaw -= 360.0f;
+		TrackerSample s = MakeSample(i / 120.0, 0.0f);
+		s.yaw = yaw;
+		filter.Apply(&s);
+		const float error = fabsf(AngleDiff(s.yaw, yaw));
+		if (error > worst)
+			worst = error;
+	}
+	CHECK(worst < 1.0f);
+}
+
+static void TestDependsOnlyOnTheSamples()
+{
+	// The game asks several times per sample: the repeats get the same output and don't
+	// advance the filter
+	PoseFilter once, often;
+	bool bSame = true;
+	for (int i = 0; i < 600; i++) {
+		TrackerSample s = MakeSample(i / 60.0, 30.0f * sinf(i * 0.05f));
+		TrackerSample a = s;
+		once.Apply(&a);
+		TrackerSample b;
+		for (int repeat = 0; repeat < 1 + i % 4; repeat++) {
+			b = s;
+			often.Apply(&b);
+		}
+		if (a.yaw != b.yaw || a.z != b.z)
+			bSame = false;
+	}
+	CHECK(bSame);
+
+	// An invalid sample or a long gap start over from the next sample
+	PoseFilter filter;
+	TrackerSample s = MakeSample(0.0, 0.0f);
+	filter.Apply(&s);
+	TrackerSample invalid;
+	filter.Apply(&invalid);
+	s = MakeSample(0.01, 50.0f);
+	filter.Apply(&s);
+	CHECK(s.yaw == 50.0f);
+	s = MakeSample(2.0, -50.0f);
+	filter.Apply(&s);
+	CHECK(s.yaw == -50.0f);
+}
+
+static void Benchmark()
+{
+	PoseFilter filter;
+	const double ns = BenchmarkNs(1000000, [&](int i) {
+		TrackerSample s = MakeSample(i / 120.0, sinf(i * 0.01f));
+		filter.Apply(&s);
+		g_fBenchmarkSink = s.yaw;
+	});
+	filter.autoCutoff = true;
+	filter.Reset();
+	const double autoNs = BenchmarkNs(1000000, [&](int i) {
+		TrackerSample s = MakeSample(i / 120.0, sinf(i * 0.01f));
+		filter.Apply(&s);
+		g_fBenchmarkSink = s.yaw;
+	});
+	printf("PoseFilter::Apply() (6 axes): %0.1fns, %0.1fns with the automatic cutoff\n", ns, autoNs);
+
+	const double rates[] = { 60.0, 120.0, 500.0 };
+	for (double rate : rates)
+		printf("Lag at %3.0fHz, 50deg/s: %0.1fms\n", rate, 1000.0f * LagOnRamp(0.05f, 50.0f, rate));
+}
+
+int main()
+{
+	TestSmoothsNoise();
+	TestFastMotionGoesThrough();
+	TestAnglesWrap();
+	TestDependsOnlyOnTheSamples();
+	Benchmark();
+	return TestResult();
+}
@@ -0,0 +1,213 @@
+/*
+ * PosePredictor: the prediction lets go when the head stops, is clamped, and cuts the error
+ * at display time on a head-motion trace. The trace is synthetic by default; a tracker capture
+ * (tracker_capture in CockpitLook.cfg) can be given on the command line instead:
+ *     PosePredictorTest capture.xwtc
+ */
+#include <string.h>
+#include <vector>
+#include "Test.h"
+#include "PosePredictor.h"
+#include "TrackerCapture.h"
+
+static LONGLONG SecondsToTicks(double seconds)
+{
+	return (LONGLONG)(seconds / QPCToSeconds(1));
+}
+
+static TrackerSample MakeSample(double t, float yaw)
+{
+	TrackerSample s;
+	s.timestamp = SecondsToTicks(t);
+	s.yaw = yaw;
+	s.valid = true;
+	return s;
+}
+
+static void TestStopsWithTheHead()
+{
+	// 60Hz device, the head turns at 50deg/s for a second and then stops; the device keeps
+	// sending the same values
+	PosePredictor p;
+	p.horizon = 0.02f;
+	const double period = 1.0 / 60;
+	float offsetWhileTurning = 0.0f, offsetAfterStop = 0.0f;
+	for (int i = 0; i < 120; i++) {
+		const double t = i * period;
+		const float yaw = t < 1.0 ? 50.0f * (float)t : 50.0f * (float)(59 * period);
+		p.AddSample(MakeSample(t, yaw));
+		TrackerSample out;
+		CHECK(p.Predict(SecondsToTicks(t + 0.005), &out));
+		if (i == 50) offsetWhileTurning = out.yaw - yaw;
+		if (i == 119) offsetAfterStop = out.yaw - yaw;
+	}
+	// 25ms ahead at 50deg/s
+	CHECK_NEAR(offsetWhileTurning, 1.25f, 0.1f);
+	CHECK_NEAR(offsetAfterStop, 0.0f, 1e-4f);
+
+	// A device that stops sending altogether: the correction fades out after two periods
+	PosePredictor q;
+	q.horizon = 0.02f;
+	for (int i = 0; i < 60; i++)
+		q.AddSample(MakeSample(i * period, i * 0.8f));
+	TrackerSample out;
+	q.Predict(SecondsToTicks(59 * period + 0.005), &out);
+	CHECK(out.yaw - 59 * 0.8f > 0.5f);
+	q.Predict(SecondsToTicks(59 * period + 0.5), &out);
+	CHECK_NEAR(out.yaw - 59 * 0.8f, 0.0f, 1e-4f);
+}
+
+static void TestClampAndReset()
+{
+	PosePredictor p;
+	p.horizon = 0.05f;
+	p.maxAngle = 2.0f;
+	for (int i = 0; i < 30; i++)
+		p.AddSample(MakeSample(i / 60.0, i * 10.0f)); // 600deg/s
+	TrackerSample out;
+	p.Predict(SecondsToTicks(29 / 60.0), &out);
+	CHECK_NEAR(out.yaw - 290.0f, 2.0f, 1e-4f);
+
+	// An invalid sample forgets the motion
+	TrackerSample invalid;
+	p.AddSample(invalid);
+	CHECK(!p.Predict(SecondsToTicks(30 / 60.0), &out));
+}
+
+// A head-motion trace: the samples as the device reported them, and the true pose
+struct Trace {
+	std::vector<TrackerSample> samples;
+	std::vector<TrackerSample> truth;
+};
+
+// Slow looks around plus quick glances, read at 120Hz with a bit of noise
+static Trace MakeSyntheticTrace()
+{
+	Trace trace;
+	TestRandom random(2);
+	for (int i = 0; i < 120 * 60; i++) {
+		const double t = i / 120.0;
+		TrackerSample s = MakeSample(t, 0.0f);
+		s.yaw   = (float)(40.0 * sin(0.7 * t) + 15.0 * sin(3.1 * t) + 20.0 * tanh(4.0 * sin(0.9 * t)));
+		s.pitch = (float)(15.0 * sin(0.5 * t + 1.0) + 5.0 * sin(2.3 * t));
+		trace.truth.push_back(s);
+		s.yaw   += 0.02f * random.Gaussian();
+		s.pitch += 0.02f * random.Gaussian();
+		trace.samples.push_back(s);
+	}
+	return trace;
+}
+
+static bool LoadCaptureTrace(const char *fileName, Trace *trace)
+{
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL)
+		return false;
+	TrackerCaptureHeader header;
+	bool bResult = fread(&header, sizeof(header), 1, file) == 1 &&
+		memcmp(header.magic, "XWTC", 4) == 0 && header.recordSize == sizeof(TrackerCaptureRecord) &&
+		header.qpcFrequency > 0;
+	TrackerCaptureRecord record;
+	while (bResult && fread(&record, sizeof(record), 1, file) == 1) {
+		if (!record.valid)
+			continue;
+		TrackerSample s = MakeSample((double)record.timestamp / header.qpcFrequency, record.yaw);
+		s.pitch = record.pitch; s.roll = record.roll;
+		s.x = record.x; s.y = record.y; s.z = record.z;
+		trace->samples.push_back(s);
+	}
+	fclose(file);
+	// Nothing better than the recording itself to compare against
+	trace->truth = trace->samples;
+	return bResult && trace->samples.size() > 2;
+}
+
+// The true pose at time 'ticks', interpolated
+static void TruthAt(const std::vector<TrackerSample> &truth, size_t *index, LONGLONG ticks, float *yaw, float *pitch)
+{
+	while (*index + 2 < truth.size() && truth[*index + 1].timestamp <= ticks)
+		(*index)++;
+	const TrackerSample &a = truth[*index], &b = truth[*index + 1];
+	float f = (float)(ticks - a.timestamp) / (float)(b.timestamp - a.timestamp);
+	if (f > 1.0f) f = 1.0f;
+	*yaw   = a.yaw + f * AngleDiff(b.yaw, a.yaw);
+	*pitch = a.pitch + f * (b.pitch - a.pitch);
+}
+
+/*
+ * The game renders at 90fps and the frame is displayed 'latency' seconds after it's sampled.
+ * Returns the RMS angular error at display time, with or without the prediction.
+ */
+static double ReplayError(const Trace &trace, float latency, bool bPredict)
+{
+	PosePredictor p;
+	p.horizon = latency;
+	p.maxAngle = 10.0f;
+	const LONGLONG start = trace.samples.front().timestamp;
+	const LONGLONG end = trace.samples.back().timestamp - SecondsToTicks(latency);
+	const LONGLONG frame = SecondsToTicks(1.0 / 90);
+	size_t next = 0, truthIndex = 0;
+	double sum = 0.0;
+	int frames = 0;
+	for (LONGLONG now = start + frame; now < end; now += frame) {
+		while (next < trace.samples.size() && trace.samples[next].timestamp <= now)
+			p.AddSample(trace.samples[next++]);
+		TrackerSample out;
+		if (bPredict)
+			p.Predict(now, &out);
+		else
+			out = trace.samples[next - 1];
+		float yaw, pitch;
+		TruthAt(trace.truth, &truthIndex, now + SecondsToTicks(latency), &yaw, &pitch);
+		const float dYaw = AngleDiff(out.yaw, yaw), dPitch = out.pitch - pitch;
+		sum += dYaw * dYaw + dPitch * dPitch;
+		frames++;
+	}
+	return sqrt(sum / frames);
+}
+
+static void BenchmarkAccuracy(const Trace &trace, bool bCheck)
+{
+	const float latencies[] = { 0.011f, 0.02f, 0.03f };
+	for (float latency : latencies) {
+		const double raw = ReplayError(trace, latency, false);
+		const double predicted = ReplayError(trace, latency, true);
+		printf("%2.0fms to photons: RMS error %0.3fdeg without prediction, %0.3fdeg with it\n",
+			1000.0f * latency, raw, predicted);
+		if (bCheck)
+			CHECK(predicted < 0.5 * raw);
+	}
+}
+
+static void BenchmarkCost()
+{
+	PosePredictor p;
+	p.horizon = 0.02f;
+	const double ns = BenchmarkNs(1000000, [&](int i) {
+		TrackerSample s = MakeSample(i / 120.0, sinf(i * 0.01f));
+		p.AddSample(s);
+		TrackerSample out;
+		p.Predict(s.timestamp, &out);
+		g_fBenchmarkSink = out.yaw;
+	});
+	printf("AddSample() + Predict(): %0.1fns\n", ns);
+}
+
+int main(int argc, char *argv[])
+{
+	TestStopsWithTheHead();
+	TestClampAndReset();
+	if (argc > 1) {
+		Trace trace;
+		if (!LoadCaptureTrace(argv[1], &trace)) {
+			printf("Could not load %s\n", argv[1]);
+			return 1;
+		}
+		printf("%s: %d samples\n", argv[1], (int)trace.samples.size());
+		BenchmarkAccuracy(trace, false);
+	}
+	else
+		BenchmarkAccuracy(MakeSyntheticTrace(), true);
+	BenchmarkCost();
+	return TestResult();
+}
@@ -0,0 +1,199 @@
+/*
+ * ResponseCurve: parsing, going through its points, mirroring, holding the last output, and
+ * above all never going backwards for a monotonic set of points, on random curves and on
+ * the awkward ones (flat stretches, steep steps). Plus the cost of Apply() and Parse().
+ */
+#include <string>
+#include "Test.h"
+#include "ResponseCurve.h"
+
+static void TestParse()
+{
+	ResponseCurve curve;
+	CHECK(!curve.IsEnabled());
+	CHECK(curve.Apply(12.5f) == 12.5f);
+	CHECK(curve.Apply(-7.0f) == -7.0f);
+
+	CHECK(curve.Parse("0:0,10:20,90:90"));
+	CHECK(curve.IsEnabled());
+	// The (0, 0) point is added when the curve doesn't start at 0
+	CHECK(curve.Parse("10:20,90:90"));
+	CHECK(curve.Apply(0.0f) == 0.0f);
+	// A trailing comma is fine
+	CHECK(curve.Parse("0:0,10:20,"));
+
+	const char *invalid[] = {
+		"", "10", "10:", ":10", "10:20 ", "10:20,5:30", "10:20,10:30", "-5:0,10:10",
+		"0:0,a:b", "0:0;10:10", "0:0",
+	};
+	for (const char *spec : invalid) {
+		curve.Parse("0:0,10:20");
+		const bool bParsed = curve.Parse(spec);
+		CHECK(!bParsed);
+		// A failed parse leaves the identity
+		CHECK(!curve.IsEnabled());
+		CHECK(curve.Apply(5.0f) == 5.0f);
+		if (bParsed)
+			printf("Parsed \"%s\"\n", spec);
+	}
+
+	// RESPONSE_CURVE_MAX_POINTS points are fine, one more isn't
+	std::string spec = "0:0";
+	for (int i = 1; i < RESPONSE_CURVE_MAX_POINTS; i++)
+		spec += "," + std::to_string(i * 10) + ":" + std::to_string(i * 10);
+	CHECK(curve.Parse(spec.c_str()));
+	spec += ",1000:1000";
+	CHECK(!curve.Parse(spec.c_str()));
+
+	// Not monotonic: accepted (with a warning in the log)
+	CHECK(curve.Parse("0:0,10:20,20:10,30:30"));
+}
+
+static void TestGoesThroughThePoints()
+{
+	ResponseCurve curve;
+	CHECK(curve.Parse("5:0,20:15,45:60,90:180"));
+	const float x[] = { 0.0f, 5.0f, 20.0f, 45.0f, 90.0f };
+	const float y[] = { 0.0f, 0.0f, 15.0f, 60.0f, 180.0f };
+	// The points fall between table entries; the lerp is within a fraction of a degree
+	for (int i = 0; i < 5; i++) {
+		CHECK_NEAR(curve.Apply(x[i]), y[i], 0.1f);
+		CHECK_NEAR(curve.Apply(-x[i]), -y[i], 0.1f);
+	}
+	// Past the last point, and the mirror image
+	CHECK(curve.Apply(90.0f) == curve.Apply(500.0f));
+	CHECK(curve.Apply(-1000.0f) == -curve.Apply(1000.0f));
+	for (float a = 0.0f; a < 120.0f; a += 0.37f)
+		CHECK(curve.Apply(-a) == -curve.Apply(a));
+	// The dead zone stays dead: the spline doesn't dip below 0 or creep above it, up to the
+	// last table entry before the end of the dead zone
+	const float lastDead = floorf(5.0f * RESPONSE_CURVE_LUT_SIZE / 90.0f) * 90.0f / RESPONSE_CURVE_LUT_SIZE;
+	for (float a = 0.0f; a <= lastDead; a += 0.01f)
+		CHECK(curve.Apply(a) == 0.0f);
+
+	// Two points: a straight line
+	CHECK(curve.Parse("0:0,90:45"));
+	for (float a = 0.0f; a <= 90.0f; a += 0.5f)
+		CHECK_NEAR(curve.Apply(a), 0.5f * a, 1e-3f);
+}
+
+// Index of the segment [x[i], x[i + 1]] that holds a
+static int FindSegment(const float *x, int n, float a)
+{
+	int segment = 0;
+	while (segment < n - 2 && a > x[segment + 1])
+		segment++;
+	return segment;
+}
+
+/*
+ * Checks the curve never goes backwards over [0, 1.2 * maxX] on a sweep much finer than the
+ * table, and doesn't overshoot: between two points it stays between their outputs. The lerp
+ * between table entries rounds off the corners, so the bounds are taken one entry further out.
+ */
+static bool IsMonotonic(const ResponseCurve &curve, const float *x, const float *y, int n, float *backwards, float *overshoot)
+{
+	*backwards = *overshoot = 0.0f;
+	float last = curve.Apply(0.0f);
+	const int steps = 20000;
+	const float end = 1.2f * x[n - 1];
+	const float entry = x[n - 1] / RESPONSE_CURVE_LUT_SIZE;
+	const float tolerance = 1e-4f * fmaxf(1.0f, y[n - 1]);
+	for (int i = 1; i <= steps; i++) {
+		const float a = end * i / steps;
+		const float out = curve.Apply(a);
+		*backwards = fmaxf(*backwards, last - out);
+		last = out;
+		const float lo = y[FindSegment(x, n, fmaxf(0.0f, a - entry))];
+		const float hi = y[FindSegment(x, n, fminf(x[n - 1], a + entry)) + 1];
+		*overshoot = fmaxf(*overshoot, fmaxf(lo - out, out - hi));
+	}
+	return *backwards <= 0.0f && *overshoot <= tolerance;
+}
+
+static void TestMonotonic()
+{
+	// The shapes that make a plain cubic spline overshoot: flat stretches next to steep ones
+	const char *shapes[] = {
+		"0:0,10:10,20:10,30:30",
+		"0:0,1:0,2:90,90:90",
+		"0:0,30:1,31:89,90:90",
+		"0:0,5:0,20:15,45:60,90:180",
+		"0:0,44:0,46:180,90:180",
+		"0:0,10:0.001,20:0.002,30:100,31:100,90:180",
+	};
+	ResponseCurve curve;
+	for (const char *spec : shapes) {
+		CHECK(curve.Parse(spec));
+		float x[RESPONSE_CURVE_MAX_POINTS], y[RESPONSE_CURVE_MAX_POINTS];
+		int n = 0;
+		for (const char *p = spec; *p != '\0' && n < RESPONSE_CURVE_MAX_POINTS; n++) {
+			char *end;
+			x[n] = strtof(p, &end);
+			y[n] = strtof(end + 1, &end);
+			p = *end == ',' ? end + 1 : end;
+		}
+		float backwards, overshoot;
+		const bool bMonotonic = IsMonotonic(curve, x, y, n, &backwards, &overshoot);
+		CHECK(bMonotonic);
+		if (!bMonotonic)
+			printf("%s: goes backwards by %g, overshoots by %g\n", spec, backwards, overshoot);
+	}
+
+	// Random monotonic curves, with every number of points
+	TestRandom random(16);
+	int failures = 0;
+	for (int trial = 0; trial < 3000; trial++) {
+		const int n = 2 + trial % (RESPONSE_CURVE_MAX_POINTS - 1);
+		float x[RESPONSE_CURVE_MAX_POINTS], y[RESPONSE_CURVE_MAX_POINTS];
+		std::string spec;
+		x[0] = y[0] = 0.0f;
+		for (int i = 0; i < n; i++) {
+			if (i > 0) {
+				x[i] = x[i - 1] + random.Uniform(0.1f, 20.0f);
+				// Flat steps now and then
+				y[i] = y[i - 1] + (random.Next() % 4 == 0 ? 0.0f : random.Uniform(0.0f, 40.0f));
+			}
+			char point[64];
+			snprintf(point, sizeof(point), "%s%.9g:%.9g", i > 0 ? "," : "", x[i], y[i]);
+			spec += point;
+		}
+		if (!curve.Parse(spec.c_str())) {
+			failures++;
+			continue;
+		}
+		float backwards, overshoot;
+		if (!IsMonotonic(curve, x, y, n, &backwards, &overshoot)) {
+			if (failures == 0)
+				printf("%s: goes backwards by %g, overshoots by %g\n", spec.c_str(), backwards, overshoot);
+			failures++;
+		}
+	}
+	CHECK(failures == 0);
+}
+
+static void Benchmark()
+{
+	ResponseCurve curve;
+	curve.Parse("5:0,20:15,45:60,90:180");
+	float angles[1024];
+	TestRandom random(2);
+	for (int i = 0; i < 1024; i++)
+		angles[i] = random.Uniform(-120.0f, 120.0f);
+	const double applyNs = BenchmarkNs(10000000, [&](int i) {
+		g_fBenchmarkSink = curve.Apply(angles[i & 1023]);
+	});
+	const double parseNs = BenchmarkNs(100000, [&](int i) {
+		curve.Parse("5:0,20:15,45:60,90:180");
+	});
+	printf("ResponseCurve::Apply(): %0.1fns, Parse() and bake: %0.0fns\n", applyNs, parseNs);
+}
+
+int main()
+{
+	TestParse();
+	TestGoesThroughThePoints();
+	TestMonotonic();
+	Benchmark();
+	return TestResult();
+}
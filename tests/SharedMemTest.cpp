@@ -0,0 +1,264 @@
+/*
+ * The shared memory blocks and the head pose history in them: a second mapping of the same
+ * name sees what the first one writes, InitSharedMem() sets up the history header, and
+ * SamplePoseHistory() interpolates, clamps, wraps around and never returns a torn pose while
+ * CockpitLook keeps publishing. Plus the cost of publishing and sampling a pose.
+ */
+#include <atomic>
+#include <string>
+#include <thread>
+#include "Test.h"
+#include "SharedMem.h"
+
+// Every test gets its own block, so the tests don't see each other's poses (or a game's)
+static std::wstring UniqueName(const wchar_t *base)
+{
+	return std::wstring(L"Local\\") + base + std::to_wstring(GetQPCTime());
+}
+
+// PublishHeadPose() only accepts increasing timestamps, across all the blocks
+static LONGLONG g_NextTimestamp = 1000000;
+
+static SharedHeadPose MakePose(LONGLONG timestamp, float value)
+{
+	SharedHeadPose pose = {};
+	pose.timestamp = pose.sampleTimestamp = timestamp;
+	pose.Yaw = pose.Pitch = pose.Roll = value;
+	pose.X = pose.Y = pose.Z = 2.0f * value;
+	// A rotation of value degrees around Y
+	const float half = 0.5f * value * 3.14159265f / 180.0f;
+	pose.qy = sinf(half);
+	pose.qw = cosf(half);
+	return pose;
+}
+
+static void TestMapping()
+{
+	const std::wstring name = UniqueName(L"CockpitLookTest");
+	SharedMem<SharedMemDataCockpitLook> writer(name.c_str(), true, true);
+	SharedMem<SharedMemDataCockpitLook> reader(name.c_str(), false, false);
+	SharedMemDataCockpitLook *w = writer.GetMemoryPointer();
+	SharedMemDataCockpitLook *r = reader.GetMemoryPointer();
+	CHECK(w != nullptr);
+	CHECK(r != nullptr);
+	if (w == nullptr || r == nullptr)
+		return;
+	CHECK(w != r);
+	// New blocks start zeroed
+	CHECK(r->Yaw == 0.0f && r->frameId == 0);
+	w->Yaw = 12.5f;
+	w->frameId = 42;
+	CHECK(r->Yaw == 12.5f);
+	CHECK(r->frameId == 42);
+
+	// The semaphore is shared too, and it's available from the start
+	CHECK(reader.IsDataReady());
+	writer.SetDataReady();
+	CHECK(reader.IsDataReady());
+	CHECK(writer.IsDataReady());
+
+	// Blocks that don't exist aren't created by the readers
+	const std::wstring missing = UniqueName(L"CockpitLookMissing");
+	SharedMem<SharedMemDataCockpitLook> absent(missing.c_str(), false, false);
+	CHECK(absent.GetMemoryPointer() == nullptr);
+	CHECK(!absent.IsDataReady());
+}
+
+static void TestInitSharedMem()
+{
+	InitSharedMem();
+	CHECK(g_SharedData != nullptr);
+	CHECK(g_pSharedPoseHistory != nullptr);
+	SharedMem<SharedMemDataPoseHistory> reader(SHARED_MEM_NAME_POSE_HISTORY, false, false);
+	const SharedMemDataPoseHistory *history = reader.GetMemoryPointer();
+	CHECK(history != nullptr);
+	if (history == nullptr)
+		return;
+	CHECK(history->version == POSE_HISTORY_VERSION);
+	CHECK(history->length == POSE_HISTORY_LENGTH);
+	CHECK(history->qpcFrequency == GetQPCFrequency());
+	CHECK(reader.IsDataReady());
+}
+
+static void TestInterpolation()
+{
+	const std::wstring name = UniqueName(L"PoseHistoryTest");
+	SharedMem<SharedMemDataPoseHistory> writer(name.c_str(), true, true);
+	SharedMem<SharedMemDataPoseHistory> reader(name.c_str(), false, false);
+	g_pSharedPoseHistory = writer.GetMemoryPointer();
+	const SharedMemDataPoseHistory *history = reader.GetMemoryPointer();
+	CHECK(g_pSharedPoseHistory != nullptr && history != nullptr);
+	if (g_pSharedPoseHistory == nullptr || history == nullptr)
+		return;
+
+	SharedHeadPose out;
+	CHECK(!SamplePoseHistory(history, g_NextTimestamp, &out));
+
+	const LONGLONG base = g_NextTimestamp;
+	for (int i = 0; i < 10; i++)
+		PublishHeadPose(MakePose(base + 1000 * i, (float)i));
+	g_NextTimestamp = base + 10000;
+
+	// Halfway between two poses
+	CHECK(SamplePoseHistory(history, base + 3500, &out));
+	CHECK(out.timestamp == base + 3500);
+	CHECK_NEAR(out.Yaw, 3.5f, 1e-4f);
+	CHECK_NEAR(out.Roll, 3.5f, 1e-4f);
+	CHECK_NEAR(out.X, 7.0f, 1e-4f);
+	const SharedHeadPose expected = MakePose(0, 3.5f);
+	CHECK_NEAR(out.qy, expected.qy, 1e-4f);
+	CHECK_NEAR(out.qw, expected.qw, 1e-4f);
+	// On a pose
+	CHECK(SamplePoseHistory(history, base + 7000, &out));
+	CHECK_NEAR(out.Yaw, 7.0f, 1e-5f);
+	// Past the newest pose: the newest pose, with its own timestamp
+	CHECK(SamplePoseHistory(history, base + 50000, &out));
+	CHECK(out.timestamp == base + 9000);
+	CHECK(out.Yaw == 9.0f);
+	// Older than anything in the history
+	CHECK(!SamplePoseHistory(history, base - 1, &out));
+
+	// Angles take the short way around
+	const LONGLONG wrap = g_NextTimestamp;
+	PublishHeadPose(MakePose(wrap, 170.0f));
+	PublishHeadPose(MakePose(wrap + 1000, -170.0f));
+	g_NextTimestamp = wrap + 2000;
+	CHECK(SamplePoseHistory(history, wrap + 500, &out));
+	CHECK_NEAR(fabsf(out.Yaw), 180.0f, 1e-3f);
+	const float len = sqrtf(out.qx * out.qx + out.qy * out.qy + out.qz * out.qz + out.qw * out.qw);
+	CHECK_NEAR(len, 1.0f, 1e-5f);
+
+	// A repeated timestamp is pushed forward, so the entries stay in order
+	const LONGLONG repeated = g_NextTimestamp;
+	PublishHeadPose(MakePose(repeated, 1.0f));
+	PublishHeadPose(MakePose(repeated, 2.0f));
+	g_NextTimestamp = repeated + 1000;
+	CHECK(SamplePoseHistory(history, repeated + 100, &out));
+	CHECK(out.timestamp == repeated + 1);
+	CHECK(out.Yaw == 2.0f);
+
+	// Once the history wraps around, only the last POSE_HISTORY_LENGTH poses are left
+	const LONGLONG start = g_NextTimestamp;
+	const int total = 3 * POSE_HISTORY_LENGTH + 5;
+	for (int i = 0; i < total; i++)
+		PublishHeadPose(MakePose(start + 1000 * i, (float)(i % 90)));
+	g_NextTimestamp = start + 1000 * total;
+	const LONGLONG oldest = start + 1000 * (total - POSE_HISTORY_LENGTH);
+	CHECK(history->count == 14u + total);
+	CHECK(!SamplePoseHistory(history, oldest - 500, &out));
+	CHECK(SamplePoseHistory(history, oldest + 500, &out));
+	CHECK_NEAR(out.X, 2.0f * ((total - POSE_HISTORY_LENGTH) % 90 + 0.5f), 1e-3f);
+
+	g_pSharedPoseHistory = nullptr;
+}
+
+static void TestConcurrentReadsNeverTear()
+{
+	const std::wstring name = UniqueName(L"PoseHistoryConcurrent");
+	SharedMem<SharedMemDataPoseHistory> writer(name.c_str(), true, true);
+	SharedMem<SharedMemDataPoseHistory> reader(name.c_str(), false, false);
+	g_pSharedPoseHistory = writer.GetMemoryPointer();
+	const SharedMemDataPoseHistory *history = reader.GetMemoryPointer();
+	CHECK(g_pSharedPoseHistory != nullptr && history != nullptr);
+	if (g_pSharedPoseHistory == nullptr || history == nullptr)
+		return;
+
+	// Every field is a linear function of the timestamp, so any interpolated pose that mixes
+	// two different writes is easy to spot
+	const LONGLONG start = GetQPCTime();
+	std::atomic<bool> bRun(true);
+	std::thread publisher([&]() {
+		while (bRun) {
+			SharedHeadPose pose = {};
+			pose.timestamp = pose.sampleTimestamp = GetQPCTime();
+			pose.X = pose.Y = pose.Z = (float)QPCToSeconds(pose.timestamp - start);
+			pose.qw = 1.0f;
+			PublishHeadPose(pose);
+			std::this_thread::yield();
+		}
+	});
+
+	TestRandom random(7);
+	int samples = 0, interpolated = 0, torn = 0, backwards = 0;
+	LONGLONG lastNewest = 0;
+	while (QPCToSeconds(GetQPCTime() - start) < 0.3) {
+		// Somewhere in the last couple of milliseconds
+		const LONGLONG t = GetQPCTime() - (LONGLONG)(random.Uniform(0.0f, 0.002f) / QPCToSeconds(1));
+		SharedHeadPose out;
+		if (!SamplePoseHistory(history, t, &out))
+			continue;
+		samples++;
+		if (out.timestamp != t) {
+			// The newest pose
+			if (out.timestamp < lastNewest)
+				backwards++;
+			lastNewest = out.timestamp;
+			continue;
+		}
+		interpolated++;
+		const double expected = QPCToSeconds(t - start);
+		if (fabs(out.X - expected) > 1e-4 || out.Y != out.X || out.Z != out.X || out.qw != 1.0f)
+			torn++;
+	}
+	bRun = false;
+	publisher.join();
+	printf("Pose history: %d samples, %d interpolated, %u poses published\n", samples, interpolated, history->count.load());
+	CHECK(interpolated > 0);
+	CHECK(torn == 0);
+	CHECK(backwards == 0);
+
+	// The publisher's timestamps are strictly increasing through the whole ring
+	const unsigned int count = history->count;
+	SharedHeadPose prev, next;
+	int unordered = 0;
+	for (unsigned int i = count - POSE_HISTORY_LENGTH + 1; i < count; i++) {
+		history->poses[(i - 1) % POSE_HISTORY_LENGTH].Read(&prev);
+		history->poses[i % POSE_HISTORY_LENGTH].Read(&next);
+		if (next.timestamp <= prev.timestamp)
+			unordered++;
+	}
+	CHECK(unordered == 0);
+	g_pSharedPoseHistory = nullptr;
+}
+
+static void Benchmark()
+{
+	const std::wstring name = UniqueName(L"PoseHistoryBenchmark");
+	SharedMem<SharedMemDataPoseHistory> writer(name.c_str(), true, true);
+	g_pSharedPoseHistory = writer.GetMemoryPointer();
+	if (g_pSharedPoseHistory == nullptr)
+		return;
+
+	// Past the timestamps of the concurrent test, which come from the clock
+	const LONGLONG base = GetQPCTime();
+	const int iterations = 1000000;
+	const double publishNs = BenchmarkNs(iterations, [&](int i) {
+		PublishHeadPose(MakePose(base + 1000LL * i, 1.0f));
+	});
+	const LONGLONG newest = base + 1000LL * (iterations - 1);
+	const double newestNs = BenchmarkNs(iterations, [&](int i) {
+		SharedHeadPose out;
+		SamplePoseHistory(g_pSharedPoseHistory, newest + i, &out);
+		g_fBenchmarkSink = out.Yaw;
+	});
+	// Halfway back through the ring: the search reads half the entries
+	const LONGLONG middle = newest - 1000LL * (POSE_HISTORY_LENGTH / 2) - 500;
+	const double middleNs = BenchmarkNs(iterations, [&](int i) {
+		SharedHeadPose out;
+		SamplePoseHistory(g_pSharedPoseHistory, middle + (i & 255), &out);
+		g_fBenchmarkSink = out.Yaw;
+	});
+	printf("PublishHeadPose(): %0.1fns, SamplePoseHistory(): %0.1fns for the newest pose, %0.1fns %d poses back\n",
+		publishNs, newestNs, middleNs, POSE_HISTORY_LENGTH / 2);
+	g_pSharedPoseHistory = nullptr;
+}
+
+int main()
+{
+	TestMapping();
+	TestInitSharedMem();
+	TestInterpolation();
+	TestConcurrentReadsNeverTear();
+	Benchmark();
+	return TestResult();
+}
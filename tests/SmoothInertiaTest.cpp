@@ -0,0 +1,202 @@
+/*
+ * The external view inertia curve against the SmoothInertia() it replaced, which normalized
+ * the vector and ran the smoothstep on every call: same output over random vectors for
+ * several maximum inertias, no NaN for a zero vector, a length that grows monotonically and
+ * saturates at the maximum, and batches that match single calls. Plus the cost of both.
+ */
+#include "Test.h"
+#include "SmoothInertia.h"
+
+static inline float clamp(float x, const float lowerlimit, const float upperlimit) {
+	if (x < lowerlimit) x = lowerlimit; else if (x > upperlimit) x = upperlimit;
+	return x;
+}
+
+static inline float smoothstep(const float min, const float max, float x) {
+	x = clamp((x - min) / (max - min), 0.0f, 1.0f);
+	return x * x * (3.0f - 2.0f * x);
+}
+
+// The old SmoothInertia(), with g_fExtMaxInertia passed in
+static void OldSmoothInertia(float g_fExtMaxInertia, float *inout_yawInertia, float *inout_pitchInertia)
+{
+	float yawInertia = *inout_yawInertia;
+	float pitchInertia = *inout_pitchInertia;
+
+	float x, L = sqrt(yawInertia * yawInertia + pitchInertia * pitchInertia);
+	yawInertia /= L; pitchInertia /= L;
+	x = L / g_fExtMaxInertia;
+	L = g_fExtMaxInertia * 2.0f * clamp(smoothstep(0.0f, 1.0f, x * 0.45f + 0.5f) - 0.5f, 0.0, 1.0f);
+	yawInertia *= L; pitchInertia *= L;
+
+	*inout_yawInertia = yawInertia;
+	*inout_pitchInertia = pitchInertia;
+}
+
+const float MAX_INERTIAS[] = { 0.005f, 0.025f, 0.1f, 1.0f, 30.0f };
+
+// The curve in double precision: 2 * (smoothstep(0.45x + 0.5) - 0.5) = 1.35x - 0.3645x^3
+static double ExactLength(double length, double maxInertia)
+{
+	const double x = fmin(length / maxInertia, 0.5 / 0.45);
+	return maxInertia * (1.35 * x - 0.3645 * x * x * x);
+}
+
+static void TestMatchesTheOldCurve()
+{
+	SmoothInertiaCurve curve;
+	for (float maxInertia : MAX_INERTIAS) {
+		curve.SetMaxInertia(maxInertia);
+		TestRandom random(24);
+		float worstOld = 0.0f;
+		double worstExact = 0.0;
+		for (int i = 0; i < 200000; i++) {
+			// From far inside the linear part to well past saturation, in every direction
+			const float length = maxInertia * powf(10.0f, random.Uniform(-4.0f, 0.7f));
+			const float angle = random.Uniform(0.0f, 6.2831853f);
+			float yaw = length * cosf(angle), pitch = length * sinf(angle);
+			float oldYaw = yaw, oldPitch = pitch;
+			const double exact = ExactLength(sqrt((double)yaw * yaw + (double)pitch * pitch), maxInertia);
+			curve.Apply(&yaw, &pitch, 1);
+			OldSmoothInertia(maxInertia, &oldYaw, &oldPitch);
+			worstOld = fmaxf(worstOld, fmaxf(fabsf(yaw - oldYaw), fabsf(pitch - oldPitch)) / maxInertia);
+			worstExact = fmax(worstExact, fabs(sqrt((double)yaw * yaw + (double)pitch * pitch) / exact - 1.0));
+		}
+		// The old curve subtracted 0.5 from smoothstep() ~ 0.5, so it lost most of its digits on
+		// short vectors: it's compared relative to the maximum, the table relative to the exact
+		// curve
+		printf("Max inertia %g: largest difference with the old curve %g of the maximum, relative error %g\n",
+			maxInertia, worstOld, worstExact);
+		CHECK(worstOld < 1e-6f);
+		CHECK(worstExact < 1e-5);
+	}
+}
+
+static void TestZeroAndDisabled()
+{
+	SmoothInertiaCurve curve;
+	curve.SetMaxInertia(0.025f);
+	// The old curve divided by the length and returned NaN here
+	float yaw = 0.0f, pitch = 0.0f;
+	curve.Apply(&yaw, &pitch, 1);
+	CHECK(yaw == 0.0f && pitch == 0.0f);
+	float oldYaw = 0.0f, oldPitch = 0.0f;
+	OldSmoothInertia(0.025f, &oldYaw, &oldPitch);
+	CHECK(oldYaw != oldYaw);
+
+	// Tiny vectors get the slope at the origin, 2 * 1.5 * 0.45
+	yaw = 1e-20f; pitch = -2e-20f;
+	curve.Apply(&yaw, &pitch, 1);
+	CHECK_NEAR(yaw / 1e-20f, 1.35f, 1e-5f);
+	CHECK_NEAR(pitch / -2e-20f, 1.35f, 1e-5f);
+
+	// No room for any inertia
+	const float maxInertias[] = { 0.0f, -1.0f };
+	for (float maxInertia : maxInertias) {
+		curve.SetMaxInertia(maxInertia);
+		float yaws[3] = { 0.0f, 0.01f, 100.0f }, pitches[3] = { 0.0f, -0.02f, 5.0f };
+		curve.Apply(yaws, pitches, 3);
+		for (int i = 0; i < 3; i++)
+			CHECK(yaws[i] == 0.0f && pitches[i] == 0.0f);
+	}
+}
+
+static void TestMonotonicAndSaturated()
+{
+	SmoothInertiaCurve curve;
+	for (float maxInertia : MAX_INERTIAS) {
+		curve.SetMaxInertia(maxInertia);
+		float last = 0.0f, backwards = 0.0f;
+		int over = 0;
+		for (int i = 1; i <= 100000; i++) {
+			float yaw = 3.0f * maxInertia * i / 100000, pitch = 0.0f;
+			curve.Apply(&yaw, &pitch, 1);
+			backwards = fmaxf(backwards, last - yaw);
+			if (yaw > maxInertia * (1.0f + 1e-6f))
+				over++;
+			last = yaw;
+		}
+		// Where the curve flattens out, float rounding may step back by an ulp or so
+		printf("Max inertia %g: steps back by %g of the maximum at most\n", maxInertia, backwards / maxInertia);
+		CHECK(backwards <= 4e-7f * maxInertia);
+		CHECK(over == 0);
+		// Saturated past 1.11 * maxInertia
+		float yaw = 0.0f, pitch = 2.0f * maxInertia;
+		curve.Apply(&yaw, &pitch, 1);
+		CHECK_NEAR(pitch, maxInertia, 1e-6f * maxInertia);
+	}
+}
+
+static void TestBatchesAndRebakes()
+{
+	SmoothInertiaCurve curve;
+	curve.SetMaxInertia(0.025f);
+	TestRandom random(7);
+	float yaws[64], pitches[64], singleYaws[64], singlePitches[64];
+	for (int i = 0; i < 64; i++) {
+		yaws[i] = singleYaws[i] = random.Uniform(-0.04f, 0.04f);
+		pitches[i] = singlePitches[i] = random.Uniform(-0.04f, 0.04f);
+	}
+	curve.Apply(yaws, pitches, 64);
+	int mismatches = 0;
+	for (int i = 0; i < 64; i++) {
+		curve.Apply(&singleYaws[i], &singlePitches[i], 1);
+		if (yaws[i] != singleYaws[i] || pitches[i] != singlePitches[i])
+			mismatches++;
+	}
+	CHECK(mismatches == 0);
+
+	// A new maximum rebakes the table
+	curve.SetMaxInertia(0.1f);
+	CHECK(curve.GetMaxInertia() == 0.1f);
+	float yaw = 0.2f, pitch = 0.0f;
+	curve.Apply(&yaw, &pitch, 1);
+	CHECK_NEAR(yaw, 0.1f, 1e-7f);
+	yaw = 0.02f;
+	float oldYaw = 0.02f, oldPitch = 0.0f;
+	curve.Apply(&yaw, &pitch, 1);
+	OldSmoothInertia(0.1f, &oldYaw, &oldPitch);
+	CHECK_NEAR(yaw, oldYaw, 1e-7f);
+}
+
+static void Benchmark()
+{
+	float yaws[1024], pitches[1024];
+	TestRandom random(3);
+	for (int i = 0; i < 1024; i++) {
+		yaws[i] = random.Uniform(-0.04f, 0.04f);
+		pitches[i] = random.Uniform(-0.04f, 0.04f);
+	}
+	const double oldNs = BenchmarkNs(10000000, [&](int i) {
+		float yaw = yaws[i & 1023], pitch = pitches[i & 1023];
+		OldSmoothInertia(0.025f, &yaw, &pitch);
+		g_fBenchmarkSink = yaw + pitch;
+	});
+	SmoothInertiaCurve curve;
+	curve.SetMaxInertia(0.025f);
+	const double newNs = BenchmarkNs(10000000, [&](int i) {
+		float yaw = yaws[i & 1023], pitch = pitches[i & 1023];
+		curve.Apply(&yaw, &pitch, 1);
+		g_fBenchmarkSink = yaw + pitch;
+	});
+	float batchYaws[1024], batchPitches[1024];
+	const double batchNs = BenchmarkNs(10000, [&](int i) {
+		for (int j = 0; j < 1024; j++) {
+			batchYaws[j] = yaws[j];
+			batchPitches[j] = pitches[j];
+		}
+		curve.Apply(batchYaws, batchPitches, 1024);
+		g_fBenchmarkSink = batchYaws[i & 1023];
+	}) / 1024.0;
+	printf("Inertia curve per vector: old %0.1fns, table %0.1fns, table in batches of 1024 %0.2fns\n", oldNs, newNs, batchNs);
+}
+
+int main()
+{
+	TestMatchesTheOldCurve();
+	TestZeroAndDisabled();
+	TestMonotonicAndSaturated();
+	TestBatchesAndRebakes();
+	Benchmark();
+	return TestResult();
+}
@@ -0,0 +1,81 @@
+/*
+ * The non-blocking SteamVR pose is predicted to the next frame's photons: the time left until
+ * the next vsync plus the display's vsync-to-photons latency. Checked with a fake runtime.
+ */
+#include "Test.h"
+#include "SteamVRPose.h"
+
+class FakePoseRuntime : public SteamVRPoseRuntime
+{
+public:
+	float displayFreq = 90.0f;
+	float vsyncToPhotons = 0.011f;
+	float sinceVsync = 0.0f;
+	bool bVsyncKnown = true;
+
+	bool IsHMDConnected() { return true; }
+	bool WaitGetHMDPose(vr::TrackedDevicePose_t* pose) { return false; }
+	bool GetPredictedHMDPose(float secondsFromNow, vr::TrackedDevicePose_t* pose) { return false; }
+	bool GetTimeSinceLastVsync(float* seconds) {
+		*seconds = sinceVsync;
+		return bVsyncKnown;
+	}
+	float GetDisplayFrequency() { return displayFreq; }
+	float GetVsyncToPhotons() { return vsyncToPhotons; }
+};
+
+constexpr float FALLBACK_SECONDS = 0.02f;
+
+static void TestPredictionTime()
+{
+	FakePoseRuntime runtime;
+	const float rates[] = { 60.0f, 80.0f, 90.0f, 120.0f, 144.0f };
+	for (float rate : rates) {
+		runtime.displayFreq = rate;
+		const float frame = 1.0f / rate;
+		// Right after vsync the whole frame is still ahead
+		runtime.sinceVsync = 0.0f;
+		CHECK_NEAR(GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS), frame + 0.011f, 1e-6);
+		// Halfway through
+		runtime.sinceVsync = 0.5f * frame;
+		CHECK_NEAR(GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS), 0.5f * frame + 0.011f, 1e-6);
+		// Right before the next vsync only the photon latency is left
+		runtime.sinceVsync = frame;
+		CHECK_NEAR(GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS), 0.011f, 1e-6);
+		// A hook that runs late doesn't predict into the frame after the next one
+		runtime.sinceVsync = 3.0f * frame;
+		CHECK_NEAR(GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS), 0.011f, 1e-6);
+	}
+
+	// The prediction shrinks as the frame goes by
+	runtime.displayFreq = 90.0f;
+	float last = 1.0f;
+	bool bDecreasing = true;
+	for (int i = 0; i <= 100; i++) {
+		runtime.sinceVsync = i / (100.0f * 90.0f);
+		const float seconds = GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS);
+		if (seconds > last)
+			bDecreasing = false;
+		last = seconds;
+	}
+	CHECK(bDecreasing);
+}
+
+static void TestFallback()
+{
+	FakePoseRuntime runtime;
+	// No vsync timing from the runtime
+	runtime.bVsyncKnown = false;
+	CHECK(GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS) == FALLBACK_SECONDS);
+	// No display frequency (the property couldn't be read)
+	runtime.bVsyncKnown = true;
+	runtime.displayFreq = 0.0f;
+	CHECK(GetSteamVRPoseSecondsFromNow(&runtime, FALLBACK_SECONDS) == FALLBACK_SECONDS);
+}
+
+int main()
+{
+	TestPredictionTime();
+	TestFallback();
+	return TestResult();
+}
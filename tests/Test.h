@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+/*
+ * Checks and timers for the tests in this directory. Every test is its own executable: failed
+ * checks are printed as they happen and main() returns TestResult(), so ctest sees them.
+ * Benchmarks only print their timings, they never fail on them.
+ */
+extern int g_iTestChecks, g_iTestFailures;
+
+#define CHECK(cond) do { \
+	g_iTestChecks++; \
+	if (!(cond)) { \
+		g_iTestFailures++; \
+		printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+	} \
+} while (0)
+
+#define CHECK_NEAR(a, b, eps) do { \
+	g_iTestChecks++; \
+	const double checkA_ = (double)(a), checkB_ = (double)(b); \
+	if (!(fabs(checkA_ - checkB_) <= (double)(eps))) { \
+		g_iTestFailures++; \
+		printf("%s:%d: CHECK_NEAR(%s, %s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, #eps, checkA_, checkB_); \
+	} \
+} while (0)
+
+inline int TestResult()
+{
+	printf("%d checks, %d failed\n", g_iTestChecks, g_iTestFailures);
+	return g_iTestFailures == 0 ? 0 : 1;
+}
+
+// Runs fun(i) for i in [0, iterations) and returns the average time per call, in nanoseconds
+template<class Fun>
+double BenchmarkNs(int iterations, Fun fun)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		fun(i);
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// Keeps the optimizer from dropping a benchmarked computation
+extern volatile float g_fBenchmarkSink;
+
+// Deterministic pseudo-random numbers, so a failure can be reproduced
+class TestRandom
+{
+public:
+	explicit TestRandom(unsigned int seed) : state(seed != 0 ? seed : 1) {}
+
+	unsigned int Next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// Uniform in [lo, hi]
+	float Uniform(float lo, float hi)
+	{
+		return lo + (hi - lo) * (float)(Next() & 0xFFFFFF) / (float)0xFFFFFF;
+	}
+
+	// Standard normal (Box-Muller)
+	float Gaussian()
+	{
+		const float u1 = Uniform(1e-7f, 1.0f), u2 = Uniform(0.0f, 1.0f);
+		return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+	}
+
+private:
+	unsigned int state;
+};
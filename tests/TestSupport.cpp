@@ -0,0 +1,25 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include "Test.h"
+#include "TrackerCapture.h"
+
+int g_iTestChecks = 0, g_iTestFailures = 0;
+volatile float g_fBenchmarkSink = 0.0f;
+
+// The hook's log goes to stdout when TEST_VERBOSE is set
+void log_debug(const char *format, ...)
+{
+	static const bool bVerbose = getenv("TEST_VERBOSE") != NULL;
+	if (!bVerbose)
+		return;
+	va_list args;
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	printf("\n");
+}
+
+// The tests don't record captures
+void RecordTrackerSample(const TrackerSample &sample)
+{
+}
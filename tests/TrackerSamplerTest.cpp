@@ -0,0 +1,222 @@
+/*
+ * The tracker sampler with a fake tracker: the hook side never waits for the device, never
+ * sees a torn sample, a sampler stuck in the device's driver doesn't get revived, and pausing
+ * it around a config reload brings back the right device.
+ */
+#include <atomic>
+#include <thread>
+#include "Test.h"
+#include "SeqLock.h"
+#include "Threading.h"
+#include "TrackerSampler.h"
+
+// Every field of a fake sample holds the same counter, so a torn copy is easy to spot
+static std::atomic<int> g_iFakeReads(0);
+static std::atomic<int> g_iFakeStallMs(0);
+
+static bool FakeTrackerRead(TrackerSample *sample)
+{
+	const int stallMs = g_iFakeStallMs;
+	if (stallMs > 0)
+		SleepMs(stallMs);
+	const float n = (float)++g_iFakeReads;
+	sample->yaw = sample->pitch = sample->roll = n;
+	sample->x = sample->y = sample->z = n;
+	return true;
+}
+
+static bool IsConsistent(const TrackerSample &s)
+{
+	return s.pitch == s.yaw && s.roll == s.yaw && s.x == s.yaw && s.y == s.yaw && s.z == s.yaw;
+}
+
+static void TestSeqLockNeverTears()
+{
+	struct Payload { int values[32]; };
+	SeqLock<Payload> lock;
+	std::atomic<bool> bRun(true);
+	std::thread writer([&]() {
+		Payload p;
+		for (int n = 1; bRun; n++) {
+			for (int i = 0; i < 32; i++)
+				p.values[i] = n;
+			lock.Write(p);
+			// A tracker publishes at a few hundred Hz at most; a writer that never lets go
+			// would starve the readers, which is by design
+			std::this_thread::yield();
+		}
+	});
+
+	int attempts = 0, reads = 0, torn = 0, last = 0, backwards = 0;
+	while (lock.GetWriteCount() == 0)
+		std::this_thread::yield();
+	const LONGLONG start = GetQPCTime();
+	while (QPCToSeconds(GetQPCTime() - start) < 0.2) {
+		Payload p;
+		attempts++;
+		if (!lock.Read(&p))
+			continue;
+		reads++;
+		for (int j = 1; j < 32; j++)
+			if (p.values[j] != p.values[0]) {
+				torn++;
+				break;
+			}
+		if (p.values[0] < last)
+			backwards++;
+		last = p.values[0];
+	}
+	bRun = false;
+	writer.join();
+	printf("SeqLock: %d clean reads out of %d attempts\n", reads, attempts);
+	CHECK(reads > 0);
+	CHECK(torn == 0);
+	CHECK(backwards == 0);
+}
+
+static void TestHookNeverBlocksOrTears()
+{
+	g_iTrackerSamplerRate = 1000;
+	g_iFakeStallMs = 0;
+	CHECK(StartTrackerSampler(FakeTrackerRead));
+	CHECK(IsTrackerSamplerRunning());
+	SleepMs(50);
+
+	// The device stalls for a while in the middle of the run; the hook keeps getting the
+	// last sample it published, right away
+	double maxReadMs = 0.0;
+	int reads = 0, invalid = 0, torn = 0, backwards = 0;
+	float last = 0.0f;
+	const LONGLONG start = GetQPCTime();
+	bool bStalled = false;
+	while (QPCToSeconds(GetQPCTime() - start) < 0.6) {
+		if (!bStalled && QPCToSeconds(GetQPCTime() - start) > 0.2) {
+			g_iFakeStallMs = 250;
+			bStalled = true;
+		}
+		TrackerSample sample;
+		const LONGLONG t0 = GetQPCTime();
+		const bool bRead = GetLatestTrackerSample(&sample);
+		const double ms = 1000.0 * QPCToSeconds(GetQPCTime() - t0);
+		if (ms > maxReadMs)
+			maxReadMs = ms;
+		if (!bRead)
+			continue;
+		reads++;
+		if (!sample.valid)
+			invalid++;
+		if (!IsConsistent(sample))
+			torn++;
+		if (sample.yaw < last)
+			backwards++;
+		last = sample.yaw;
+	}
+	g_iFakeStallMs = 0;
+	StopTrackerSampler();
+
+	printf("Sampler: %d reads, %d device reads, slowest hook read %0.3fms\n", reads, g_iFakeReads.load(), maxReadMs);
+	CHECK(!IsTrackerSamplerRunning());
+	CHECK(reads > 1000);
+	CHECK(invalid == 0);
+	CHECK(torn == 0);
+	CHECK(backwards == 0);
+	// Generous, to survive a loaded machine: the point is that it isn't anywhere near the stall
+	CHECK(maxReadMs < 20.0);
+
+	// Nothing is published once the sampler is stopped
+	TrackerSample before, after;
+	GetLatestTrackerSample(&before);
+	SleepMs(20);
+	GetLatestTrackerSample(&after);
+	CHECK(before.yaw == after.yaw);
+}
+
+static void TestStuckSamplerIsNotRevived()
+{
+	g_iTrackerSamplerRate = 1000;
+	g_iFakeStallMs = 0;
+	CHECK(StartTrackerSampler(FakeTrackerRead));
+	SleepMs(20);
+
+	// Stuck in the "driver" for longer than StopTrackerSampler() and the next
+	// StartTrackerSampler() wait, together
+	g_iFakeStallMs = 3000;
+	SleepMs(20);
+	const LONGLONG t0 = GetQPCTime();
+	StopTrackerSampler();
+	const double stopSeconds = QPCToSeconds(GetQPCTime() - t0);
+	CHECK(stopSeconds < 1.5);
+	CHECK(!IsTrackerSamplerRunning());
+
+	// The stuck thread is still around, so a new sampler can't start yet
+	CHECK(!StartTrackerSampler(FakeTrackerRead));
+	g_iFakeStallMs = 0;
+
+	// Once the read returns, the old thread exits without publishing its sample
+	TrackerSample before;
+	GetLatestTrackerSample(&before);
+	SleepMs(1200);
+	TrackerSample after;
+	GetLatestTrackerSample(&after);
+	CHECK(before.yaw == after.yaw);
+
+	// ... and a new one can start
+	CHECK(StartTrackerSampler(FakeTrackerRead));
+	SleepMs(20);
+	GetLatestTrackerSample(&after);
+	CHECK(after.yaw > before.yaw);
+	StopTrackerSampler();
+}
+
+// Whether the sampler published anything in the next 20ms
+static bool IsPublishing()
+{
+	TrackerSample before, after;
+	GetLatestTrackerSample(&before);
+	SleepMs(20);
+	GetLatestTrackerSample(&after);
+	return after.yaw != before.yaw;
+}
+
+static void TestPauseAroundReload()
+{
+	g_iTrackerSamplerRate = 1000;
+	g_iFakeStallMs = 0;
+	CHECK(StartTrackerSampler(FakeTrackerRead));
+	CHECK(IsPublishing());
+
+	// Nothing runs while paused, and the same device comes back on resume
+	PauseTrackerSampler();
+	CHECK(!IsTrackerSamplerRunning());
+	CHECK(!IsPublishing());
+	ResumeTrackerSampler(true);
+	CHECK(IsTrackerSamplerRunning());
+	CHECK(IsPublishing());
+
+	// A device that is being replaced doesn't come back...
+	PauseTrackerSampler();
+	ResumeTrackerSampler(false);
+	CHECK(!IsTrackerSamplerRunning());
+
+	// ... but the new one, started during the pause, does
+	PauseTrackerSampler();
+	CHECK(StartTrackerSampler(FakeTrackerRead));
+	CHECK(!IsTrackerSamplerRunning());
+	ResumeTrackerSampler(false);
+	CHECK(IsTrackerSamplerRunning());
+
+	// A sampler stopped during the pause stays stopped
+	PauseTrackerSampler();
+	StopTrackerSampler();
+	ResumeTrackerSampler(true);
+	CHECK(!IsTrackerSamplerRunning());
+}
+
+int main()
+{
+	TestSeqLockNeverTears();
+	TestHookNeverBlocksOrTears();
+	TestStuckSamplerIsNotRevived();
+	TestPauseAroundReload();
+	return TestResult();
+}
@@ -0,0 +1,207 @@
+/*
+ * TrackerTransform against the per-tracker code it replaced in UpdateTrackingData(), on random
+ * poses, centers, multipliers, offsets, limits and turret rotations.
+ */
+#include "Test.h"
+#include "TrackerSampler.h"
+#include "TrackerTransform.h"
+
+constexpr float RAD_TO_DEG = 57.2957795f;
+
+enum OldTracker { OLD_FREEPIE, OLD_OPENTRACK, OLD_STEAMVR, OLD_TRACKIR, OLD_TRACKER_COUNT };
+
+struct Settings {
+	float yawMultiplier, pitchMultiplier, rollMultiplier;
+	float yawOffset, pitchOffset, rollOffset;
+	float posMultiplier[3], minPos[3], maxPos[3];
+	bool bFlipYZAxes;
+};
+
+struct Pose {
+	float yaw, pitch, roll;
+	float pos[3];
+};
+
+/*
+ * What the hook used to do, tracker by tracker: the reads, the center, the turret (SteamVR
+ * only), then the offsets and the multipliers, lean and limits that all of them shared.
+ */
+static Pose OldTransform(OldTracker tracker, const Settings &cfg, const Pose &raw, const float rawCenter[3],
+	const float lean[3], const Matrix4 *turret)
+{
+	float x = raw.pos[0], y = raw.pos[1], z = raw.pos[2];
+	float cx = rawCenter[0], cy = rawCenter[1], cz = rawCenter[2];
+	Pose out;
+	out.yaw = raw.yaw * cfg.yawMultiplier;
+	out.pitch = raw.pitch * cfg.pitchMultiplier;
+	out.roll = raw.roll * cfg.rollMultiplier;
+	switch (tracker) {
+	case OLD_FREEPIE:
+		z = -z; cz = -cz;
+		break;
+	case OLD_OPENTRACK:
+		x *= 0.01f; y *= 0.01f; z *= 0.01f;
+		cx *= 0.01f; cy *= 0.01f; cz *= 0.01f;
+		z = -z; cz = -cz;
+		break;
+	case OLD_STEAMVR:
+		z = -z; cz = -cz;
+		out.yaw   = raw.yaw   * RAD_TO_DEG * cfg.yawMultiplier;
+		out.pitch = raw.pitch * RAD_TO_DEG * cfg.pitchMultiplier;
+		out.roll  = raw.roll  * RAD_TO_DEG * cfg.rollMultiplier;
+		break;
+	case OLD_TRACKIR:
+		x *= -0.0002f; y *= 0.0002f; z *= -0.0002f;
+		cx *= -0.0002f; cy *= 0.0002f; cz *= -0.0002f;
+		out.yaw = raw.yaw * cfg.yawMultiplier * -1.0f;
+		out.roll = 0.0f;
+		if (cfg.bFlipYZAxes) {
+			float temp = y; y = z; z = temp;
+			temp = cy; cy = cz; cz = temp;
+		}
+		break;
+	default:
+		break;
+	}
+	Vector4 headPos(x - cx, y - cy, z - cz, 0.0f);
+	if (tracker == OLD_STEAMVR && turret != NULL)
+		headPos = *turret * headPos;
+
+	out.yaw += cfg.yawOffset;
+	out.pitch += cfg.pitchOffset;
+	out.roll += cfg.rollOffset;
+	while (out.yaw < 0.0f) out.yaw += 360.0f;
+	while (out.pitch < 0.0f) out.pitch += 360.0f;
+	while (out.roll < 0.0f) out.roll += 360.0f;
+
+	const float p[3] = { headPos.x, headPos.y, headPos.z };
+	for (int i = 0; i < 3; i++) {
+		out.pos[i] = p[i] * cfg.posMultiplier[i] + lean[i];
+		if (out.pos[i] < cfg.minPos[i]) out.pos[i] = cfg.minPos[i];
+		if (out.pos[i] > cfg.maxPos[i]) out.pos[i] = cfg.maxPos[i];
+	}
+	return out;
+}
+
+// The same conventions, compiled the way CompileTrackerTransform() does it
+static void CompileTransform(OldTracker tracker, const Settings &cfg, TrackerTransform *transform)
+{
+	float sx = 1.0f, sy = 1.0f, sz = -1.0f;
+	float yawScale = cfg.yawMultiplier, pitchScale = cfg.pitchMultiplier, rollScale = cfg.rollMultiplier;
+	bool bFlipYZ = false;
+	switch (tracker) {
+	case OLD_OPENTRACK:
+		sx = sy = 0.01f; sz = -0.01f;
+		break;
+	case OLD_STEAMVR:
+		yawScale *= RAD_TO_DEG; pitchScale *= RAD_TO_DEG; rollScale *= RAD_TO_DEG;
+		break;
+	case OLD_TRACKIR:
+		sx = -0.0002f; sy = 0.0002f; sz = -0.0002f;
+		yawScale = -yawScale;
+		rollScale = 0.0f;
+		bFlipYZ = cfg.bFlipYZAxes;
+		break;
+	default:
+		break;
+	}
+	if (bFlipYZ)
+		transform->deviceToXWA.set(sx, 0, 0, 0,  0, 0, sy, 0,  0, sz, 0, 0,  0, 0, 0, 1);
+	else
+		transform->deviceToXWA.set(sx, 0, 0, 0,  0, sy, 0, 0,  0, 0, sz, 0,  0, 0, 0, 1);
+	transform->posMultiplier.set(cfg.posMultiplier[0], cfg.posMultiplier[1], cfg.posMultiplier[2]);
+	transform->minPos.set(cfg.minPos[0], cfg.minPos[1], cfg.minPos[2]);
+	transform->maxPos.set(cfg.maxPos[0], cfg.maxPos[1], cfg.maxPos[2]);
+	transform->rotScale.set(yawScale, pitchScale, rollScale);
+	transform->rotOffset.set(cfg.yawOffset, cfg.pitchOffset, cfg.rollOffset);
+	transform->Compile();
+}
+
+static void TestMatchesTheOldCode()
+{
+	TestRandom random(13);
+	double maxPosError[OLD_TRACKER_COUNT] = { 0 }, maxRotError[OLD_TRACKER_COUNT] = { 0 };
+	for (int i = 0; i < 200000; i++) {
+		const OldTracker tracker = (OldTracker)(i % OLD_TRACKER_COUNT);
+		Settings cfg;
+		cfg.yawMultiplier = random.Uniform(-3.0f, 3.0f);
+		cfg.pitchMultiplier = random.Uniform(-3.0f, 3.0f);
+		cfg.rollMultiplier = random.Uniform(-3.0f, 3.0f);
+		cfg.yawOffset = random.Uniform(-90.0f, 90.0f);
+		cfg.pitchOffset = random.Uniform(-90.0f, 90.0f);
+		cfg.rollOffset = random.Uniform(-90.0f, 90.0f);
+		for (int j = 0; j < 3; j++) {
+			cfg.posMultiplier[j] = random.Uniform(-3.0f, 3.0f);
+			cfg.minPos[j] = random.Uniform(-3.0f, -0.1f);
+			cfg.maxPos[j] = random.Uniform(0.1f, 3.0f);
+		}
+		cfg.bFlipYZAxes = (i / OLD_TRACKER_COUNT) % 2 == 1;
+
+		// Device units: degrees, radians for SteamVR; meters, centimeters or TrackIR's units
+		const float angleRange = tracker == OLD_STEAMVR ? 3.14159f : 180.0f;
+		const float posRange = tracker == OLD_TRACKIR ? 5000.0f : tracker == OLD_OPENTRACK ? 50.0f : 0.5f;
+		Pose raw;
+		raw.yaw = random.Uniform(-angleRange, angleRange);
+		raw.pitch = random.Uniform(-angleRange, angleRange);
+		raw.roll = random.Uniform(-angleRange, angleRange);
+		float center[3], lean[3];
+		for (int j = 0; j < 3; j++) {
+			raw.pos[j] = random.Uniform(-posRange, posRange);
+			center[j] = random.Uniform(-posRange, posRange);
+			lean[j] = random.Uniform(-0.2f, 0.2f);
+		}
+		Matrix4 turret;
+		turret.rotateY(random.Uniform(-180.0f, 180.0f));
+		turret.rotateX(random.Uniform(-90.0f, 90.0f));
+		const Matrix4 *pTurret = tracker == OLD_STEAMVR && (i / 8) % 2 == 1 ? &turret : NULL;
+
+		const Pose expected = OldTransform(tracker, cfg, raw, center, lean, pTurret);
+
+		TrackerTransform transform;
+		CompileTransform(tracker, cfg, &transform);
+		transform.SetCenter(Vector4(center[0], center[1], center[2], 1.0f));
+		Pose actual = raw;
+		transform.ApplyRotation(&actual.yaw, &actual.pitch, &actual.roll);
+		const Vector4 pos = transform.ApplyPosition(Vector4(raw.pos[0], raw.pos[1], raw.pos[2], 1.0f),
+			Vector3(lean[0], lean[1], lean[2]), pTurret);
+
+		const double posError = fmax(fabs(pos.x - expected.pos[0]), fmax(fabs(pos.y - expected.pos[1]), fabs(pos.z - expected.pos[2])));
+		// 0 and 360 are the same angle; the old loop and the new wrap may round to either
+		const double rotError = fmax(fabs(AngleDiff(actual.yaw, expected.yaw)),
+			fmax(fabs(AngleDiff(actual.pitch, expected.pitch)), fabs(AngleDiff(actual.roll, expected.roll))));
+		if (posError > maxPosError[tracker]) maxPosError[tracker] = posError;
+		if (rotError > maxRotError[tracker]) maxRotError[tracker] = rotError;
+		if (actual.yaw < 0.0f || actual.pitch < 0.0f || actual.roll < 0.0f)
+			maxRotError[tracker] = 1e9;
+	}
+
+	const char *names[OLD_TRACKER_COUNT] = { "FreePIE", "OpenTrack", "SteamVR", "TrackIR" };
+	for (int t = 0; t < OLD_TRACKER_COUNT; t++) {
+		printf("%-9s: largest difference %g m, %g deg\n", names[t], maxPosError[t], maxRotError[t]);
+		CHECK(maxPosError[t] < 1e-5);
+		CHECK(maxRotError[t] < 1e-3);
+	}
+}
+
+static void Benchmark()
+{
+	TrackerTransform transform;
+	transform.posMultiplier.set(1.5f, 1.5f, 1.5f);
+	transform.rotScale.set(2.0f, 2.0f, 1.0f);
+	transform.rotOffset.set(0.0f, -10.0f, 0.0f);
+	transform.Compile();
+	const double ns = BenchmarkNs(1000000, [&](int i) {
+		float yaw = (float)(i % 360) - 180.0f, pitch = 10.0f, roll = -5.0f;
+		transform.ApplyRotation(&yaw, &pitch, &roll);
+		const Vector4 pos = transform.ApplyPosition(Vector4(0.01f * (i % 7), 0.02f, -0.03f, 1.0f), Vector3(0, 0, 0));
+		g_fBenchmarkSink = yaw + pos.x;
+	});
+	printf("ApplyRotation() + ApplyPosition(): %0.1fns\n", ns);
+}
+
+int main()
+{
+	TestMatchesTheOldCode();
+	Benchmark();
+	return TestResult();
+}